@@ -3,7 +3,15 @@
 rm -f error*
 rm -f core
 
-# change 0x610661c3 to your semaphore and shared memory key
-ipcrm -S 0x612e38d7
-ipcrm -M 0x612e38d7
-
+# the semaphore sets and shared memory regions of every instance of the simulation in this directory, their keys
+# are the ones of ftok(".", 'a' + instance) (the set of the POSIX semaphores build is a region with the top bit
+# flipped)
+read dev ino <<< $(stat -c '%d %i' .)
+for i in $(seq 0 63)
+do
+    key=$(( ((0x61 + i) << 24) | ((dev & 0xff) << 16) | (ino & 0xffff) ))
+    ipcrm -S $key 2>/dev/null
+    ipcrm -M $key 2>/dev/null
+    ipcrm -M $(( key ^ 0x80000000 )) 2>/dev/null
+done
+exit 0
@@ -0,0 +1,55 @@
+#!/bin/bash
+
+# Validation of the discrete event simulation against the concurrent implementation: both are run with the same
+# parameters and seed and the invariants of every log are checked by invariants.awk. The concurrent implementation
+# is also run in virtual time (-v 0), where it must give the same air lift result as the discrete event simulation.
+# Usage: compare.sh «number-of-runs» [options of both programs: -n -m -M -f -H -P -b -d]
+
+case $# in
+    0) n=10;;
+    *) n=$1; shift;;
+esac
+
+if ! [ $n -gt 0 ] 2>/dev/null; then
+    echo "Wrong argument value (\"$n\"). Aborting."
+    exit 1
+fi
+
+min=5; max=10; bin=0; delta=0
+args=("$@")
+while [ $# -gt 0 ]; do
+    case $1 in
+        -m) min=$2; shift;;
+        -M) max=$2; shift;;
+        -b) bin=1;;
+        -d) delta=1; shift;;
+    esac
+    shift
+done
+
+# checking one log, decoding it first if it is binary and expanding it if it is in the delta layout
+check() {
+    if [ $bin -eq 1 ]; then
+        ./logDecoder $1 $1.txt && mv $1.txt $1
+    fi
+    if [ $delta -eq 1 ]; then
+        awk -f expand_log.awk $1 > $1.txt && mv $1.txt $1
+    fi
+    awk -v minFC=$min -v maxFC=$max -f invariants.awk $1
+}
+
+fails=0
+for i in $(seq 1 $n)
+do
+    c=$(./probSemSharedMemAirLift -s $i "${args[@]}" cmp_conc.log && check cmp_conc.log) || fails=$((fails + 1))
+    d=$(./desAirLift -s $i "${args[@]}" cmp_des.log && check cmp_des.log) || fails=$((fails + 1))
+    v="same result"
+    ./probSemSharedMemAirLift -v 0 -s $i "${args[@]}" cmp_vt.log && check cmp_vt.log > /dev/null &&
+        cmp -s <(sed -n '/AirLift result/,$p' cmp_vt.log) <(sed -n '/AirLift result/,$p' cmp_des.log) ||
+        { v="different result"; fails=$((fails + 1)); }
+    printf "run %3d  concurrent: %-40s  des: %-40s  virtual time: %s\n" $i "$c" "$d" "$v"
+done
+rm -f cmp_conc.log cmp_des.log cmp_vt.log
+
+echo "$fails logs failed"
+[ $fails -eq 0 ]
@@ -0,0 +1,78 @@
+# Expansion of a log written in the delta layout (-d) into the full layout: every state line starting with ~ is
+# rebuilt from the previous one and the changes it lists, and the column names are written again after the lines
+# of the flight events. A log in the full layout is copied unchanged.
+# Usage: awk -f expand_log.awk «log»
+
+# the states are kept as the text of the last row, in which each change rewrites the column of the entity
+function setState(i, s) {
+    state[i] = s
+    row = substr(row, 1, off[i] - 1) sprintf("%*d", width[i], s) substr(row, off[i] + width[i])
+}
+
+# the delta layout has no column names after the flight events
+pending {
+    pending = 0
+    if (($1 != "PT") && ($1 != "T0")) {
+        print header
+    }
+}
+
+# column names, the first line of them sets the layout
+$1 == "PT" || $1 == "T0" {
+    if (nEnt == 0) {
+        for (i = 1; i <= NF; i++) {
+            if ($i ~ /^(PT|T[0-9]+)$/) {
+                col[$i] = ++nEnt; nPT++; width[nEnt] = 3
+            }
+            else if ($i ~ /^(HT|H[0-9]+)$/) {
+                col[$i] = ++nEnt; nHT++; width[nEnt] = 3
+            }
+            else if ($i ~ /^P[0-9]+$/) {
+                col[$i] = ++nEnt; width[nEnt] = length($i) + 1
+            }
+        }
+        header = $0
+        for (i = 1; i <= nEnt; i++) {
+            off[i] = rowLen + 1
+            rowLen += width[i] + ((i == nPT + nHT) || (i == nEnt))
+        }
+    }
+    print; next
+}
+
+/^Flight [0-9]+ : (Boarding Started|Departed with|Arrived|Returning)/ {
+    print
+    pending = (nEnt > 0)
+    next
+}
+
+# delta state line
+$1 == "~" {
+    for (i = 2; $i != "|"; i += 2) {
+        split($(i + 1), ch, ">")
+        if (state[col[$i]] != ch[1]) {
+            printf("expand_log: line %d, %s was not in state %s\n", NR, $i, ch[1]) > "/dev/stderr"
+            bad = 1
+        }
+        setState(col[$i], ch[2])
+    }
+    print row substr($0, index($0, " | ") + 3); next
+}
+
+# full state line (keyframe), the counters that follow the states may be run together
+nEnt > 0 && NF > nEnt && $1 ~ /^[0-9]+$/ {
+    for (i = 1; i <= nEnt; i++) {
+        state[i] = $i
+    }
+    row = substr($0, 1, rowLen)
+    print; next
+}
+
+{ print }
+
+END {
+    if (pending) {
+        print header
+    }
+    exit bad
+}
@@ -1,4 +1,4 @@
 #!/bin/bash
 
-./probSemSharedMemAirLift | awk -f filter_log.awk
-
+# the layout is learnt from the column names, so any problem options may be given, e.g. filter.sh -n 100 -H 2
+./probSemSharedMemAirLift "$@" | ./logFilter
@@ -0,0 +1,82 @@
+# Checks the invariants of an air lift log, written by either implementation:
+#   - passengers go through their states in order, one state at a time;
+#   - the counters are consistent with the passenger states, passengers boarded never decrease;
+#   - a flight starts boarding only after the previous one departed;
+#   - the virtual time, if logged, never goes backwards;
+#   - every flight started boarding and departed, every flight but the last one has between the min and the max
+#     number of passengers, the last one at most the max, and every passenger is carried to the destination.
+# Usage: awk -v minFC=5 -v maxFC=10 -f invariants.awk log
+# Prints one line with the number of flights and their sizes, or the first violation found (exit status 1).
+
+function fail(msg) {
+    printf("line %d: %s\n", NR, msg)
+    failed = 1
+    exit 1
+}
+
+BEGIN {
+    if (minFC == "") minFC = 5
+    if (maxFC == "") maxFC = 10
+}
+
+# header of the state lines: locating the columns
+$1 == "PT" || $1 == "T0" {
+    nP = 0; timeCol = 0
+    for (i = 1; i <= NF; i++) {
+        if ($i ~ /^P[0-9]+$/) pCol[nP++] = i
+        else if ($i == "InQ") qCol = i
+        else if ($i == "Time(us)") timeCol = i
+    }
+    next
+}
+
+# state lines
+nP > 0 && $1 ~ /^[0-9]+$/ {
+    for (s = 0; s < 4; s++) cnt[s] = 0
+    for (p = 0; p < nP; p++) {
+        s = $(pCol[p])
+        if (s < prev[p] || s > prev[p] + 1)
+            fail(sprintf("passenger %d went from state %d to %d", p, prev[p], s))
+        prev[p] = s
+        cnt[s]++
+    }
+    # the counters are fixed width and may be run together from 1000 on
+    c = length($0) - (timeCol ? 11 : 0)
+    inQ = substr($0, c - 11, 4) + 0; inF = substr($0, c - 7, 4) + 0; toB = substr($0, c - 3, 4) + 0
+    if (inQ > cnt[1]) fail(sprintf("%d passengers in queue, %d in state 1", inQ, cnt[1]))
+    if (cnt[2] + cnt[3] > toB) fail(sprintf("%d passengers boarded, %d in states 2 and 3", toB, cnt[2] + cnt[3]))
+    if (toB > nP - cnt[0]) fail(sprintf("%d passengers boarded, %d reached the airport", toB, nP - cnt[0]))
+    if (toB < lastToB) fail(sprintf("passengers boarded went down from %d to %d", lastToB, toB))
+    lastToB = toB
+    if (timeCol) {
+        if ($(timeCol) < lastTime) fail(sprintf("time went back from %d to %d", lastTime, $(timeCol)))
+        lastTime = $(timeCol)
+    }
+    next
+}
+
+/Boarding Started/ {
+    if (started++ > departed) fail(sprintf("flight %d started boarding before flight %d departed", started, departed + 1))
+}
+/Departed with/ { departed++ }
+/^AirLift used/ { nFlights = $3 }
+/^Flight [0-9]+ took/ { size[$2] = $4; total += $4 }
+
+END {
+    if (failed) exit 1
+    if (nP == 0) { print "no state lines"; exit 1 }
+    if (nFlights == 0) { print "no air lift result"; exit 1 }
+    if (started != nFlights || departed != nFlights) {
+        printf("%d flights, %d started boarding, %d departed\n", nFlights, started, departed); exit 1
+    }
+    for (p = 0; p < nP; p++) if (prev[p] != 3) { printf("passenger %d ended in state %d\n", p, prev[p]); exit 1 }
+    if (total != nP) { printf("%d passengers carried out of %d\n", total, nP); exit 1 }
+    sizes = ""
+    for (f = 1; f <= nFlights; f++) {
+        if (size[f] < 1 || size[f] > maxFC || (f < nFlights && size[f] < minFC)) {
+            printf("flight %d took %d passengers\n", f, size[f]); exit 1
+        }
+        sizes = sizes " " size[f]
+    }
+    printf("ok %d flights:%s\n", nFlights, sizes)
+}
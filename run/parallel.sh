@@ -0,0 +1,48 @@
+#!/bin/bash
+
+# Independent simulations side by side: instance i is logged into par.i.log, has error files suffixed by .i (none for
+# instance 0) and is bound to CPU i modulo the number of CPUs. The invariants of every log are checked by
+# invariants.awk.
+# Usage: parallel.sh «number-of-instances» [options of the simulation: -n -m -M -f -H -P -t -s ...]
+
+case $# in
+    0) n=4;;
+    *) n=$1; shift;;
+esac
+
+if ! [ $n -gt 0 ] 2>/dev/null || [ $n -gt 64 ]; then
+    echo "Wrong argument value (\"$n\"). Aborting."
+    exit 1
+fi
+
+min=5; max=10
+args=("$@")
+while [ $# -gt 0 ]; do
+    case $1 in
+        -m) min=$2; shift;;
+        -M) max=$2; shift;;
+    esac
+    shift
+done
+
+cpus=$(nproc)
+for i in $(seq 0 $((n - 1)))
+do
+    ./probSemSharedMemAirLift -i $i -A $((i % cpus)) "${args[@]}" par.$i.log &
+    pid[$i]=$!
+done
+
+fails=0
+for i in $(seq 0 $((n - 1)))
+do
+    if wait ${pid[$i]}; then
+        r=$(awk -v minFC=$min -v maxFC=$max -f invariants.awk par.$i.log) || fails=$((fails + 1))
+    else
+        r="simulation failed"; fails=$((fails + 1))
+    fi
+    printf "instance %2d: %s\n" $i "$r"
+done
+rm -f par.*.log
+
+echo "$fails instances failed"
+[ $fails -eq 0 ]
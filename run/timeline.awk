@@ -0,0 +1,29 @@
+# Summarizes a timeline of the flights written as CSV (probSemSharedMemAirLift -e file.csv):
+#   - per flight: plane, passengers, time boarding (boarding started to departed), flying (departed to arrived),
+#     unloading (arrived to plane empty) and the time the pilot took to notice the plane was empty (to returning);
+#   - the mean and max time the passengers waited in queue.
+# Usage: awk -F, -f timeline.awk file.csv
+# The times are printed in us.
+
+NR == 1 { next }
+
+{ f = $3 }
+$2 == "boarding"  { start[f] = $1; plane[f] = $4; if (f > nF) nF = f }
+$2 == "checked"   { pass[f]++; wait += $6; nWait++; if ($6 > maxWait) maxWait = $6 }
+$2 == "departed"  { dep[f] = $1 }
+$2 == "arrived"   { arr[f] = $1 }
+$2 == "empty"     { emp[f] = $1 }
+$2 == "returning" { ret[f] = $1 }
+
+END {
+    printf("%6s %5s %5s %10s %10s %10s %10s\n", "flight", "plane", "pass", "boarding", "flying", "unloading",
+           "returning")
+    for (f = 1; f <= nF; f++) {
+        printf("%6d %5d %5d %10.1f %10.1f %10.1f %10.1f\n", f, plane[f], pass[f], (dep[f] - start[f]) / 1000,
+               (arr[f] - dep[f]) / 1000, (emp[f] - arr[f]) / 1000, (ret[f] - emp[f]) / 1000)
+    }
+    if (nWait > 0) {
+        printf("%d passengers waited in queue %.1f us on average, %.1f us at most\n", nWait, wait / nWait / 1000,
+               maxWait / 1000)
+    }
+}
@@ -0,0 +1,469 @@
+/**
+ *  \file benchAirLift.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Benchmark driver of the simulation.
+ *
+ *  Every configuration is a string with command line options of <tt>probSemSharedMemAirLift</tt> (number of
+ *  passengers, flight capacities, logging backend, thread mode, ...). The simulation is run a number of times per
+ *  configuration and, for each run, the following figures are recorded:
+ *    \li wall time and passengers carried per second
+ *    \li flights used, read from the logging file, or files, of the run and summed over the runs of the simulation
+ *        (<tt>-R</tt> of the configuration)
+ *    \li user and system time, voluntary and involuntary context switches and minor page faults of the simulation
+ *        and of all the entities it waited for (<tt>wait4</tt>); the number of system calls is not recorded,
+ *        <tt>wait4</tt> does not report it and tracing the entities would distort the times measured.
+ *
+ *  The runs are written in CSV (default) or JSON format and a summary per configuration (mean, standard deviation,
+ *  min, median and max of the wall time) is printed on stderr.
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-R</tt> number of runs per configuration
+ *    \li <tt>-V</tt> name of the build variant, so that the results of different builds can be merged
+ *    \li <tt>-T</tt> timeout of a run in seconds, the run is terminated, so that it removes its IPC objects, and
+ *        killed if it is still running <tt>GRACE</tt> seconds later
+ *    \li <tt>-S</tt> base seed, run <tt>r</tt> of every configuration is given seed <tt>seed + r</tt>, so that every
+ *        configuration carries the same workloads (a different one on each run, if missing)
+ *    \li <tt>-j</tt> to write the runs in JSON format
+ *    \li <tt>-o</tt> name of the output file (stdout if missing)
+ *    \li the configurations, after <tt>--</tt> (the default configuration, if none is given).
+ *
+ *  It must be run in the directory of the simulation executables, possibly side by side with other simulations or
+ *  benchmarks: the runs are logged into files named after the process, <tt>bench.</tt><em>pid</em><tt>.log</tt>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "probConst.h"
+
+/** \brief name of the simulation program */
+#define   AIRLIFT       "./probSemSharedMemAirLift"
+
+/** \brief name of the binary logging file decoder */
+#define   DECODER       "./logDecoder"
+
+/** \brief max size of the name of a logging file, as in the simulation */
+#define   LOGNAME       51
+
+/** \brief max number of options of a configuration */
+#define   MAXARGS       32
+
+/** \brief time a run that timed out is given to tear itself down (s) */
+#define   GRACE         5
+
+/**
+ *  \brief Definition of <em>run</em> data type.
+ */
+typedef struct
+        { /** \brief wall time (s) */
+          double wall;
+          /** \brief user and system time (s) */
+          double utime, stime;
+          /** \brief voluntary and involuntary context switches */
+          long nvcsw, nivcsw;
+          /** \brief minor page faults */
+          long minflt;
+          /** \brief flights used, -1 if unknown */
+          int flights;
+          /** \brief outcome: "ok", "failed" or "timeout" */
+          char *status;
+        } RUN;
+
+/** \brief name of the logging file of the runs, after the process (room for the run suffix is left) */
+static char logFile[24];
+
+/** \brief process group of the run in progress */
+static pid_t runPid;
+
+/** \brief the run in progress timed out */
+static volatile sig_atomic_t timedOut;
+
+/**
+ *  \brief Termination of the run in progress when its time is over.
+ *
+ *  The simulation removes the IPC objects of its instance when it is terminated, it is only killed when it is not
+ *  over after the grace time.
+ *
+ *  \param sig signal number
+ */
+
+static void timeout (int sig)
+{
+    kill (-runPid, (timedOut) ? SIGKILL : SIGTERM);
+    if (!timedOut) {
+        timedOut = true;
+        alarm (GRACE);
+    }
+}
+
+/**
+ *  \brief Name of the logging file of a run of the simulation.
+ *
+ *  The same scheme as the simulation: with more than one run each one is logged into a file of its own.
+ *
+ *  \param simRuns number of runs of the simulation
+ *  \param r run
+ *  \param name storage for the name (<tt>LOGNAME</tt> characters)
+ */
+
+static void runLogName (unsigned int simRuns, unsigned int r, char name[])
+{
+    if (simRuns > 1) {
+        snprintf (name, LOGNAME, "%s.%u", logFile, r);
+    }
+    else strcpy (name, logFile);
+}
+
+/**
+ *  \brief Removal of the logging files of a run.
+ *
+ *  \param simRuns number of runs of the simulation
+ */
+
+static void removeLogs (unsigned int simRuns)
+{
+    char name[LOGNAME];
+    unsigned int r;
+
+    for (r = 0; r < simRuns; r++) {
+        runLogName (simRuns, r, name);
+        unlink (name);
+    }
+}
+
+/**
+ *  \brief Number of flights used by a run, read from its logging files.
+ *
+ *  A binary logging file is decoded first.
+ *
+ *  \param binary the logging files are binary
+ *  \param simRuns number of runs of the simulation
+ *
+ *  \return number of flights summed over the runs of the simulation, -1 if it is not found in every file
+ */
+
+static int flightsUsed (bool binary, unsigned int simRuns)
+{
+    FILE *fic;
+    char name[LOGNAME], text[LOGNAME + 4], cmd[3 * LOGNAME];
+    char line[256];
+    int flights, total = 0;
+    unsigned int r;
+
+    for (r = 0; r < simRuns; r++) {
+        runLogName (simRuns, r, name);
+        snprintf (text, sizeof (text), "%s.txt", name);
+        snprintf (cmd, sizeof (cmd), DECODER " %s %s > /dev/null 2>&1", name, text);
+        if (binary && (system (cmd) != 0)) {
+            return -1;
+        }
+        if ((fic = fopen (binary ? text : name, "r")) == NULL) {
+            return -1;
+        }
+        flights = -1;
+        while (fgets (line, sizeof (line), fic) != NULL) {
+            sscanf (line, "AirLift used %d Flights", &flights);
+        }
+        fclose (fic);
+        if (binary) {
+            unlink (text);
+        }
+        if (flights == -1) {
+            return -1;
+        }
+        total += flights;
+    }
+    return total;
+}
+
+/**
+ *  \brief Splitting of a configuration into the command line of the simulation.
+ *
+ *  \param config configuration (it is changed)
+ *  \param seed seed of the run, as a string (empty if none)
+ *  \param argv storage for the command line, terminated by a null pointer
+ *  \param nPass storage for the number of passengers
+ *  \param simRuns storage for the number of runs of the simulation
+ *  \param binary storage for the selection of the binary logging backend
+ */
+
+static void commandLine (char config[], char seed[], char *argv[], unsigned int *nPass, unsigned int *simRuns,
+                         bool *binary)
+{
+    int n = 0;
+    char *tok;
+
+    *nPass = N;
+    *simRuns = 1;
+    *binary = false;
+    argv[n++] = AIRLIFT;
+    for (tok = strtok (config, " "); (tok != NULL) && (n < MAXARGS - 4); tok = strtok (NULL, " ")) {
+        if (strcmp (tok, "-b") == 0) {
+            *binary = true;
+        }
+        if ((strncmp (tok, "-n", 2) == 0) && (tok[2] != '\0')) {
+            *nPass = (unsigned int) atoi (&tok[2]);
+        }
+        else if (strcmp (argv[n-1], "-n") == 0) {
+            *nPass = (unsigned int) atoi (tok);
+        }
+        if ((strncmp (tok, "-R", 2) == 0) && (tok[2] != '\0')) {
+            *simRuns = (unsigned int) atoi (&tok[2]);
+        }
+        else if (strcmp (argv[n-1], "-R") == 0) {
+            *simRuns = (unsigned int) atoi (tok);
+        }
+        argv[n++] = tok;
+    }
+    if (seed[0] != '\0') {
+        argv[n++] = "-s";
+        argv[n++] = seed;
+    }
+    argv[n++] = logFile;
+    argv[n] = NULL;
+}
+
+/**
+ *  \brief One run of the simulation.
+ *
+ *  \param config configuration
+ *  \param seed seed of the run, as a string (empty if none)
+ *  \param limit timeout in seconds
+ *  \param nPass storage for the number of passengers
+ *
+ *  \return figures of the run
+ */
+
+static RUN runOnce (char config[], char seed[], unsigned int limit, unsigned int *nPass)
+{
+    char buf[256];                                                                       /* copy of the configuration */
+    char *argv[MAXARGS];                                                            /* command line of the simulation */
+    bool binary;                                                                       /* binary logging backend used */
+    unsigned int simRuns;                                                                  /* runs of the simulation */
+    struct timespec t0, t1;                                                               /* start and end of the run */
+    struct rusage ru;                                                       /* resources used by the run and entities */
+    int status;                                                                                   /* execution status */
+    RUN run = { 0.0, 0.0, 0.0, 0, 0, 0, -1, "failed" };
+
+    strncpy (buf, config, sizeof (buf) - 1);
+    buf[sizeof (buf) - 1] = '\0';
+    commandLine (buf, seed, argv, nPass, &simRuns, &binary);
+    if (simRuns == 0) {
+        simRuns = 1;
+    }
+    removeLogs (simRuns);
+
+    fflush (NULL);                                                                /* nothing pending is written twice */
+    clock_gettime (CLOCK_MONOTONIC, &t0);
+    if ((runPid = fork ()) < 0) {
+        perror ("error on the fork operation for the simulation");
+        exit (EXIT_FAILURE);
+    }
+    if (runPid == 0) {
+        setpgid (0, 0);                                                      /* the entities are killed along with it */
+        freopen ("/dev/null", "w", stdout);
+        execv (AIRLIFT, argv);
+        perror ("error on the generation of the simulation process");
+        exit (EXIT_FAILURE);
+    }
+    setpgid (runPid, runPid);
+    timedOut = false;
+    alarm (limit);
+    while ((wait4 (runPid, &status, 0, &ru) == -1) && (errno == EINTR));
+    alarm (0);
+    clock_gettime (CLOCK_MONOTONIC, &t1);
+
+    run.wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    run.utime = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6;
+    run.stime = ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+    run.nvcsw = ru.ru_nvcsw;
+    run.nivcsw = ru.ru_nivcsw;
+    run.minflt = ru.ru_minflt;
+    if (timedOut) {
+        kill (-runPid, SIGKILL);                                                   /* whatever may be left of the run */
+        run.status = "timeout";
+    }
+    else if (WIFEXITED (status) && (WEXITSTATUS (status) == EXIT_SUCCESS)) {
+        run.status = "ok";
+        run.flights = flightsUsed (binary, simRuns);
+    }
+    removeLogs (simRuns);
+    return run;
+}
+
+/**
+ *  \brief Ordering of wall times.
+ */
+
+static int byWall (const void *a, const void *b)
+{
+    double wa = *(const double *) a,
+           wb = *(const double *) b;
+
+    return (wa > wb) - (wa < wb);
+}
+
+/**
+ *  \brief Printing of the summary of the runs of a configuration on stderr.
+ *
+ *  \param variant build variant
+ *  \param config configuration
+ *  \param runs runs of the configuration
+ *  \param nRuns number of runs
+ *  \param nPass number of passengers
+ */
+
+static void printSummary (char variant[], char config[], RUN runs[], unsigned int nRuns, unsigned int nPass)
+{
+    double wall[nRuns];                                                                /* wall times of the good runs */
+    double mean = 0.0, var = 0.0, med;
+    unsigned int r, n = 0;
+
+    for (r = 0; r < nRuns; r++) {
+        if (strcmp (runs[r].status, "ok") == 0) {
+            wall[n++] = runs[r].wall;
+            mean += runs[r].wall;
+        }
+    }
+    if (n == 0) {
+        fprintf (stderr, "%-8s %-32s no successful runs\n", variant, config);
+        return;
+    }
+    mean /= n;
+    for (r = 0; r < n; r++) {
+        var += (wall[r] - mean) * (wall[r] - mean);
+    }
+    var = (n > 1) ? var / (n - 1) : 0.0;
+    qsort (wall, n, sizeof (double), byWall);
+    med = (n % 2 == 1) ? wall[n/2] : (wall[n/2-1] + wall[n/2]) / 2;
+    fprintf (stderr, "%-8s %-32s %3u/%-3u %9.3f %9.3f %9.3f %9.3f %9.3f %10.1f\n", variant, config, n, nRuns, mean,
+             sqrt (var), wall[0], med, wall[n-1], nPass / mean);
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is running every configuration the requested number of times and writing the figures of the runs.
+ */
+
+int main (int argc, char *argv[])
+{
+    unsigned int nRuns = 5;                                                                 /* runs per configuration */
+    unsigned int limit = 120;                                                                 /* timeout of a run (s) */
+    bool seeded = false;                                                                  /* the runs are given seeds */
+    unsigned long seed = 0;                                                                              /* base seed */
+    char sd[24] = "";                                                                     /* seed of a run, as string */
+    char *variant = "all";                                                                           /* build variant */
+    bool json = false;                                                                          /* JSON output format */
+    FILE *out = stdout;                                                                                /* output file */
+    char *defConfig[] = { "" };                                                              /* default configuration */
+    char **config;                                                                                  /* configurations */
+    int nConfig;                                                                          /* number of configurations */
+    RUN *runs;                                                                             /* runs of a configuration */
+    unsigned int nPass;                                                                       /* number of passengers */
+    unsigned int r;
+    int c, opt;
+    bool first = true;
+
+    while ((opt = getopt (argc, argv, "+R:V:T:S:jo:")) != -1) {
+        switch (opt) {
+            case 'R':
+                nRuns = (unsigned int) atoi (optarg);
+                break;
+            case 'V':
+                variant = optarg;
+                break;
+            case 'T':
+                limit = (unsigned int) atoi (optarg);
+                break;
+            case 'S':
+                seeded = true;
+                seed = strtoul (optarg, NULL, 0);
+                break;
+            case 'j':
+                json = true;
+                break;
+            case 'o':
+                if ((out = fopen (optarg, "w")) == NULL) {
+                    perror ("error on opening the output file");
+                    exit (EXIT_FAILURE);
+                }
+                break;
+            default:
+                fprintf (stderr, "Usage: %s [-R runs] [-V variant] [-T timeout] [-S seed] [-j] [-o output] [configuration ...]\n",
+                         argv[0]);
+                exit (EXIT_FAILURE);
+        }
+    }
+    if (nRuns == 0) {
+        fprintf (stderr, "The number of runs must be positive!\n");
+        exit (EXIT_FAILURE);
+    }
+    if (optind < argc) {
+        config = &argv[optind];
+        nConfig = argc - optind;
+    }
+    else {
+        config = defConfig;
+        nConfig = 1;
+    }
+    if ((runs = malloc (nRuns * sizeof (RUN))) == NULL) {
+        perror ("error on allocating the runs array");
+        exit (EXIT_FAILURE);
+    }
+    snprintf (logFile, sizeof (logFile), "bench.%d.log", (int) getpid ());
+    signal (SIGALRM, timeout);
+
+    if (json) {
+        fprintf (out, "[\n");
+    }
+    else fprintf (out, "variant,config,run,passengers,status,wall_s,flights,pass_per_s,utime_s,stime_s,"
+                       "nvcsw,nivcsw,minflt\n");
+    fprintf (stderr, "%-8s %-32s %7s %9s %9s %9s %9s %9s %10s\n", "variant", "config", "ok", "mean_s", "sd_s",
+             "min_s", "median_s", "max_s", "pass/s");
+    for (c = 0; c < nConfig; c++) {
+        for (r = 0; r < nRuns; r++) {
+            if (seeded) {
+                sprintf (sd, "%u", (unsigned int) (seed + r));
+            }
+            runs[r] = runOnce (config[c], sd, limit, &nPass);
+            if (json) {
+                fprintf (out, "%s  {\"variant\": \"%s\", \"config\": \"%s\", \"run\": %u, \"passengers\": %u, "
+                              "\"status\": \"%s\", \"wall_s\": %.6f, \"flights\": %d, \"pass_per_s\": %.1f, "
+                              "\"utime_s\": %.6f, \"stime_s\": %.6f, \"nvcsw\": %ld, \"nivcsw\": %ld, "
+                              "\"minflt\": %ld}", first ? "" : ",\n", variant, config[c], r + 1, nPass,
+                         runs[r].status, runs[r].wall, runs[r].flights, nPass / runs[r].wall, runs[r].utime,
+                         runs[r].stime, runs[r].nvcsw, runs[r].nivcsw, runs[r].minflt);
+            }
+            else fprintf (out, "%s,\"%s\",%u,%u,%s,%.6f,%d,%.1f,%.6f,%.6f,%ld,%ld,%ld\n", variant, config[c], r + 1,
+                          nPass, runs[r].status, runs[r].wall, runs[r].flights, nPass / runs[r].wall, runs[r].utime,
+                          runs[r].stime, runs[r].nvcsw, runs[r].nivcsw, runs[r].minflt);
+            fflush (out);
+            first = false;
+        }
+        printSummary (variant, config[c], runs, nRuns, nPass);
+    }
+    if (json) {
+        fprintf (out, "\n]\n");
+    }
+
+    free (runs);
+    if (out != stdout) {
+        fclose (out);
+    }
+
+    return EXIT_SUCCESS;
+}
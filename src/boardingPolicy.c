@@ -0,0 +1,106 @@
+/**
+ *  \file boardingPolicy.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Boarding policies of the hostesses.
+ *
+ *  Defined operations:
+ *     \li parsing of the name of a policy
+ *     \li time to wait for one more passenger
+ *     \li reading of the clock the elapsed time is measured on.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "probConst.h"
+#include "boardingPolicy.h"
+
+/** \brief names of the policies, by kind */
+static const char *names[] = { "greedy", "hold", "predict" };
+
+/**
+ *  \brief Parsing of the name of a policy.
+ *
+ *  \param arg name of the policy
+ *  \param pol storage for the policy
+ *
+ *  \return \c true, if the name is valid
+ */
+
+bool policyParse (const char *arg, BOARD_POLICY *pol)
+{
+    const char *sep = strchr (arg, ':');
+    size_t len = (sep == NULL) ? strlen (arg) : (size_t) (sep - arg);
+    unsigned long hold = POLICY_DEFHOLD;
+    char *tinp;
+    unsigned int k;
+
+    for (k = 0; (k < sizeof (names) / sizeof (names[0])) && ((strlen (names[k]) != len) ||
+                                                              (strncmp (arg, names[k], len) != 0)); k++)
+        ;
+    if (k == sizeof (names) / sizeof (names[0])) {
+        return false;
+    }
+    if (sep != NULL) {
+        hold = strtoul (sep + 1, &tinp, 0);
+        if ((*tinp != '\0') || (sep[1] == '\0') || (hold == 0) || (hold > 1000000) || (k == POLICY_GREEDY)) {
+            return false;
+        }
+    }
+    pol->kind = k;
+    pol->hold = (k == POLICY_GREEDY) ? 0 : (unsigned int) hold;
+    return true;
+}
+
+/**
+ *  \brief Time to wait for one more passenger.
+ *
+ *  The passengers still going to the airport arrive at times uniformly distributed between the time elapsed and
+ *  the longest travel time, so the first one of them is expected after that interval divided by their number plus
+ *  one. The hostesses wait for twice as long, to catch it most of the times, unless it is expected after the time
+ *  they are given. Late passengers, the ones past the longest travel time, are only waited for that time.
+ *
+ *  \param pol policy
+ *  \param going number of passengers still going to the airport
+ *  \param elapsed time elapsed since the passengers started going to the airport (us)
+ *
+ *  \return time to wait for (us), \c 0 if the flight is to depart at once
+ */
+
+unsigned int policyHold (const BOARD_POLICY *pol, unsigned int going, unsigned long long elapsed)
+{
+    unsigned long long from = (elapsed < 1000) ? 1000 : elapsed,                    /* no passenger arrives before it */
+                       to = 1000 + (unsigned long long) MAXTRAVEL,                                    /* nor after it */
+                       gap;                                                               /* time to the next arrival */
+
+    if ((going == 0) || (pol->kind == POLICY_GREEDY)) {
+        return 0;
+    }
+    if (pol->kind == POLICY_HOLD) {
+        return pol->hold;
+    }
+    gap = (from < to) ? (to - from) / (going + 1) : 0;
+    if (gap > pol->hold) {
+        return 0;
+    }
+    return ((gap == 0) || (2 * gap > pol->hold)) ? pol->hold : (unsigned int) (2 * gap);
+}
+
+/**
+ *  \brief Reading of the clock the elapsed time is measured on.
+ *
+ *  \return time (us)
+ */
+
+unsigned long long policyClock (void)
+{
+    struct timespec t;
+
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return (unsigned long long) t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
@@ -0,0 +1,89 @@
+/**
+ *  \file boardingPolicy.h (interface file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Boarding policies of the hostesses.
+ *
+ *  Once a flight has its min capacity and no passenger is left in queue, a policy decides how long the hostesses
+ *  still wait for one more passenger before the flight departs:
+ *     \li greedy: not at all, the flight departs as soon as the queue is empty
+ *     \li hold: a fixed time
+ *     \li predict: the time the next passenger is expected to take to reach the airport, from the number of
+ *         passengers still travelling and the uniform distribution of the travel times, as long as it is not
+ *         longer than the time the policy is given; the flight departs at once otherwise.
+ *  A flight that is full, or that takes the last passengers, always departs at once.
+ *
+ *  Operations defined on a policy:
+ *     \li parsing of its name
+ *     \li time to wait for one more passenger
+ *     \li reading of the clock the elapsed time is measured on.
+ */
+
+#ifndef BOARDINGPOLICY_H_
+#define BOARDINGPOLICY_H_
+
+#include <stdbool.h>
+
+/* Kinds of policy */
+
+/** \brief the flight departs as soon as the queue is empty */
+#define  POLICY_GREEDY      0
+/** \brief the hostesses wait for a fixed time */
+#define  POLICY_HOLD        1
+/** \brief the hostesses wait for the next passenger expected to arrive */
+#define  POLICY_PREDICT     2
+
+/** \brief time the hostesses may wait for, if the policy does not name it (us) */
+#define  POLICY_DEFHOLD  2000
+
+/**
+ *  \brief Definition of <em>boarding policy</em> data type.
+ *
+ *  A zeroed policy is the greedy one.
+ */
+typedef struct
+{ /** \brief kind of policy (<tt>POLICY_GREEDY</tt>, <tt>POLICY_HOLD</tt> or <tt>POLICY_PREDICT</tt>) */
+    unsigned int kind;
+    /** \brief time the hostesses may wait for one more passenger (us) */
+    unsigned int hold;
+
+} BOARD_POLICY;
+
+/**
+ *  \brief Parsing of the name of a policy.
+ *
+ *  The names are <tt>greedy</tt>, <tt>hold[:us]</tt> and <tt>predict[:us]</tt>, the time is
+ *  <tt>POLICY_DEFHOLD</tt> if it is missing.
+ *
+ *  \param arg name of the policy
+ *  \param pol storage for the policy
+ *
+ *  \return \c true, if the name is valid
+ */
+
+extern bool policyParse (const char *arg, BOARD_POLICY *pol);
+
+/**
+ *  \brief Time to wait for one more passenger.
+ *
+ *  Called when a flight has its min capacity, has seats left and there is no passenger in queue.
+ *
+ *  \param pol policy
+ *  \param going number of passengers still going to the airport
+ *  \param elapsed time elapsed since the passengers started going to the airport (us)
+ *
+ *  \return time to wait for (us), \c 0 if the flight is to depart at once
+ */
+
+extern unsigned int policyHold (const BOARD_POLICY *pol, unsigned int going, unsigned long long elapsed);
+
+/**
+ *  \brief Reading of the clock the elapsed time is measured on (<tt>CLOCK_MONOTONIC</tt>).
+ *
+ *  \return time (us)
+ */
+
+extern unsigned long long policyClock (void);
+
+#endif /* BOARDINGPOLICY_H_ */
@@ -0,0 +1,188 @@
+/**
+ *  \file desAirLift.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Discrete event simulation in a single process.
+ *
+ *  The pilots, hostesses and passengers go through the same states as in the concurrent implementation, driven
+ *  by the events of the discrete event simulation engine, so the simulation is deterministic for a given seed
+ *  of the random generator.
+ *
+ *  The full state of the problem is logged with the same operations as the concurrent implementation, timed
+ *  in virtual time, and the air lift result is the same summary.
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-n</tt> number of passengers, <tt>-m</tt> min flight capacity, <tt>-M</tt> max flight capacity and
+ *        <tt>-f</tt> max number of flights (the defaults are the values in probConst.h)
+ *    \li <tt>-H</tt> number of hostesses and <tt>-P</tt> number of planes
+ *    \li <tt>-s</tt> or <tt>--seed</tt> base seed of the random generators, the same travel and flight times as
+ *        <tt>probSemSharedMemAirLift</tt> with the same seed are drawn
+ *    \li <tt>-p</tt> boarding policy of the hostesses, <tt>greedy</tt>, <tt>hold[:us]</tt> or <tt>predict[:us]</tt>
+ *        (see boardingPolicy.h; greedy, if missing)
+ *    \li <tt>-b</tt> to select the binary logging backend
+ *    \li <tt>-d</tt> to write the state lines in the delta layout, the argument is the period of the full ones
+ *    \li <tt>-q</tt> to log only the air lift result
+ *    \li name of the logging file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "logging.h"
+#include "boardingPolicy.h"
+#include "desEngine.h"
+
+/** \brief name of logging file */
+static char nFic[51];
+
+/**
+ *  \brief Conversion of a numerical command line parameter.
+ *
+ *  The program is terminated if the value is not a positive integer.
+ *
+ *  \param arg command line parameter
+ *  \param name name of the parameter, for error reporting
+ *
+ *  \return value of the parameter
+ */
+
+static unsigned int getParam (char *arg, char *name)
+{
+    char *tinp;                                                                     /* numerical parameters test flag */
+    long val;
+
+    val = strtol (arg, &tinp, 0);
+    if ((*tinp != '\0') || (val <= 0) || (val > 1000000)) {
+        fprintf (stderr, "Wrong value for the %s (\"%s\")!\n", name, arg);
+        exit (EXIT_FAILURE);
+    }
+    return (unsigned int) val;
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is to create the simulation and the log file, to run the simulation and to save the air lift
+ *  result.
+ */
+
+int main (int argc, char *argv[])
+{
+    PARAM par = { N, MINFC, MAXFC, 0, NHT, NPT };                                               /* problem parameters */
+    unsigned int backend = LOG_TEXT;                                                               /* logging backend */
+    unsigned int seed = (unsigned int) getpid ();                                   /* base seed of random generators */
+    static struct option longOpts[] = { { "seed", required_argument, NULL, 's' }, { NULL, 0, NULL, 0 } };
+    char *tinp;                                                                     /* numerical parameters test flag */
+    unsigned int keyframe = 0;                                 /* period of the full state lines (0: no delta layout) */
+    LOG_DELTA *delta = NULL;                                                                     /* delta layout data */
+    bool quiet = false;                                                         /* only the air lift result is logged */
+    int opt;                                                                                   /* command line option */
+    DES_SIM *sim;                                                                                       /* simulation */
+    BOARD_POLICY policy = { POLICY_GREEDY, 0 };                                       /* boarding policy of hostesses */
+
+    while ((opt = getopt_long (argc, argv, "n:m:M:f:H:P:s:p:bd:q", longOpts, NULL)) != -1) {
+        switch (opt) {
+            case 'n':
+                par.nPassengers = getParam (optarg, "number of passengers");
+                break;
+            case 'm':
+                par.minFC = getParam (optarg, "min flight capacity");
+                break;
+            case 'M':
+                par.maxFC = getParam (optarg, "max flight capacity");
+                break;
+            case 'f':
+                par.maxNF = getParam (optarg, "max number of flights");
+                break;
+            case 'H':
+                par.nHostesses = getParam (optarg, "number of hostesses");
+                break;
+            case 'P':
+                par.nPilots = getParam (optarg, "number of planes");
+                break;
+            case 's':
+                seed = (unsigned int) strtoul (optarg, &tinp, 0);
+                if ((*tinp != '\0') || (*optarg == '\0')) {
+                    fprintf (stderr, "The seed is wrong!\n");
+                    exit (EXIT_FAILURE);
+                }
+                break;
+            case 'p':
+                if (!policyParse (optarg, &policy)) {
+                    fprintf (stderr, "The boarding policy is wrong (greedy, hold[:us] or predict[:us])!\n");
+                    exit (EXIT_FAILURE);
+                }
+                break;
+            case 'b':
+                backend = LOG_BINARY;
+                break;
+            case 'd':
+                keyframe = getParam (optarg, "period of the full state lines");
+                break;
+            case 'q':
+                quiet = true;
+                break;
+            default:
+                fprintf (stderr, "Usage: %s [-n passengers] [-m min-capacity] [-M max-capacity] [-f max-flights] "
+                                 "[-H hostesses] [-P planes] [-s seed] [-p policy] [-b] [-d keyframe] [-q] "
+                                 "[log-file]\n", argv[0]);
+                exit (EXIT_FAILURE);
+        }
+    }
+    if (par.minFC > par.maxFC) {
+        fprintf (stderr, "The min flight capacity is larger than the max flight capacity!\n");
+        exit (EXIT_FAILURE);
+    }
+    if (par.nHostesses > MAXHT) {
+        fprintf (stderr, "The number of hostesses is larger than %d!\n", MAXHT);
+        exit (EXIT_FAILURE);
+    }
+    if (par.nPilots > MAXPT) {
+        fprintf (stderr, "The number of planes is larger than %d!\n", MAXPT);
+        exit (EXIT_FAILURE);
+    }
+    if (par.maxNF == 0) {                                                        /* enough flights for the worst case */
+        par.maxNF = (par.nPassengers + par.minFC - 1) / par.minFC;
+        if (par.maxNF < MAXNF) {
+            par.maxNF = MAXNF;
+        }
+    }
+    else if (par.maxNF < (par.nPassengers + par.minFC - 1) / par.minFC) {
+        fprintf (stderr, "The max number of flights is too small for the number of passengers!\n");
+        exit (EXIT_FAILURE);
+    }
+    if (optind == argc - 1) {
+        strcpy (nFic, argv[optind]);
+    }
+    else strcpy (nFic, "");
+
+    /* creating the simulation and the log file, the simulation drives the clock of the log */
+
+    sim = desCreate (&par, seed, quiet ? NULL : nFic);
+    sim->policy = policy;
+    setLogBackend (backend, &sim->lsh);
+    if ((keyframe != 0) && (backend != LOG_BINARY)) {
+        if ((delta = malloc (logDeltaSize (&par))) == NULL) {
+            perror ("error on allocating the delta layout");
+            exit (EXIT_FAILURE);
+        }
+        initLogDelta (delta, keyframe);
+        setLogDelta (delta);
+    }
+    createLog (nFic, sim->fSt);
+
+    desRun (sim);
+    saveAirLiftResult (nFic, sim->fSt);
+
+    desDestroy (sim);
+    free (delta);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,479 @@
+/**
+ *  \file desEngine.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Discrete event simulation engine.
+ *
+ *  The pilots, hostesses and passengers go through the same states as in the concurrent implementation, but
+ *  they are driven by a priority queue of timed events (passenger arrival at the airport, plane arrival at the
+ *  starting airport and at the destination, end of the wait of the boarding policy for one more passenger) and
+ *  every other transition takes no time. There are neither
+ *  processes nor semaphores, and every simulation keeps its whole state, random generators included, in a
+ *  structure of its own, so that many of them may run at the same time in different threads and each one is
+ *  deterministic for a given seed. The travel and flight times are drawn from a generator per entity seeded as
+ *  in the concurrent implementation, so both of them carry the same workload for the same seed.
+ *
+ *  Operations defined on a simulation:
+ *     \li creation, for some problem parameters and seed
+ *     \li running it until every passenger is at the destination
+ *     \li destruction.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "logging.h"
+#include "boardingPolicy.h"
+#include "desEngine.h"
+
+/* Timed events */
+
+/** \brief passenger arrives at the airport */
+#define  ARRIVAL        0
+/** \brief plane arrives at the starting airport */
+#define  AT_ORIGIN      1
+/** \brief plane arrives at the destination */
+#define  AT_TARGET      2
+/** \brief the hostesses stop waiting for one more passenger of a flight */
+#define  HOLD_OVER      3
+
+/**
+ *  \brief Ordering of events.
+ *
+ *  \return \c true if event <tt>a</tt> comes before event <tt>b</tt>
+ */
+
+static bool before (DES_EVENT *a, DES_EVENT *b)
+{
+    return (a->at < b->at) || ((a->at == b->at) && (a->seq < b->seq));
+}
+
+/**
+ *  \brief Scheduling of an event.
+ *
+ *  \param s simulation
+ *  \param delay time from now (us)
+ *  \param kind kind of event
+ *  \param id passenger, plane or flight
+ */
+
+static void schedule (DES_SIM *s, unsigned int delay, unsigned int kind, unsigned int id)
+{
+    DES_EVENT e = { s->now + delay, s->nSeq++, kind, id };
+    unsigned int i = s->nPending++;
+
+    while ((i > 0) && before (&e, &s->pending[(i - 1) / 2])) {
+        s->pending[i] = s->pending[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    s->pending[i] = e;
+}
+
+/**
+ *  \brief Removal of the earliest event.
+ *
+ *  \param s simulation
+ *
+ *  \return earliest event
+ */
+
+static DES_EVENT next (DES_SIM *s)
+{
+    DES_EVENT first = s->pending[0],
+              last = s->pending[--s->nPending];
+    unsigned int i = 0, c;
+
+    while ((c = 2 * i + 1) < s->nPending) {
+        if ((c + 1 < s->nPending) && before (&s->pending[c + 1], &s->pending[c])) {
+            c++;
+        }
+        if (!before (&s->pending[c], &last)) {
+            break;
+        }
+        s->pending[i] = s->pending[c];
+        i = c;
+    }
+    s->pending[i] = last;
+    return first;
+}
+
+/**
+ *  \brief Random time a passenger takes to reach the airport.
+ *
+ *  \param seed base seed of the random generators
+ *  \param id passenger id
+ */
+
+static unsigned int travelTime (unsigned int seed, unsigned int id)
+{
+    RND_GEN rnd;                                                                     /* the passenger draws only once */
+
+    rndInit (&rnd, rndSeed (seed, RND_PASSENGER, id));
+    return (unsigned int) floor ((MAXTRAVEL * rndNext (&rnd)) / RAND_MAX + 1000);
+}
+
+/**
+ *  \brief Random time a flight takes.
+ *
+ *  \param s simulation
+ *  \param plane plane
+ */
+
+static unsigned int flightTime (DES_SIM *s, unsigned int plane)
+{
+    return (unsigned int) floor ((MAXFLIGHT * rndNext (&s->pilotRnd[plane])) / RAND_MAX + 100.0);
+}
+
+/**
+ *  \brief Logging of the present full state, if the events are logged.
+ *
+ *  \param s simulation
+ */
+
+static void logState (DES_SIM *s)
+{
+    if (s->log) {
+        saveState (s->nFic, s->fSt);
+    }
+}
+
+/**
+ *  \brief Boarding completion test, as done by the hostesses.
+ *
+ *  \param s simulation
+ *  \param hold storage for the time the hostesses wait for one more passenger (us), \c 0 if they do not
+ *
+ *  \return true if no more seats of the current flight may be taken
+ */
+
+static bool boardingComplete (DES_SIM *s, unsigned int *hold)
+{
+    FULL_STAT *fSt = s->fSt;
+    unsigned int inFlight = fSt->planePass[fSt->boardingPlane];
+
+    *hold = 0;
+    if ((inFlight == fSt->par.maxFC) || (fSt->totalPassBoarded == fSt->par.nPassengers)) {
+        return true;
+    }
+    if ((inFlight >= fSt->par.minFC) && (fSt->nPassInQueue == 0)) {
+        *hold = policyHold (&s->policy, fSt->par.nPassengers - fSt->totalPassBoarded, s->now);
+        return *hold == 0;
+    }
+    return false;
+}
+
+/**
+ *  \brief Start of boarding of a plane, the hostesses wait for passengers at every gate.
+ *
+ *  \param s simulation
+ *  \param plane plane to be boarded
+ */
+
+static void startBoarding (DES_SIM *s, unsigned int plane)
+{
+    FULL_STAT *fSt = s->fSt;
+    unsigned int g;
+
+    s->boarding = true;
+    fSt->nFlight++;
+    fSt->boardingPlane = plane;
+    fSt->planeFlight[plane] = fSt->nFlight;
+    logState (s);
+    if (s->log) {
+        saveStartBoarding (s->nFic, fSt);
+    }
+    fSt->st.pilotStat[plane] = WAITING_FOR_BOARDING;
+    logState (s);
+    for (g = 0; g < fSt->par.nHostesses; g++) {
+        fSt->st.hostessStat[g] = WAIT_FOR_PASSENGER;
+        logState (s);
+    }
+}
+
+/**
+ *  \brief Departure of the plane being boarded.
+ *
+ *  The flight is registered, the pilot takes off and the turn to board goes to the next plane waiting.
+ *
+ *  \param s simulation
+ */
+
+static void depart (DES_SIM *s)
+{
+    FULL_STAT *fSt = s->fSt;
+    unsigned int plane = fSt->boardingPlane,
+                 g;
+
+    fSt->st.hostessStat[s->nextGate] = READY_TO_FLIGHT;
+    passengersPerFlight (fSt)[fSt->nFlight-1] = fSt->planePass[plane];
+    planePerFlight (fSt)[fSt->nFlight-1] = plane;
+    fSt->finished = fSt->totalPassBoarded == fSt->par.nPassengers;
+    logState (s);
+    if (s->log) {
+        saveFlightDeparted (s->nFic, fSt);
+    }
+    s->boarding = false;
+
+    fSt->st.pilotStat[plane] = FLYING;
+    logState (s);
+    schedule (s, flightTime (s, plane), AT_TARGET, plane);
+
+    if (!fSt->finished) {
+        for (g = 0; g < fSt->par.nHostesses; g++) {
+            fSt->st.hostessStat[g] = WAIT_FOR_FLIGHT;
+            logState (s);
+        }
+        if (s->readyHead != s->readyTail) {
+            startBoarding (s, s->planeReady[s->readyHead]);
+            s->readyHead = (s->readyHead + 1) % MAXPT;
+        }
+    }
+}
+
+/**
+ *  \brief Passports of the passengers in queue checked, while there are seats left in the plane being boarded.
+ *
+ *  \param s simulation
+ */
+
+static void checkPassports (DES_SIM *s)
+{
+    FULL_STAT *fSt = s->fSt;
+    unsigned int plane, id, hold;
+
+    while (s->boarding && (fSt->nPassInQueue > 0)) {
+        plane = fSt->boardingPlane;                               /* the turn may have gone to the next plane waiting */
+        fSt->st.hostessStat[s->nextGate] = CHECK_PASSPORT;
+        logState (s);
+
+        id = s->queue[s->queueHead++];
+        s->onBoard[plane * fSt->par.maxFC + fSt->planePass[plane]] = id;
+        fSt->nPassInQueue--;
+        fSt->nPassInFlight++;
+        fSt->planePass[plane]++;
+        fSt->totalPassBoarded++;
+        fSt->passengerChecked = (int) id;
+        if (s->log) {
+            savePassengerChecked (s->nFic, fSt);
+        }
+        logState (s);
+        passengerStat (fSt)[id] = IN_FLIGHT;
+        logState (s);
+
+        if (boardingComplete (s, &hold)) {
+            depart (s);
+        }
+        else {
+            fSt->st.hostessStat[s->nextGate] = WAIT_FOR_PASSENGER;
+            logState (s);
+            s->nextGate = (s->nextGate + 1) % fSt->par.nHostesses;
+            if (hold != 0) {                                                   /* a later passenger cancels this wait */
+                s->holdAt = s->now + hold;
+                schedule (s, hold, HOLD_OVER, fSt->nFlight);
+            }
+        }
+    }
+}
+
+/**
+ *  \brief The hostesses stop waiting for one more passenger and the flight departs, unless it already did or a
+ *  passenger arrived meanwhile.
+ *
+ *  \param s simulation
+ *  \param flight flight being waited for
+ */
+
+static void holdOver (DES_SIM *s, unsigned int flight)
+{
+    if (s->boarding && (s->fSt->nFlight == flight) && (s->now == s->holdAt)) {
+        depart (s);
+    }
+}
+
+/**
+ *  \brief A passenger arrives at the airport and joins the queue.
+ *
+ *  \param s simulation
+ *  \param id passenger id
+ */
+
+static void arrival (DES_SIM *s, unsigned int id)
+{
+    passengerStat (s->fSt)[id] = IN_QUEUE;
+    s->fSt->nPassInQueue++;
+    s->queue[s->queueTail++] = id;
+    logState (s);
+    checkPassports (s);
+}
+
+/**
+ *  \brief A plane arrives at the starting airport and is boarded, if it is its turn.
+ *
+ *  \param s simulation
+ *  \param plane plane
+ */
+
+static void atOrigin (DES_SIM *s, unsigned int plane)
+{
+    if (s->fSt->finished) {
+        return;
+    }
+    s->fSt->st.pilotStat[plane] = READY_FOR_BOARDING;
+    if (s->boarding) {
+        s->planeReady[s->readyTail] = plane;
+        s->readyTail = (s->readyTail + 1) % MAXPT;
+        logState (s);
+        return;
+    }
+    startBoarding (s, plane);
+    checkPassports (s);
+}
+
+/**
+ *  \brief A plane arrives at the destination, the passengers leave it and it flies back unless the air lift is
+ *  finished.
+ *
+ *  \param s simulation
+ *  \param plane plane
+ */
+
+static void atTarget (DES_SIM *s, unsigned int plane)
+{
+    FULL_STAT *fSt = s->fSt;
+    unsigned int p;
+
+    fSt->st.pilotStat[plane] = DROPING_PASSENGERS;
+    fSt->flightLanded = fSt->planeFlight[plane];
+    if (s->log) {
+        saveFlightArrived (s->nFic, fSt);
+    }
+    logState (s);
+    for (p = 0; p < fSt->planePass[plane]; p++) {
+        passengerStat (fSt)[s->onBoard[plane * fSt->par.maxFC + p]] = AT_DESTINATION;
+        fSt->nPassInFlight--;
+        logState (s);
+    }
+    fSt->planePass[plane] = 0;
+    if (s->log) {
+        saveFlightReturning (s->nFic, fSt);
+    }
+    if (!fSt->finished) {
+        fSt->st.pilotStat[plane] = FLYING_BACK;
+        logState (s);
+        schedule (s, flightTime (s, plane), AT_ORIGIN, plane);
+    }
+}
+
+/**
+ *  \brief Creation of a simulation.
+ *
+ *  \param par problem parameters
+ *  \param seed base seed of the random generators
+ *  \param nFic name of logging file, or \c NULL not to log the events
+ *
+ *  \return the simulation
+ */
+
+DES_SIM *desCreate (const PARAM *par, unsigned int seed, char nFic[])
+{
+    DES_SIM *s;
+    unsigned int p;
+
+    if (((s = calloc (1, sizeof (DES_SIM))) == NULL) ||
+        ((s->fSt = calloc (1, fullStatSize (par))) == NULL) ||
+        ((s->pending = malloc ((2 * par->nPassengers + par->nPilots) * sizeof (DES_EVENT))) == NULL) ||  /* and holds */
+        ((s->queue = malloc (par->nPassengers * sizeof (unsigned int))) == NULL) ||
+        ((s->onBoard = malloc (par->nPilots * par->maxFC * sizeof (unsigned int))) == NULL)) {
+        perror ("error on allocating the simulation data");
+        exit (EXIT_FAILURE);
+    }
+    for (p = 0; p < par->nPilots; p++) {
+        rndInit (&s->pilotRnd[p], rndSeed (seed, RND_PILOT, p));
+    }
+    s->log = nFic != NULL;
+    if (s->log) {
+        strcpy (s->nFic, nFic);
+    }
+
+    /* initialize problem internal status and the logging data */
+
+    s->fSt->par = *par;
+    for (p = 0; p < par->nPilots; p++) {
+        s->fSt->st.pilotStat[p] = FLYING_BACK;                      /* the pilots are flying towards starting airport */
+    }
+    for (p = 0; p < par->nHostesses; p++) {
+        s->fSt->st.hostessStat[p] = WAIT_FOR_FLIGHT;            /* the hostesses are waiting for the flight to arrive */
+    }
+    for (p = 0; p < par->nPassengers; p++) {
+        passengerStat (s->fSt)[p] = GOING_TO_AIRPORT;                      /* the passengers are going to the airport */
+    }
+    s->fSt->virtualTime = true;
+    initLogShared (&s->lsh, &s->lsh, 0, par);
+    initLogClock (&s->lsh, &s->now);
+
+    /* first events: the passengers travel to the airport and the planes fly back to it */
+
+    for (p = 0; p < par->nPassengers; p++) {
+        schedule (s, travelTime (seed, p), ARRIVAL, p);
+    }
+    for (p = 0; p < par->nPilots; p++) {
+        schedule (s, flightTime (s, p), AT_ORIGIN, p);
+    }
+
+    return s;
+}
+
+/**
+ *  \brief Running a simulation.
+ *
+ *  \param sim simulation
+ */
+
+void desRun (DES_SIM *sim)
+{
+    DES_EVENT e;
+    unsigned int p;
+
+    for (p = 0; p < sim->fSt->par.nPilots; p++) {                                  /* the pilots took off on creation */
+        logState (sim);
+    }
+    while (sim->nPending > 0) {
+        e = next (sim);
+        sim->now = e.at;
+        switch (e.kind) {
+            case ARRIVAL:
+                arrival (sim, e.id);
+                break;
+            case AT_ORIGIN:
+                atOrigin (sim, e.id);
+                break;
+            case AT_TARGET:
+                atTarget (sim, e.id);
+                break;
+            case HOLD_OVER:
+                holdOver (sim, e.id);
+                break;
+        }
+    }
+}
+
+/**
+ *  \brief Destruction of a simulation.
+ *
+ *  \param sim simulation
+ */
+
+void desDestroy (DES_SIM *sim)
+{
+    free (sim->onBoard);
+    free (sim->queue);
+    free (sim->pending);
+    free (sim->fSt);
+    free (sim);
+}
@@ -0,0 +1,125 @@
+/**
+ *  \file desEngine.h (interface file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Discrete event simulation engine.
+ *
+ *  The pilots, hostesses and passengers go through the same states as in the concurrent implementation, but
+ *  they are driven by a priority queue of timed events (passenger arrival at the airport, plane arrival at the
+ *  starting airport and at the destination) and every other transition takes no time. There are neither
+ *  processes nor semaphores, and every simulation keeps its whole state, random generators included, in a
+ *  structure of its own, so that many of them may run at the same time in different threads and each one is
+ *  deterministic for a given seed. The travel and flight times are drawn from a generator per entity seeded as
+ *  in the concurrent implementation, so both of them carry the same workload for the same seed.
+ *
+ *  Operations defined on a simulation:
+ *     \li creation, for some problem parameters and seed
+ *     \li running it until every passenger is at the destination
+ *     \li destruction.
+ */
+
+#ifndef DESENGINE_H_
+#define DESENGINE_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "logging.h"
+#include "randomGen.h"
+#include "boardingPolicy.h"
+
+/**
+ *  \brief Definition of <em>timed event</em> data type.
+ */
+typedef struct
+{ /** \brief virtual time of the event (us) */
+    unsigned long long at;
+    /** \brief order of scheduling, events at the same time are served in it */
+    unsigned long long seq;
+    /** \brief kind of event */
+    unsigned int kind;
+    /** \brief passenger, plane or flight */
+    unsigned int id;
+
+} DES_EVENT;
+
+/**
+ *  \brief Definition of <em>simulation</em> data type.
+ */
+typedef struct
+{ /** \brief sequence numbers of log records */
+    LOG_SHARED lsh;
+    /** \brief virtual time (us), must follow <tt>lsh</tt> */
+    unsigned long long now;
+    /** \brief name of logging file, the events are logged only if it is set by <tt>desCreate</tt> */
+    char nFic[51];
+    /** \brief the events are logged */
+    bool log;
+    /** \brief full state of the problem */
+    FULL_STAT *fSt;
+    /** \brief random generators of the pilots */
+    RND_GEN pilotRnd[MAXPT];
+    /** \brief pending events (binary heap) */
+    DES_EVENT *pending;
+    /** \brief number of pending events */
+    unsigned int nPending;
+    /** \brief number of events scheduled so far */
+    unsigned long long nSeq;
+    /** \brief queue of passengers, in arrival order */
+    unsigned int *queue;
+    /** \brief position of the oldest and of the next passenger in the queue */
+    unsigned int queueHead, queueTail;
+    /** \brief passengers in each plane (<tt>par.maxFC</tt> entries per plane) */
+    unsigned int *onBoard;
+    /** \brief planes waiting for their turn to board, in arrival order */
+    unsigned int planeReady[MAXPT];
+    /** \brief position of the oldest and of the next plane in <tt>planeReady</tt> */
+    unsigned int readyHead, readyTail;
+    /** \brief a plane is being boarded */
+    bool boarding;
+    /** \brief next gate to check a passport */
+    unsigned int nextGate;
+    /** \brief boarding policy of the hostesses, greedy unless it is set after <tt>desCreate</tt> */
+    BOARD_POLICY policy;
+    /** \brief end of the last wait for one more passenger of the flight being boarded (us) */
+    unsigned long long holdAt;
+
+} DES_SIM;
+
+/**
+ *  \brief Creation of a simulation.
+ *
+ *  The full state of the problem is initialized and the first events are scheduled. If events are to be logged,
+ *  the logging file must be created by the caller (<tt>setLogBackend</tt> on <tt>lsh</tt> and
+ *  <tt>createLog</tt>) before the simulation runs, and the air lift result saved after it.
+ *  The program is terminated if there is not enough memory.
+ *
+ *  \param par problem parameters
+ *  \param seed base seed of the random generators
+ *  \param nFic name of logging file, or \c NULL not to log the events
+ *
+ *  \return the simulation
+ */
+extern DES_SIM *desCreate (const PARAM *par, unsigned int seed, char nFic[]);
+
+/**
+ *  \brief Running a simulation.
+ *
+ *  The events are processed in time order until there are none left, that is, every passenger is at the
+ *  destination. The results are in the full state of the problem and the time it took in <tt>now</tt>.
+ *
+ *  \param sim simulation
+ */
+extern void desRun (DES_SIM *sim);
+
+/**
+ *  \brief Destruction of a simulation.
+ *
+ *  \param sim simulation
+ */
+extern void desDestroy (DES_SIM *sim);
+
+#endif /* DESENGINE_H_ */
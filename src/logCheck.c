@@ -0,0 +1,216 @@
+/**
+ *  \file logCheck.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Checking the invariants of the problem on the stream of logged events.
+ *
+ *  Defined operations:
+ *     \li initialization of the checking of a run
+ *     \li checking of an event.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdbool.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "logging.h"
+#include "logCheck.h"
+
+/** \brief number of pilot and of hostess states */
+#define  PILOT_STATES       5
+#define  HOSTESS_STATES     4
+
+/** \brief transitions of the life cycle of a pilot (from, to) */
+static const bool pilotMove[PILOT_STATES][PILOT_STATES] = {
+    [FLYING_BACK] = { [READY_FOR_BOARDING] = true },
+    [READY_FOR_BOARDING] = { [WAITING_FOR_BOARDING] = true },
+    [WAITING_FOR_BOARDING] = { [FLYING] = true },
+    [FLYING] = { [DROPING_PASSENGERS] = true },
+    [DROPING_PASSENGERS] = { [FLYING_BACK] = true }
+};
+
+/** \brief transitions of the life cycle of a hostess (from, to), a gate may close before it waits for a passenger */
+static const bool hostessMove[HOSTESS_STATES][HOSTESS_STATES] = {
+    [WAIT_FOR_FLIGHT] = { [WAIT_FOR_PASSENGER] = true, [READY_TO_FLIGHT] = true },
+    [WAIT_FOR_PASSENGER] = { [WAIT_FOR_FLIGHT] = true, [CHECK_PASSPORT] = true, [READY_TO_FLIGHT] = true },
+    [CHECK_PASSPORT] = { [WAIT_FOR_FLIGHT] = true, [WAIT_FOR_PASSENGER] = true, [READY_TO_FLIGHT] = true },
+    [READY_TO_FLIGHT] = { [WAIT_FOR_FLIGHT] = true }
+};
+
+/** \brief problem parameters of the run */
+static PARAM par;
+
+/** \brief states of the entities in the previous state event */
+static unsigned int pilotStat[MAXPT], hostessStat[MAXHT], *passStat = NULL;
+
+/** \brief passengers boarded and virtual time in the previous state event */
+static unsigned int lastBoarded;
+static unsigned long long lastTime;
+
+/** \brief flights that started boarding and that departed, and passengers they took */
+static unsigned int started, departed, carried;
+
+/** \brief number of events checked */
+static unsigned long long nEvents;
+
+/**
+ *  \brief Writing of a violation.
+ *
+ *  \param fmt format of the message, as in printf
+ *
+ *  \return \c false
+ */
+
+static bool violation (const char *fmt, ...)
+{
+    va_list ap;
+
+    fprintf (stderr, "Invariant violated at event %llu: ", nEvents);
+    va_start (ap, fmt);
+    vfprintf (stderr, fmt, ap);
+    va_end (ap);
+    fprintf (stderr, "\n");
+    return false;
+}
+
+/**
+ *  \brief Checking of a state event.
+ *
+ *  The counters are updated in the queue and flight critical regions and the states in the log one, so a counter
+ *  may run ahead of the states; they are checked against each other as bounds.
+ *
+ *  \param p_fSt pointer to the full internal state of the problem
+ *
+ *  \return \c true, if every invariant holds
+ */
+
+static bool checkState (FULL_STAT *p_fSt)
+{
+    unsigned int cnt[AT_DESTINATION + 1] = { 0 };
+    unsigned int *stat = passengerStat (p_fSt), s, g, p;
+
+    for (g = 0; g < par.nPilots; g++) {
+        if (((s = p_fSt->st.pilotStat[g]) != pilotStat[g]) && ((s >= PILOT_STATES) || !pilotMove[pilotStat[g]][s])) {
+            return violation ("pilot %u went from state %u to %u", g, pilotStat[g], s);
+        }
+        pilotStat[g] = s;
+    }
+    for (g = 0; g < par.nHostesses; g++) {
+        if (((s = p_fSt->st.hostessStat[g]) != hostessStat[g]) &&
+            ((s >= HOSTESS_STATES) || !hostessMove[hostessStat[g]][s])) {
+            return violation ("hostess %u went from state %u to %u", g, hostessStat[g], s);
+        }
+        hostessStat[g] = s;
+    }
+    for (p = 0; p < par.nPassengers; p++) {
+        if (((s = stat[p]) < passStat[p]) || (s > passStat[p] + 1) || (s > AT_DESTINATION)) {
+            return violation ("passenger %u went from state %u to %u", p, passStat[p], s);
+        }
+        passStat[p] = s;
+        cnt[s]++;
+    }
+
+    if (p_fSt->nPassInQueue > cnt[IN_QUEUE]) {
+        return violation ("%u passengers in queue, %u in state %u", p_fSt->nPassInQueue, cnt[IN_QUEUE], IN_QUEUE);
+    }
+    if (p_fSt->nPassInQueue + p_fSt->nPassInFlight + cnt[AT_DESTINATION] > par.nPassengers - cnt[GOING_TO_AIRPORT]) {
+        return violation ("%u passengers in queue, %u in flight and %u at the destination, %u reached the airport",
+                          p_fSt->nPassInQueue, p_fSt->nPassInFlight, cnt[AT_DESTINATION],
+                          par.nPassengers - cnt[GOING_TO_AIRPORT]);
+    }
+    if ((cnt[IN_FLIGHT] + cnt[AT_DESTINATION] > p_fSt->totalPassBoarded) ||
+        (p_fSt->totalPassBoarded > par.nPassengers - cnt[GOING_TO_AIRPORT])) {
+        return violation ("%u passengers boarded, %u in states %u and %u, %u reached the airport",
+                          p_fSt->totalPassBoarded, cnt[IN_FLIGHT] + cnt[AT_DESTINATION], IN_FLIGHT, AT_DESTINATION,
+                          par.nPassengers - cnt[GOING_TO_AIRPORT]);
+    }
+    if (p_fSt->totalPassBoarded < lastBoarded) {
+        return violation ("passengers boarded went down from %u to %u", lastBoarded, p_fSt->totalPassBoarded);
+    }
+    lastBoarded = p_fSt->totalPassBoarded;
+    if (p_fSt->virtualTime) {
+        if (p_fSt->vtime < lastTime) {
+            return violation ("time went back from %llu to %llu", lastTime, p_fSt->vtime);
+        }
+        lastTime = p_fSt->vtime;
+    }
+    return true;
+}
+
+/**
+ *  \brief Initialization of the checking of a run.
+ *
+ *  \param p problem parameters
+ */
+
+void checkInit (const PARAM *p)
+{
+    par = *p;
+    free (passStat);
+    if ((passStat = calloc (par.nPassengers, sizeof (unsigned int))) == NULL) {
+        perror ("error on allocating the states checked");
+        exit (EXIT_FAILURE);
+    }
+    memset (pilotStat, 0, sizeof (pilotStat));                                                         /* FLYING_BACK */
+    memset (hostessStat, 0, sizeof (hostessStat));                                                 /* WAIT_FOR_FLIGHT */
+    lastBoarded = 0;
+    lastTime = 0;
+    started = departed = carried = 0;
+    nEvents = 0;
+}
+
+/**
+ *  \brief Checking of an event.
+ *
+ *  \param event event tag
+ *  \param p_fSt pointer to the full internal state of the problem logged with the event
+ *
+ *  \return \c true, if every invariant holds
+ */
+
+bool checkEvent (unsigned int event, FULL_STAT *p_fSt)
+{
+    unsigned int size;
+
+    nEvents++;
+    switch (event) {
+        case EV_STATE:
+            return checkState (p_fSt);
+        case EV_START_BOARDING:
+            if (started++ > departed) {
+                return violation ("flight %u started boarding before flight %u departed", started, departed + 1);
+            }
+            if (started > par.maxNF) {
+                return violation ("flight %u started boarding, the max number of flights is %u", started, par.maxNF);
+            }
+            break;
+        case EV_FLIGHT_DEPARTED:
+            departed++;
+            size = passengersPerFlight (p_fSt)[p_fSt->nFlight - 1];
+            carried += size;
+            if ((size == 0) || (size > par.maxFC) ||
+                ((size < par.minFC) && (p_fSt->totalPassBoarded < par.nPassengers))) {           /* only the last one */
+                return violation ("flight %u departed with %u passengers", p_fSt->nFlight, size);
+            }
+            break;
+        case EV_AIRLIFT_RESULT:
+            if ((started != p_fSt->nFlight) || (departed != p_fSt->nFlight)) {
+                return violation ("%u flights, %u started boarding, %u departed", p_fSt->nFlight, started, departed);
+            }
+            if (carried != par.nPassengers) {
+                return violation ("%u passengers carried out of %u", carried, par.nPassengers);
+            }
+            for (size = 0; size < par.nPassengers; size++) {
+                if (passStat[size] != AT_DESTINATION) {
+                    return violation ("passenger %u ended in state %u", size, passStat[size]);
+                }
+            }
+            break;
+    }
+    return true;
+}
@@ -0,0 +1,54 @@
+/**
+ *  \file logCheck.h (interface file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Checking the invariants of the problem on the stream of logged events.
+ *
+ *  Every event is checked as it is consumed, by the logger process draining the shared ring or by the decoder of
+ *  a binary log, against the state carried by the previous ones:
+ *     \li every passenger goes through its states in order, one at a time, and the pilots and hostesses only make
+ *         the transitions of their life cycles
+ *     \li the passengers in queue, in flight and at the destination are not more than the ones that reached the
+ *         airport and the ones that boarded never decrease
+ *     \li a flight starts boarding only after the previous one departed and there are at most <tt>maxNF</tt> of them
+ *     \li every flight departs with between <tt>minFC</tt> and <tt>maxFC</tt> passengers, but the last one, which
+ *         may have fewer
+ *     \li the virtual time, if logged, never goes backwards
+ *     \li every passenger is at the destination at the end.
+ *
+ *  The invariants are the ones of <tt>run/invariants.awk</tt>, checked while the simulation runs.
+ */
+
+#ifndef LOGCHECK_H_
+#define LOGCHECK_H_
+
+#include <stdbool.h>
+
+#include "probDataStruct.h"
+
+/**
+ *  \brief Initialization of the checking of a run.
+ *
+ *  Every entity is in its initial state and no flight has started.
+ *  The program is terminated if there is not enough memory.
+ *
+ *  \param par problem parameters
+ */
+
+extern void checkInit (const PARAM *par);
+
+/**
+ *  \brief Checking of an event.
+ *
+ *  The violation found, if any, is written to stderr.
+ *
+ *  \param event event tag (<tt>EV_STATE</tt> ... <tt>EV_AIRLIFT_RESULT</tt>)
+ *  \param p_fSt pointer to the full internal state of the problem logged with the event
+ *
+ *  \return \c true, if every invariant holds
+ */
+
+extern bool checkEvent (unsigned int event, FULL_STAT *p_fSt);
+
+#endif /* LOGCHECK_H_ */
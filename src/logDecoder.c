@@ -0,0 +1,165 @@
+/**
+ *  \file logDecoder.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Offline decoder of binary logging files.
+ *
+ *  The records written by the <tt>LOG_BINARY</tt> backend are sorted by their sequence number and written
+ *  in the same formatted text layout produced by the <tt>LOG_TEXT</tt> backend.
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-d</tt> to write the state lines in the delta layout, the argument is the period of the full ones
+ *    \li <tt>-c</tt> to check the invariants of the problem on the records, the decoding stops at the first
+ *        violation
+ *    \li name of the binary logging file
+ *    \li name of the text logging file (optional, stdout if missing).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "logging.h"
+#include "logCheck.h"
+
+/**
+ *  \brief Ordering of records by sequence number.
+ */
+
+static int bySeq (const void *a, const void *b)
+{
+    unsigned int sa = (*(LOG_RECORD * const *) a)->seq,
+                 sb = (*(LOG_RECORD * const *) b)->seq;
+
+    return (sa > sb) - (sa < sb);
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is reading every record of the binary logging file, restoring their global order and
+ *  writing them as formatted text.
+ */
+
+int main (int argc, char *argv[])
+{
+    char nFic[51];                                                                       /* name of text logging file */
+    FILE *fic;                                                                                 /* binary logging file */
+    struct stat st;                                                                     /* binary logging file status */
+    LOG_HEADER hdr;                                                                          /* binary logging header */
+    char *rec;                                                                                   /* records as stored */
+    LOG_RECORD **ord;                                                                             /* records in order */
+    char *out;                                                                             /* records copied in order */
+    size_t n, r;                                                                                 /* number of records */
+    unsigned int keyframe = 0;                                 /* period of the full state lines (0: no delta layout) */
+    bool check = false;                                                                  /* invariants of the records */
+    LOG_DELTA *delta = NULL;                                                                     /* delta layout data */
+    char *tinp;                                                                     /* numerical parameters test flag */
+    int opt;                                                                                   /* command line option */
+
+    /* validation of command line parameters */
+
+    while ((opt = getopt (argc, argv, "d:c")) != -1) {
+        switch (opt) {
+            case 'd':
+                keyframe = (unsigned int) strtoul (optarg, &tinp, 0);
+                if ((*tinp != '\0') || (keyframe == 0)) {
+                    fprintf (stderr, "Wrong value for the period of the full state lines (\"%s\")!\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'c':
+                check = true;
+                break;
+            default:
+                optind = argc;                                                                 /* usage message below */
+        }
+    }
+    if ((argc - optind != 1) && (argc - optind != 2)) {
+        fprintf (stderr, "Usage: %s [-d keyframe] [-c] binary-log [text-log]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc - optind == 2) {
+        strcpy (nFic, argv[optind + 1]);
+    }
+    else strcpy (nFic, "");
+
+    if ((fic = fopen (argv[optind], "r")) == NULL) {
+        perror ("error on opening binary log file");
+        return EXIT_FAILURE;
+    }
+    if (fread (&hdr, sizeof (LOG_HEADER), 1, fic) != 1) {
+        fprintf (stderr, "Binary log file is truncated!\n");
+        return EXIT_FAILURE;
+    }
+    if ((hdr.magic != LOG_MAGIC) || (hdr.recSize < sizeof (LOG_RECORD))) {
+        fprintf (stderr, "Binary log file was not written by this version!\n");
+        return EXIT_FAILURE;
+    }
+
+    /* loading and sorting the records */
+
+    if (fstat (fileno (fic), &st) == -1) {
+        perror ("error on reading binary log file status");
+        return EXIT_FAILURE;
+    }
+    n = (st.st_size - sizeof (LOG_HEADER)) / hdr.recSize;
+    if (n == 0) {
+        fprintf (stderr, "Binary log file has no records!\n");
+        return EXIT_FAILURE;
+    }
+    if (((rec = malloc (n * hdr.recSize)) == NULL) || ((out = malloc (n * hdr.recSize)) == NULL) ||
+        ((ord = malloc (n * sizeof (LOG_RECORD *))) == NULL)) {
+        perror ("error on allocating the records array");
+        return EXIT_FAILURE;
+    }
+    if (fread (rec, hdr.recSize, n, fic) != n) {
+        perror ("error on reading binary log file");
+        return EXIT_FAILURE;
+    }
+    fclose (fic);
+
+    for (r = 0; r < n; r++) {
+        ord[r] = (LOG_RECORD *) (rec + r * hdr.recSize);
+        if (logRecordSize (&ord[r]->fSt.par) != hdr.recSize) {
+            fprintf (stderr, "Binary log file is corrupted!\n");
+            return EXIT_FAILURE;
+        }
+    }
+    qsort (ord, n, sizeof (LOG_RECORD *), bySeq);
+    for (r = 0; r < n; r++) {
+        memcpy (out + r * hdr.recSize, ord[r], hdr.recSize);
+    }
+
+    /* writing the text layout */
+
+    if (keyframe != 0) {
+        if ((delta = malloc (logDeltaSize (&((LOG_RECORD *) out)->fSt.par))) == NULL) {
+            perror ("error on allocating the delta layout");
+            return EXIT_FAILURE;
+        }
+        initLogDelta (delta, keyframe);
+        setLogDelta (delta);
+    }
+    if (check) {
+        checkInit (&((LOG_RECORD *) out)->fSt.par);
+        setLogCheck (checkEvent);
+    }
+    createLog (nFic, &((LOG_RECORD *) out)->fSt);
+    if (!saveRecords (nFic, (LOG_RECORD *) out, n)) {
+        return EXIT_FAILURE;                                           /* the records up to the violation are decoded */
+    }
+
+    free (delta);
+    free (ord);
+    free (out);
+    free (rec);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,539 @@
+/**
+ *  \file logFilter.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Streaming filter and analyzer of text logging files.
+ *
+ *  The log is read in large chunks, from a file or stdin, and the layout of the state lines is learnt from the
+ *  first line of column names, so any number of pilots, hostesses and passengers is understood. Every state line
+ *  is written with a dot in the columns of the entities whose state did not change since the previous line (the
+ *  view of <tt>filter_log.awk</tt>), a delta state line with a dot in the columns it does not list, and any other
+ *  line is copied unchanged. In the same pass, the flight events are gathered into the boarding duration and the
+ *  occupancy of every flight, in state lines and, if the log has the virtual time, in us. The analysis of a run is
+ *  written when the title line of another one or the end of the log is reached.
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-a</tt> to write the analysis of every run after its filtered lines
+ *    \li <tt>-q</tt> to only write the analysis
+ *    \li name of the text logging file (optional, stdin if missing).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+/** \brief size of the chunks the log is read in and its filtered lines are written in */
+#define  CHUNK         (1 << 20)
+
+/**
+ *  \brief Definition of <em>flight statistics</em> data type.
+ */
+typedef struct
+{ /** \brief the flight started boarding and departed */
+    bool started, departed;
+    /** \brief passengers checked and passengers on board when it departed */
+    unsigned int checked, passengers;
+    /** \brief state lines of the run when the flight started boarding and departed */
+    unsigned long long startRow, departRow;
+    /** \brief virtual time when the flight started boarding, departed and arrived (us) */
+    unsigned long long startTime, departTime, arriveTime;
+
+} FLIGHT_STAT;
+
+/** \brief number of pilots, hostesses and entity columns of the state lines, 0 until the column names are read */
+static unsigned int nPT, nHT, nCol;
+
+/** \brief offset and width of the column of each entity */
+static size_t *colOff;
+static unsigned int *colWidth;
+
+/** \brief size of the state columns, separators included, and the state lines have the virtual time */
+static size_t rowStates;
+static bool timed;
+
+/** \brief state of each entity in the previous state line */
+static unsigned int *prevStat;
+
+/** \brief the state columns of a line with every entity unchanged */
+static char *dots;
+
+/** \brief size of the list of events waiting for their time */
+#define  PENDING       16
+
+/** \brief state lines of the run and virtual time of the last one (us) */
+static unsigned long long nRows, now;
+
+/** \brief times of the events since the last state line (offsets in <tt>flight</tt>), set from the next one */
+static size_t pending[PENDING];
+static unsigned int nPending;
+
+/** \brief statistics of the flights of the run */
+static FLIGHT_STAT *flight;
+static unsigned int nFlight, maxFlight;
+
+/** \brief filtered lines not yet written */
+static char *outBuf;
+static size_t nOutBuf;
+
+/**
+ *  \brief Writing of the filtered lines not yet written.
+ */
+
+static void flushOut (void)
+{
+    if ((nOutBuf != 0) && (fwrite (outBuf, 1, nOutBuf, stdout) != nOutBuf)) {
+        perror ("error on writing the filtered log");
+        exit (EXIT_FAILURE);
+    }
+    nOutBuf = 0;
+}
+
+/**
+ *  \brief Reservation of room for a filtered line.
+ *
+ *  \param len size of the line
+ *
+ *  \return where the line is to be written
+ */
+
+static char *outLine (size_t len)
+{
+    static size_t size = 0;
+
+    if (nOutBuf + len > size) {
+        flushOut ();
+        if (len > size) {
+            size = (len > CHUNK) ? len : CHUNK;
+            if ((outBuf = realloc (outBuf, size)) == NULL) {
+                perror ("error on allocating the output buffer");
+                exit (EXIT_FAILURE);
+            }
+        }
+    }
+    nOutBuf += len;
+    return outBuf + nOutBuf - len;
+}
+
+/**
+ *  \brief Layout of the state lines, from the column names.
+ *
+ *  The columns of the pilots and hostesses are 3 characters wide and the ones of the passengers one more than their
+ *  names; there is a separator after the hostesses and after the passengers, as written by <tt>printHeader</tt>.
+ *
+ *  \param line line of column names
+ */
+
+static void layoutColumns (char *line)
+{
+    char *copy, *name;
+    size_t off = 0;
+    unsigned int c;
+    bool pilot, hostess, number;
+
+    if ((copy = strdup (line)) == NULL) {
+        perror ("error on allocating the column names");
+        exit (EXIT_FAILURE);
+    }
+    for (name = strtok (copy, " "); name != NULL; name = strtok (NULL, " ")) {
+        number = isdigit ((unsigned char) name[1]);
+        pilot = !strcmp (name, "PT") || ((name[0] == 'T') && number);
+        hostess = !strcmp (name, "HT") || ((name[0] == 'H') && number);
+        nPT += pilot;
+        nHT += hostess;
+        nCol += pilot || hostess || ((name[0] == 'P') && number);
+        timed = timed || !strcmp (name, "Time(us)");
+    }
+    if (((colOff = malloc (nCol * sizeof (size_t))) == NULL) ||
+        ((colWidth = malloc (nCol * sizeof (unsigned int))) == NULL) ||
+        ((prevStat = malloc (nCol * sizeof (unsigned int))) == NULL)) {
+        perror ("error on allocating the columns");
+        exit (EXIT_FAILURE);
+    }
+    strcpy (copy, line);
+    c = 0;
+    for (name = strtok (copy, " "); (name != NULL) && (c < nCol); name = strtok (NULL, " ")) {
+        if ((name[0] != 'P') || (c < nPT)) {
+            colWidth[c] = 3;                                                                      /* pilot or hostess */
+        }
+        else colWidth[c] = strlen (name) + 1;
+        colOff[c] = off;
+        off += colWidth[c] + ((c == nPT + nHT - 1) || (c == nCol - 1));
+        prevStat[c++] = 0;                                                /* the initial states, as in filter_log.awk */
+    }
+    rowStates = off;
+    if ((dots = malloc (rowStates)) == NULL) {
+        perror ("error on allocating the columns");
+        exit (EXIT_FAILURE);
+    }
+    memset (dots, ' ', rowStates);
+    for (c = 0; c < nCol; c++) {
+        dots[colOff[c] + colWidth[c] - 1] = '.';
+    }
+    free (copy);
+}
+
+/**
+ *  \brief Column of an entity, from its name.
+ *
+ *  \param name name of the entity, as in the column names
+ *
+ *  \return column, <tt>nCol</tt> if there is none
+ */
+
+static unsigned int columnOf (char *name)
+{
+    unsigned int n = (unsigned int) strtoul (name + 1, NULL, 10);
+
+    if (!strcmp (name, "PT")) {
+        return 0;
+    }
+    if (!strcmp (name, "HT")) {
+        return nPT;
+    }
+    switch (name[0]) {
+        case 'T':
+            return (n < nPT) ? n : nCol;
+        case 'H':
+            return (n < nHT) ? nPT + n : nCol;
+        case 'P':
+            return (nPT + nHT + n < nCol) ? nPT + nHT + n : nCol;
+    }
+    return nCol;
+}
+
+/**
+ *  \brief Virtual time of a state line, its last field.
+ *
+ *  \param line state line
+ *  \param len size of the line
+ */
+
+static void lineTime (char *line, size_t len)
+{
+    if (!timed) {
+        return;
+    }
+    while ((len > 0) && !isspace ((unsigned char) line[len - 1])) {
+        len--;
+    }
+    now = strtoull (line + len, NULL, 10);
+    while (nPending > 0) {
+        *(unsigned long long *) ((char *) flight + pending[--nPending]) = now;
+    }
+}
+
+/**
+ *  \brief Timing of an event by the next state line, the one that follows the sleep that led to it.
+ *
+ *  \param t time of the event
+ */
+
+static void eventTime (unsigned long long *t)
+{
+    *t = now;
+    if (nPending < PENDING) {
+        pending[nPending++] = (char *) t - (char *) flight;                      /* the statistics may be reallocated */
+    }
+}
+
+/**
+ *  \brief Filtering of a full state line.
+ *
+ *  \param line state line
+ *  \param len size of the line
+ */
+
+static void filterRow (char *line, size_t len)
+{
+    char *out = outLine (len + 2), *col;
+    unsigned int c, s;
+
+    memcpy (out, line, len);
+    for (c = 0; c < nCol; c++) {
+        col = out + colOff[c];
+        s = (unsigned int) strtoul (col, NULL, 10);
+        if (s == prevStat[c]) {
+            memcpy (col, dots + colOff[c], colWidth[c]);
+        }
+        prevStat[c] = s;
+    }
+    out[len] = ' ';                                                                         /* as filter_log.awk does */
+    out[len + 1] = '\n';
+    lineTime (line, len);
+    nRows++;
+}
+
+/**
+ *  \brief Filtering of a delta state line.
+ *
+ *  The changes are listed as the name of the entity and its old and new states, then the counters follow a bar.
+ *
+ *  \param line state line
+ *  \param len size of the line
+ */
+
+static void filterDelta (char *line, size_t len)
+{
+    char *bar = strstr (line, " | "), *p, *next;
+    size_t nCnt;
+    char *out;
+    unsigned int c;
+
+    if (bar == NULL) {                                                                            /* not a state line */
+        memcpy (outLine (len + 1), line, len);
+        outBuf[nOutBuf - 1] = '\n';
+        return;
+    }
+    nCnt = line + len - (bar + 3);
+    out = outLine (rowStates + nCnt + 2);
+    memcpy (out, dots, rowStates);
+    for (p = line + 1; p < bar; p = next) {
+        while (*p == ' ') {
+            p++;
+        }
+        next = strchr (p, ' ');
+        *next = '\0';
+        c = columnOf (p);
+        p = strchr (next + 1, '>');
+        next = p + strcspn (p, " ");
+        if (c < nCol) {
+            prevStat[c] = (unsigned int) strtoul (p + 1, NULL, 10);
+            memcpy (out + colOff[c], dots + colOff[c], colWidth[c]);
+            memcpy (out + colOff[c] + colWidth[c] - (next - p - 1), p + 1, next - p - 1);
+        }
+    }
+    memcpy (out + rowStates, bar + 3, nCnt);
+    out[rowStates + nCnt] = ' ';
+    out[rowStates + nCnt + 1] = '\n';
+    lineTime (line, len);
+    nRows++;
+}
+
+/**
+ *  \brief Gathering of a flight event.
+ *
+ *  \param line line of the event
+ */
+
+static void flightEvent (char *line)
+{
+    unsigned int f, n;
+    int off = -1;
+    FLIGHT_STAT *fl;
+
+    if ((sscanf (line, "Flight %u : %n", &f, &off) != 1) || (off == -1) || (f == 0)) {
+        return;                                                                      /* a line of the air lift result */
+    }
+    if (f > maxFlight) {
+        maxFlight = (f > 2 * maxFlight) ? f : 2 * maxFlight;
+        if ((flight = realloc (flight, maxFlight * sizeof (FLIGHT_STAT))) == NULL) {
+            perror ("error on allocating the flight statistics");
+            exit (EXIT_FAILURE);
+        }
+    }
+    for (; nFlight < f; nFlight++) {
+        memset (&flight[nFlight], 0, sizeof (FLIGHT_STAT));
+    }
+    fl = &flight[f - 1];
+    line += off;
+    if (!strncmp (line, "Boarding Started", 16)) {
+        fl->started = true;
+        fl->startRow = nRows;
+        eventTime (&fl->startTime);
+    }
+    else if (!strncmp (line, "Passenger", 9)) {
+        fl->checked++;
+    }
+    else if (sscanf (line, "Departed with %u", &n) == 1) {
+        fl->departed = true;
+        fl->passengers = n;
+        fl->departRow = nRows;
+        eventTime (&fl->departTime);
+    }
+    else if (!strncmp (line, "Arrived", 7)) {
+        eventTime (&fl->arriveTime);
+    }
+}
+
+/**
+ *  \brief Writing of the analysis of a run, which is then reset.
+ *
+ *  \param analysis the analysis is written
+ */
+
+static void endRun (bool analysis)
+{
+    unsigned int f, nDep = 0, nPass = 0, minPass = ~0u, maxPass = 0;
+    unsigned long long rows = 0, us = 0;
+    FLIGHT_STAT *fl;
+
+    if (analysis && (nFlight != 0)) {
+        flushOut ();
+        printf ("\nFlight analysis\n");
+        printf ("%6s %8s %10s %14s %12s\n", "Flight", "Boarded", "Boarding", "Boarding(us)", "Flying(us)");
+        for (f = 0; f < nFlight; f++) {
+            fl = &flight[f];
+            if (!fl->started || !fl->departed) {
+                printf ("%6u %8s\n", f + 1, fl->started ? "boarding" : "-");
+                continue;
+            }
+            printf ("%6u %8u %10llu", f + 1, fl->passengers, fl->departRow - fl->startRow);
+            if (timed) {
+                printf (" %14llu %12llu\n", fl->departTime - fl->startTime,
+                        (fl->arriveTime >= fl->departTime) ? fl->arriveTime - fl->departTime : 0);
+            }
+            else printf (" %14s %12s\n", "-", "-");
+            nDep++;
+            nPass += fl->passengers;
+            rows += fl->departRow - fl->startRow;
+            us += fl->departTime - fl->startTime;
+            if (fl->passengers < minPass) {
+                minPass = fl->passengers;
+            }
+            if (fl->passengers > maxPass) {
+                maxPass = fl->passengers;
+            }
+        }
+        if (nDep != 0) {
+            printf ("%u flights with %u passengers, occupancy min %u max %u mean %.2f, boarding mean %.1f lines",
+                    nDep, nPass, minPass, maxPass, (double) nPass / nDep, (double) rows / nDep);
+            if (timed) {
+                printf (" %.1f us", (double) us / nDep);
+            }
+            printf ("\n");
+        }
+    }
+    nFlight = nPending = 0;
+    nRows = now = 0;
+}
+
+/**
+ *  \brief Processing of a line of the log.
+ *
+ *  \param line line, without its end of line
+ *  \param len size of the line
+ *  \param view the filtered line is written
+ *  \param analysis the analysis of every run is written
+ */
+
+static void processLine (char *line, size_t len, bool view, bool analysis)
+{
+    char *p = line;
+    size_t nView = nOutBuf;
+
+    while (*p == ' ') {
+        p++;
+    }
+    if (!strncmp (p, "Air Lift - Description", 22)) {                                      /* title line of a new run */
+        endRun (analysis);
+        nView = nOutBuf;
+    }
+    if ((nCol == 0) && (!strncmp (p, "PT ", 3) || !strncmp (p, "T0 ", 3))) {
+        layoutColumns (line);
+    }
+    if ((nCol != 0) && isdigit ((unsigned char) *p) && (len > rowStates)) {
+        filterRow (line, len);
+    }
+    else if ((nCol != 0) && (line[0] == '~')) {
+        filterDelta (line, len);
+    }
+    else {
+        if (!strncmp (line, "Flight ", 7)) {
+            flightEvent (line);
+        }
+        memcpy (outLine (len + 1), line, len);
+        outBuf[nOutBuf - 1] = '\n';
+    }
+    if (!view) {
+        nOutBuf = nView;                                                          /* the line is dropped, not written */
+    }
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is reading the log in chunks and processing it a line at a time.
+ */
+
+int main (int argc, char *argv[])
+{
+    int fd = STDIN_FILENO;                                                                       /* text logging file */
+    char *buf = NULL,                                                                             /* chunk of the log */
+         *nl;                                                                                          /* end of line */
+    size_t size = CHUNK,                                                                        /* size of the buffer */
+           n = 0,                                                                    /* number of bytes in the buffer */
+           start;                                                                /* start of the line being processed */
+    ssize_t r;                                                                                          /* bytes read */
+    bool view = true,                                                                   /* filtered lines are written */
+         analysis = false;                                                             /* analysis of runs is written */
+    int opt;                                                                                   /* command line option */
+
+    /* validation of command line parameters */
+
+    while ((opt = getopt (argc, argv, "aq")) != -1) {
+        switch (opt) {
+            case 'a':
+                analysis = true;
+                break;
+            case 'q':
+                analysis = true;
+                view = false;
+                break;
+            default:
+                optind = argc + 1;                                                             /* usage message below */
+        }
+    }
+    if (argc - optind > 1) {
+        fprintf (stderr, "Usage: %s [-a | -q] [text-log]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if ((argc - optind == 1) && ((fd = open (argv[optind], O_RDONLY)) == -1)) {
+        perror ("error on opening text log file");
+        return EXIT_FAILURE;
+    }
+    if ((buf = malloc (size + 1)) == NULL) {
+        perror ("error on allocating the input buffer");
+        return EXIT_FAILURE;
+    }
+
+    /* processing the log, the incomplete line at the end of a chunk is moved to the start of the buffer */
+
+    while ((r = read (fd, buf + n, size - n)) > 0) {
+        n += r;
+        for (start = 0; (nl = memchr (buf + start, '\n', n - start)) != NULL; start = nl - buf + 1) {
+            *nl = '\0';
+            processLine (buf + start, nl - buf - start, view, analysis);
+        }
+        memmove (buf, buf + start, n - start);
+        n -= start;
+        if (n == size) {                                                             /* a line longer than the buffer */
+            size *= 2;
+            if ((buf = realloc (buf, size + 1)) == NULL) {
+                perror ("error on allocating the input buffer");
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    if (r == -1) {
+        perror ("error on reading text log file");
+        return EXIT_FAILURE;
+    }
+    if (n != 0) {                                                                        /* last line without its end */
+        buf[n] = '\0';
+        processLine (buf, n, view, analysis);
+    }
+    endRun (analysis);
+    flushOut ();
+
+    free (buf);
+    if (fd != STDIN_FILENO) {
+        close (fd);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -13,6 +13,13 @@
  *     \li Writing the flight arrival at the end of the file.
  *     \li Writing the flight returning at the end of the file.
  *     \li writing summary of air lift at the end of the file.
+ *     \li selection of the logging backend (formatted text, binary records, shared ring or mapped file)
+ *     \li decoding of binary records into the formatted text layout
+ *     \li draining of the shared ring by the logger process
+ *     \li truncation of the mapped logging file to its contents
+ *     \li timing of the events by a virtual time clock
+ *     \li selection of the delta layout of the state lines
+ *     \li checking of the records decoded or drained.
  *
  *  \author Nuno Lau - January 2022
  */
@@ -23,11 +30,81 @@
 #include <stdbool.h>
 
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
 
 
 #include "probConst.h"
 #include "probDataStruct.h"
+#include "logging.h"
+
+/** \brief size of the buffer of records kept by a process before they are appended to the logging file */
+#define  LOGBUF        (1 << 20)
+
+/** \brief name of the logging file when none is given and the backend is binary or mapped */
+#define  LOGDEFAULT    "log"
+
+/** \brief logger polling period when the shared ring is empty (in us) */
+#define  LOGPOLL       1000
+
+/** \brief logging backend in use */
+static unsigned int logBackend = LOG_TEXT;
+
+/** \brief pointer to the logging data shared by all the processes */
+static LOG_SHARED *logSh;
+
+/** \brief records not yet appended to the logging file */
+static char *logBuf = NULL;
+
+/** \brief size of the buffer in bytes */
+static size_t logBufSize;
+
+/** \brief number of bytes in the buffer */
+static size_t nLogBuf = 0;
+
+/** \brief name of the logging file the buffered records belong to */
+static char logName[51];
+
+/** \brief delta layout of the state lines (\c NULL, if they are full) */
+static LOG_DELTA *logDelta = NULL;
+
+/** \brief check of the records decoded or drained (\c NULL, if there is none) */
+static bool (*logCheck) (unsigned int event, FULL_STAT *p_fSt) = NULL;
+
+/** \brief stream the events of the <tt>LOG_MMAP</tt> backend are formatted into, one at a time */
+static FILE *mapFmt = NULL;
+
+/** \brief formatted event and its size */
+static char *mapBuf;
+static size_t nMapBuf;
+
+/** \brief mapping of the logging file in this process (\c NULL, if there is none) */
+static char *mapAddr = NULL;
+
+/** \brief size of the mapping and number of the file mapped */
+static size_t mapLen;
+static unsigned int mapGen;
+
+/** \brief last state line formatted by this process, only the columns whose state changed are formatted again */
+static char *rowBuf = NULL;
+
+/** \brief state in each column of the line (pilots, hostesses and passengers) */
+static unsigned int *rowStat;
+
+/** \brief problem parameters the line is laid out for and size of the state columns, separators included */
+static PARAM rowPar;
+static size_t rowStates;
+
+static char *binLogName(char nFic[])
+{
+    if ((nFic == NULL) || (strlen (nFic) == 0)) {
+        return LOGDEFAULT;
+    }
+    return nFic;
+}
 
 static FILE *openLog(char nFic[], char mode[])
 {
@@ -59,24 +136,604 @@ static void closeLog(FILE *fic)
     }
 }
 
-static void printHeader(FILE *fic)
+static int passengerWidth(FULL_STAT *p_fSt)
 {
-    fprintf(fic,"%3s","PT");
-    fprintf(fic,"%3s","HT");
+    int w = 2;                                                            /* separator, 'P' and at least two digits */
+    unsigned int n;
+
+    for (n = p_fSt->par.nPassengers - 1; n >= 100; n /= 10) {
+        w++;
+    }
+    return w + 2;
+}
+
+static void printHeader(FILE *fic, FULL_STAT *p_fSt)
+{
+    int w = passengerWidth(p_fSt);
+    unsigned int g;
+
+    if (p_fSt->par.nPilots == 1) {
+        fprintf(fic,"%3s","PT");
+    }
+    else for (g = 0; g < p_fSt->par.nPilots; g++) {
+        fprintf(fic," T%d",g);
+    }
+    if (p_fSt->par.nHostesses == 1) {
+        fprintf(fic,"%3s","HT");
+    }
+    else for (g = 0; g < p_fSt->par.nHostesses; g++) {
+        fprintf(fic," H%d",g);
+    }
     fprintf(fic," ");
     int p;
-    for(p=0; p < N; p++) {
-        fprintf(fic," %s%02d","P",p);
+    for(p=0; p < p_fSt->par.nPassengers; p++) {
+        fprintf(fic," %s%0*d","P",w-2,p);
     }
 
     fprintf(fic," ");
     fprintf(fic,"%4s","InQ");
     fprintf(fic,"%4s","InF");
     fprintf(fic,"%4s","toB");
+    if (p_fSt->virtualTime) {
+        fprintf(fic,"%11s","Time(us)");
+    }
+
+    fprintf(fic,"\n");
+}
+
+static int formatNum(char *buf, unsigned long long v, int width)
+{
+    char digits[20];
+    int n = 0, len, i;
+
+    do {
+        digits[n++] = (char) ('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    len = (n > width) ? n : width;                                          /* a wider number overflows, as in printf */
+    memset(buf, ' ', len - n);
+    for (i = 0; i < n; i++) {
+        buf[len - 1 - i] = digits[i];
+    }
+    return len;
+}
+
+static void layoutRow(FULL_STAT *p_fSt)
+{
+    PARAM *par = &p_fSt->par;
+    unsigned int nCol = par->nPilots + par->nHostesses + par->nPassengers, c;
+
+    free(rowBuf);
+    free(rowStat);
+    rowStates = 3 * (par->nPilots + par->nHostesses) + 1 + (size_t) passengerWidth(p_fSt) * par->nPassengers + 1;
+    if (((rowBuf = malloc (rowStates + 3 * 10 + 20 + 1)) == NULL) ||                  /* the counters at their widest */
+        ((rowStat = malloc (nCol * sizeof (unsigned int))) == NULL)) {
+        perror ("error on allocating the state line");
+        exit (EXIT_FAILURE);
+    }
+    memset(rowBuf, ' ', rowStates);
+    for (c = 0; c < nCol; c++) {
+        rowStat[c] = ~0u;                                                 /* every column is formatted the first time */
+    }
+    rowPar = *par;
+}
+
+static void printCounters(FILE *fic, FULL_STAT *p_fSt)
+{
+    fprintf(fic,"%4d",p_fSt->nPassInQueue);
+    fprintf(fic,"%4d",p_fSt->nPassInFlight);
+    fprintf(fic,"%4d",p_fSt->totalPassBoarded);
+    if (p_fSt->virtualTime) {
+        fprintf(fic,"%11llu",p_fSt->vtime);
+    }
 
     fprintf(fic,"\n");
 }
 
+static char *formatCounters(char *c, FULL_STAT *p_fSt)
+{
+    c += formatNum(c, p_fSt->nPassInQueue, 4);
+    c += formatNum(c, p_fSt->nPassInFlight, 4);
+    c += formatNum(c, p_fSt->totalPassBoarded, 4);
+    if (p_fSt->virtualTime) {
+        c += formatNum(c, p_fSt->vtime, 11);
+    }
+    *c++ = '\n';
+    return c;
+}
+
+static size_t renderRow(FULL_STAT *p_fSt)
+{
+    int w = passengerWidth(p_fSt);
+    unsigned int *stat = passengerStat(p_fSt), *col, g, p;
+    char *c;
+
+    if ((rowBuf == NULL) || (rowPar.nPassengers != p_fSt->par.nPassengers) ||
+        (rowPar.nHostesses != p_fSt->par.nHostesses) || (rowPar.nPilots != p_fSt->par.nPilots)) {
+        layoutRow(p_fSt);
+    }
+    c = rowBuf;
+    col = rowStat;
+    for (g = 0; g < p_fSt->par.nPilots; g++, col++, c += 3) {
+        if (*col != p_fSt->st.pilotStat[g]) {
+            formatNum(c, *col = p_fSt->st.pilotStat[g], 3);
+        }
+    }
+    for (g = 0; g < p_fSt->par.nHostesses; g++, col++, c += 3) {
+        if (*col != p_fSt->st.hostessStat[g]) {
+            formatNum(c, *col = p_fSt->st.hostessStat[g], 3);
+        }
+    }
+    c++;
+    for (p = 0; p < p_fSt->par.nPassengers; p++, col++, c += w) {
+        if (*col != stat[p]) {
+            formatNum(c, *col = stat[p], w);
+        }
+    }
+
+    return formatCounters(rowBuf + rowStates, p_fSt) - rowBuf;
+}
+
+static void printState(FILE *fic, FULL_STAT *p_fSt)
+{
+    fwrite(rowBuf, 1, renderRow(p_fSt), fic);                                               /* the whole line at once */
+}
+
+static void printDelta(FILE *fic, FULL_STAT *p_fSt, FULL_STAT *prev)
+{
+    int w = passengerWidth(p_fSt);
+    unsigned int g, p, s;
+
+    fprintf(fic,"~");
+    for (g = 0; g < p_fSt->par.nPilots; g++) {
+        if ((s = p_fSt->st.pilotStat[g]) != prev->st.pilotStat[g]) {
+            if (p_fSt->par.nPilots == 1) {
+                fprintf(fic," PT %u>%u",prev->st.pilotStat[g],s);
+            }
+            else fprintf(fic," T%u %u>%u",g,prev->st.pilotStat[g],s);
+        }
+    }
+    for (g = 0; g < p_fSt->par.nHostesses; g++) {
+        if ((s = p_fSt->st.hostessStat[g]) != prev->st.hostessStat[g]) {
+            if (p_fSt->par.nHostesses == 1) {
+                fprintf(fic," HT %u>%u",prev->st.hostessStat[g],s);
+            }
+            else fprintf(fic," H%u %u>%u",g,prev->st.hostessStat[g],s);
+        }
+    }
+    for (p = 0; p < p_fSt->par.nPassengers; p++) {
+        if ((s = passengerStat(p_fSt)[p]) != passengerStat(prev)[p]) {
+            fprintf(fic," P%0*u %u>%u",w-2,p,passengerStat(prev)[p],s);
+        }
+    }
+
+    fprintf(fic," | ");
+    printCounters(fic, p_fSt);
+}
+
+static bool fullRow(void)
+{
+    return (logDelta == NULL) || (logDelta->nRows % logDelta->keyframe == 0);      /* a full line every keyframe lines */
+}
+
+static void keepRow(FULL_STAT *p_fSt)
+{
+    if (logDelta != NULL) {
+        memcpy(&logDelta->fSt, p_fSt, fullStatSize(&p_fSt->par));
+        logDelta->nRows++;
+    }
+}
+
+static void printRow(FILE *fic, FULL_STAT *p_fSt)
+{
+    if (fullRow()) {
+        printState(fic, p_fSt);
+    }
+    else printDelta(fic, p_fSt, &logDelta->fSt);
+    keepRow(p_fSt);
+}
+
+static void printEventHeader(FILE *fic, FULL_STAT *p_fSt)
+{
+    if (logDelta == NULL) {                                      /* the delta layout only has the one below the title */
+        printHeader(fic, p_fSt);
+    }
+}
+
+static void printAirLiftResult(FILE *fic, FULL_STAT *p_fSt)
+{
+    fprintf(fic,"AirLift result\n");
+
+    int f;
+    unsigned int p, nF, nP;
+    fprintf(fic,"AirLift used %d Flights\n", p_fSt->nFlight);
+    for(f=0; f<p_fSt->nFlight; f++) {
+        fprintf(fic,"Flight %d took %2d passengers", f+1, passengersPerFlight(p_fSt)[f]);
+        if (p_fSt->par.nPilots > 1) {
+            fprintf(fic," in plane %d", planePerFlight(p_fSt)[f]);
+        }
+        fprintf(fic,"\n");
+    }
+    if (p_fSt->par.nPilots > 1) {
+        for (p = 0; p < p_fSt->par.nPilots; p++) {
+            nF = nP = 0;
+            for (f = 0; f < p_fSt->nFlight; f++) {
+                if (planePerFlight(p_fSt)[f] == p) {
+                    nF++;
+                    nP += passengersPerFlight(p_fSt)[f];
+                }
+            }
+            fprintf(fic,"Plane %d made %d flights with %d passengers\n", p, nF, nP);
+        }
+    }
+    if (p_fSt->nFlight > 0) {                                   /* passengers carried out of the seats of the flights */
+        fprintf(fic,"AirLift mean load factor %.3f\n",
+                (double) p_fSt->par.nPassengers / ((double) p_fSt->nFlight * p_fSt->par.maxFC));
+    }
+    if (p_fSt->virtualTime) {
+        fprintf(fic,"AirLift took %llu us of virtual time\n", p_fSt->vtime);
+    }
+    else if (p_fSt->makespan != 0) {
+        fprintf(fic,"AirLift took %llu us\n", p_fSt->makespan);
+    }
+}
+
+static void printEvent(FILE *fic, unsigned int event, FULL_STAT *p_fSt)
+{
+    switch (event) {
+        case EV_STATE:
+            printRow(fic, p_fSt);
+            break;
+        case EV_START_BOARDING:
+            fprintf(fic,"Flight %d : Boarding Started\n", p_fSt->nFlight);
+            printEventHeader(fic, p_fSt);
+            break;
+        case EV_PASSENGER_CHECKED:
+            fprintf(fic,"Flight %d : Passenger %d checked\n", p_fSt->nFlight, p_fSt->passengerChecked);
+            break;
+        case EV_FLIGHT_DEPARTED:
+            fprintf(fic,"Flight %d : Departed with %d passengers\n", p_fSt->nFlight, passengersPerFlight(p_fSt)[p_fSt->nFlight-1]);
+            printEventHeader(fic, p_fSt);
+            break;
+        case EV_FLIGHT_ARRIVED:
+            fprintf(fic,"Flight %d : Arrived \n", p_fSt->flightLanded);
+            printEventHeader(fic, p_fSt);
+            break;
+        case EV_FLIGHT_RETURNING:
+            fprintf(fic,"Flight %d : Returning \n", p_fSt->flightLanded);
+            printEventHeader(fic, p_fSt);
+            break;
+        case EV_AIRLIFT_RESULT:
+            printAirLiftResult(fic, p_fSt);
+            break;
+    }
+}
+
+static LOG_RECORD *ringSlot(LOG_SHARED *lsh, unsigned int s)
+{
+    return (LOG_RECORD *) ((char *) lsh + lsh->slotOff + (size_t) (s % lsh->nSlots) * lsh->slotSize);
+}
+
+static LOG_RECORD *nextRecord(LOG_RECORD *rec)
+{
+    return (LOG_RECORD *) ((char *) rec + logRecordSize(&rec->fSt.par));
+}
+
+static void putRecord(char nFic[], unsigned int event, FULL_STAT *p_fSt)
+{
+    size_t size = logRecordSize(&p_fSt->par);
+    LOG_RECORD *rec;
+
+    if (logBuf == NULL) {
+        logBufSize = (size > LOGBUF) ? size : LOGBUF;
+        if ((logBuf = malloc (logBufSize)) == NULL) {
+            perror ("error on allocating the log buffer");
+            exit (EXIT_FAILURE);
+        }
+    }
+    if (nLogBuf + size > logBufSize) {
+        flushLog();
+    }
+    strcpy(logName, binLogName(nFic));
+    rec = (LOG_RECORD *) (logBuf + nLogBuf);
+    rec->seq = logSh->seq++;
+    rec->event = event;
+    memcpy(&rec->fSt, p_fSt, fullStatSize(&p_fSt->par));
+    nLogBuf += size;
+}
+
+static void pushRecord(unsigned int event, FULL_STAT *p_fSt)
+{
+    unsigned int s = logSh->seq;                                             /* only producer, inside critical region */
+    LOG_RECORD *rec = ringSlot(logSh, s);
+
+    while (s - __atomic_load_n (&logSh->tail, __ATOMIC_ACQUIRE) >= logSh->nSlots) {
+        sched_yield ();                                                               /* ring is full, let logger run */
+    }
+    rec->seq = s;
+    rec->event = event;
+    memcpy(&rec->fSt, p_fSt, fullStatSize(&p_fSt->par));
+    __atomic_store_n (&logSh->seq, s + 1, __ATOMIC_RELEASE);
+}
+
+static size_t mapCapacity(FULL_STAT *p_fSt)
+{
+    PARAM *par = &p_fSt->par;
+    size_t row = 3 * (par->nPilots + par->nHostesses) + passengerWidth(p_fSt) * par->nPassengers + 26,
+           nRows = 2 * (8 * par->nPassengers + 4 * (par->nHostesses + par->nPilots) * par->maxNF + 16),
+           nHeaders = 4 * par->maxNF + 2,
+           nLines = par->nPassengers + 8 * par->maxNF + par->nPilots + 8;      /* events and result, 64 bytes at most */
+
+    return (nRows + nHeaders) * row + nLines * 64 + 128;
+}
+
+static void mapLog(char nFic[])
+{
+    int fd;                                                                                        /* file descriptor */
+
+    if ((mapAddr != NULL) && (mapGen == logSh->mapGen)) {
+        return;
+    }
+    if ((mapAddr != NULL) && (munmap (mapAddr, mapLen) == -1)) {                                /* of an earlier file */
+        perror ("error on unmapping the log file");
+        exit (EXIT_FAILURE);
+    }
+    if ((fd = open (binLogName(nFic), O_RDWR)) == -1) {
+        perror ("error on opening log file");
+        exit (EXIT_FAILURE);
+    }
+    mapLen = logSh->mapSize;
+    mapGen = logSh->mapGen;
+    if ((mapAddr = mmap (NULL, mapLen, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+        perror ("error on mapping the log file");
+        exit (EXIT_FAILURE);
+    }
+    if (close (fd) == -1) {
+        perror ("error on closing of log file");
+        exit (EXIT_FAILURE);
+    }
+}
+
+static void growLog(char nFic[], size_t need)
+{
+    size_t size = logSh->mapSize;
+    int fd;                                                                                        /* file descriptor */
+
+    if (need <= size) {                                                          /* already grown by another writer */
+        return;
+    }
+    while (size < need) {
+        size *= 2;
+    }
+    if ((fd = open (binLogName(nFic), O_RDWR)) == -1) {
+        perror ("error on opening log file");
+        exit (EXIT_FAILURE);
+    }
+    if (ftruncate (fd, size) == -1) {
+        perror ("error on extending the log file");
+        exit (EXIT_FAILURE);
+    }
+    if (close (fd) == -1) {
+        perror ("error on closing of log file");
+        exit (EXIT_FAILURE);
+    }
+    logSh->mapSize = size;
+    logSh->mapGen++;                                                         /* every process maps the file again */
+}
+
+static char *mapReserve(char nFic[], size_t len)
+{
+    size_t off;
+
+    mapLog(nFic);
+    off = __atomic_fetch_add (&logSh->mapTail, len, __ATOMIC_RELAXED);                        /* reserving the region */
+    if (off + len > mapLen) {
+        growLog(nFic, off + len);
+        mapLog(nFic);
+    }
+    return mapAddr + off;
+}
+
+static void mapState(char nFic[], FULL_STAT *p_fSt)
+{
+    size_t len = renderRow(p_fSt);
+
+    memcpy(mapReserve(nFic, len), rowBuf, len);
+}
+
+static FILE *mapBegin(void)
+{
+    if ((mapFmt == NULL) && ((mapFmt = open_memstream (&mapBuf, &nMapBuf)) == NULL)) {
+        perror ("error on creating the log formatting stream");
+        exit (EXIT_FAILURE);
+    }
+    rewind(mapFmt);
+    return mapFmt;
+}
+
+static void mapEnd(char nFic[])
+{
+    fflush(mapFmt);
+    memcpy(mapReserve(nFic, nMapBuf), mapBuf, nMapBuf);
+}
+
+static void mapEvent(char nFic[], unsigned int event, FULL_STAT *p_fSt)
+{
+    if ((event == EV_STATE) && fullRow()) {
+        mapState(nFic, p_fSt);
+        keepRow(p_fSt);
+        return;
+    }
+    printEvent(mapBegin(), event, p_fSt);                         /* the lines of variable length, delta ones included */
+    mapEnd(nFic);
+}
+
+static void saveEvent(char nFic[], unsigned int event, FULL_STAT *p_fSt)
+{
+    FILE *fic;                                                                                      /* file descriptor */
+
+    if ((logSh != NULL) && (logSh->clockOff != 0)) {                       /* the clock only moves when nobody runs */
+        p_fSt->vtime = *(volatile unsigned long long *) ((char *) logSh + logSh->clockOff);
+    }
+    if (logBackend == LOG_BINARY) {
+        putRecord(nFic, event, p_fSt);
+        return;
+    }
+    if (logBackend == LOG_RING) {
+        pushRecord(event, p_fSt);
+        return;
+    }
+    if (logBackend == LOG_MMAP) {
+        mapEvent(nFic, event, p_fSt);
+        return;
+    }
+
+    fic = openLog(nFic,"a");
+    printEvent(fic, event, p_fSt);
+    closeLog(fic);
+}
+
+static void flushAtExit(void)
+{
+    flushLog();
+}
+
+/**
+ *  \brief Selection of the logging backend.
+ *
+ *  Must be called by every process before any other logging operation; a process that does not call it
+ *  uses the <tt>LOG_TEXT</tt> backend.
+ *  With the <tt>LOG_BINARY</tt> backend every operation stores a record in a buffer local to the process,
+ *  which is appended to the logging file when it fills up, upon <tt>flushLog</tt> and on process exit.
+ *  Records written by different processes are ordered by a sequence number that is taken from
+ *  <tt>lsh</tt>, so the caller must be inside the critical region when logging.
+ *  With the <tt>LOG_RING</tt> backend every operation pushes a record to the ring in <tt>lsh</tt>, waiting for a
+ *  free slot if necessary, and the logging file is only written by <tt>drainLog</tt>.
+ *  With the <tt>LOG_MMAP</tt> backend every operation reserves a region of the logging file in <tt>lsh</tt> and
+ *  writes the event into it, through a mapping of the file local to the process; a full state line, whose width is
+ *  known once its columns are formatted, is copied straight from the last one formatted by the process, the other
+ *  lines are formatted in a memory stream first. There are no
+ *  system calls but the ones extending the file when it runs out and mapping it again, so the caller must be inside
+ *  the log critical region; the file is truncated to its contents by <tt>truncateLog</tt>.
+ *
+ *  \param backend logging backend (<tt>LOG_TEXT</tt>, <tt>LOG_BINARY</tt>, <tt>LOG_RING</tt> or <tt>LOG_MMAP</tt>)
+ *  \param lsh pointer to the logging data shared by all the processes (unused by <tt>LOG_TEXT</tt>)
+ */
+
+void setLogBackend (unsigned int backend, LOG_SHARED *lsh)
+{
+    static bool registered = false;
+
+    logBackend = backend;
+    logSh = lsh;
+    if ((backend == LOG_BINARY) && !registered) {
+        atexit(flushAtExit);
+        registered = true;
+    }
+}
+
+/**
+ *  \brief Initialization of the delta layout.
+ *
+ *  \param delta pointer to the delta layout data
+ *  \param keyframe period of the full state lines
+ */
+
+void initLogDelta (LOG_DELTA *delta, unsigned int keyframe)
+{
+    delta->keyframe = keyframe;
+    delta->nRows = 0;
+}
+
+/**
+ *  \brief Selection of the delta layout of the formatted text.
+ *
+ *  Must be called by every process writing to the file, after <tt>setLogBackend</tt>; a process that does not
+ *  call it writes full state lines. The binary records are not affected, their layout is selected when they are
+ *  decoded.
+ *
+ *  \param delta pointer to the delta layout data, in a shared region if more than one process writes to the file
+ *         (\c NULL, for full state lines)
+ */
+
+void setLogDelta (LOG_DELTA *delta)
+{
+    logDelta = delta;
+}
+
+/**
+ *  \brief Selection of the check of the records decoded or drained.
+ *
+ *  \param check function checking an event and the state logged with it (\c NULL: none)
+ */
+
+void setLogCheck (bool (*check) (unsigned int event, FULL_STAT *p_fSt))
+{
+    logCheck = check;
+}
+
+/**
+ *  \brief Initialization of the logging data shared by all the processes.
+ *
+ *  \param lsh pointer to the logging data
+ *  \param slots pointer to the storage of the ring slots, in the same shared region
+ *  \param nSlots number of slots
+ *  \param par problem parameters
+ */
+
+void initLogShared (LOG_SHARED *lsh, void *slots, unsigned int nSlots, const PARAM *par)
+{
+    lsh->mapTail = 0;
+    lsh->seq = 0;
+    lsh->tail = 0;
+    lsh->closed = false;
+    lsh->nSlots = nSlots;
+    lsh->slotSize = logRecordSize (par);
+    lsh->slotOff = (char *) slots - (char *) lsh;
+    lsh->clockOff = 0;
+    lsh->mapSize = 0;
+}
+
+/**
+ *  \brief Timing of the events by a virtual time clock.
+ *
+ *  \param lsh pointer to the logging data
+ *  \param clock pointer to the virtual time (us), in the same shared region
+ */
+
+void initLogClock (LOG_SHARED *lsh, const unsigned long long *clock)
+{
+    lsh->clockOff = (char *) clock - (char *) lsh;
+}
+
+/**
+ *  \brief Flushing of the records buffered by the <tt>LOG_BINARY</tt> backend.
+ *
+ *  The records are appended to the logging file named in the operations that produced them.
+ */
+
+void flushLog (void)
+{
+    int fd;                                                                                         /* file descriptor */
+
+    if (nLogBuf == 0) {
+        return;
+    }
+    if ((fd = open (logName, O_WRONLY | O_APPEND)) == -1) {
+        perror ("error on opening log file");
+        exit (EXIT_FAILURE);
+    }
+    if (write (fd, logBuf, nLogBuf) != nLogBuf) {
+        perror ("error on writing to log file");
+        exit (EXIT_FAILURE);
+    }
+    if (close (fd) == -1) {
+        perror ("error on closing of log file");
+        exit (EXIT_FAILURE);
+    }
+    nLogBuf = 0;
+}
+
 /**
  *  \brief File initialization.
  *
@@ -87,21 +744,65 @@ static void printHeader(FILE *fic)
  *       \li a title line
  *       \li a blank line.
  *
+ *  With the <tt>LOG_BINARY</tt> backend the header is a <tt>LOG_HEADER</tt> and the records follow it.
+ *  With the <tt>LOG_MMAP</tt> backend the file is extended to a size large enough for the events of a usual run,
+ *  without taking disk space until the events are written, and doubled whenever it runs out.
+ *  With the delta layout the next state line is a full one.
+ *
  *  \param nFic name of the logging file
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
  */
 
-void createLog (char nFic[])
+void createLog (char nFic[], FULL_STAT *p_fSt)
 {
     FILE *fic;                                                                                      /* file descriptor */
 
-    fic = openLog(nFic,"w");
+    if (logBackend == LOG_BINARY) {
+        LOG_HEADER hdr = { LOG_MAGIC, logRecordSize (&p_fSt->par) };
+
+        fic = openLog(binLogName(nFic),"w");
+        if (fwrite (&hdr, sizeof (LOG_HEADER), 1, fic) != 1) {
+            perror ("error on writing to log file");
+            exit (EXIT_FAILURE);
+        }
+        closeLog(fic);
+        return;
+    }
+
+    if (logBackend == LOG_MMAP) {              /* sparse file, the pages are only allocated as the events are written */
+        int fd;                                                                                    /* file descriptor */
+
+        if ((fd = open (binLogName(nFic), O_RDWR | O_CREAT | O_TRUNC, 0666)) == -1) {
+            perror ("error on opening log file");
+            exit (EXIT_FAILURE);
+        }
+        logSh->mapSize = mapCapacity(p_fSt);
+        if (ftruncate (fd, logSh->mapSize) == -1) {
+            perror ("error on extending the log file");
+            exit (EXIT_FAILURE);
+        }
+        if (close (fd) == -1) {
+            perror ("error on closing of log file");
+            exit (EXIT_FAILURE);
+        }
+        logSh->mapTail = 0;
+        logSh->mapGen++;                                                     /* every process maps the new file again */
+        fic = mapBegin();
+    }
+    else fic = openLog(nFic,"w");
+    if (logDelta != NULL) {
+        logDelta->nRows = 0;
+    }
 
     /* title line + blank line */
 
     fprintf (fic, "%31cAir Lift - Description of the internal state\n\n", ' ');
-    printHeader(fic);
+    printHeader(fic, p_fSt);
 
-    closeLog(fic);
+    if (logBackend == LOG_MMAP) {
+        mapEnd(nFic);
+    }
+    else closeLog(fic);
 }
 
 /**
@@ -121,26 +822,7 @@ void createLog (char nFic[])
 
 void saveState (char nFic[], FULL_STAT *p_fSt)
 {
-    FILE *fic;                                                                                      /* file descriptor */
-
-    fic = openLog(nFic,"a");
-
-    fprintf(fic,"%3d",p_fSt->st.pilotStat);
-    fprintf(fic,"%3d",p_fSt->st.hostessStat);
-    fprintf(fic," ");
-    int p;
-    for(p=0; p < N; p++) {
-        fprintf(fic,"%4d",p_fSt->st.passengerStat[p]);
-    }
-
-    fprintf(fic," ");
-    fprintf(fic,"%4d",p_fSt->nPassInQueue);
-    fprintf(fic,"%4d",p_fSt->nPassInFlight);
-    fprintf(fic,"%4d",p_fSt->totalPassBoarded);
-
-    fprintf(fic,"\n");
-
-    closeLog(fic);
+    saveEvent(nFic, EV_STATE, p_fSt);
 }
 /**
  *  \brief Writing the start of Boarding Process and header.
@@ -153,15 +835,7 @@ void saveState (char nFic[], FULL_STAT *p_fSt)
 
 void saveStartBoarding (char nFic[], FULL_STAT *p_fSt)
 {
-    FILE *fic;                                                                                      /* file descriptor */
-
-    fic = openLog(nFic,"a");
-
-    fprintf(fic,"Flight %d : Boarding Started\n", p_fSt->nFlight);
-    printHeader(fic);
-
-
-    closeLog(fic);
+    saveEvent(nFic, EV_START_BOARDING, p_fSt);
 }
 
 /**
@@ -175,13 +849,7 @@ void saveStartBoarding (char nFic[], FULL_STAT *p_fSt)
 
 void savePassengerChecked (char nFic[], FULL_STAT *p_fSt)
 {
-    FILE *fic;                                                                                      /* file descriptor */
-
-    fic = openLog(nFic,"a");
-
-    fprintf(fic,"Flight %d : Passenger %d checked\n", p_fSt->nFlight, p_fSt->passengerChecked);
-
-    closeLog(fic);
+    saveEvent(nFic, EV_PASSENGER_CHECKED, p_fSt);
 }
 
 /**
@@ -195,20 +863,14 @@ void savePassengerChecked (char nFic[], FULL_STAT *p_fSt)
 
 void saveFlightDeparted (char nFic[], FULL_STAT *p_fSt)
 {
-    FILE *fic;                                                                                      /* file descriptor */
-
-    fic = openLog(nFic,"a");
-
-    fprintf(fic,"Flight %d : Departed with %d passengers\n", p_fSt->nFlight, p_fSt->nPassengersInFlight[p_fSt->nFlight-1]);
-    printHeader(fic);
-
-    closeLog(fic);
+    saveEvent(nFic, EV_FLIGHT_DEPARTED, p_fSt);
 }
 
 
 /**
  *  \brief Writing the flight arrival at the end of the file.
  *
+ *  The flight is the one in <tt>flightLanded</tt>.
  *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout 
  *
  *  \param nFic name of the logging file
@@ -217,19 +879,13 @@ void saveFlightDeparted (char nFic[], FULL_STAT *p_fSt)
 
 void saveFlightArrived (char nFic[], FULL_STAT *p_fSt)
 {
-    FILE *fic;                                                                                      /* file descriptor */
-
-    fic = openLog(nFic,"a");
-
-    fprintf(fic,"Flight %d : Arrived \n", p_fSt->nFlight);
-    printHeader(fic);
-
-    closeLog(fic);
+    saveEvent(nFic, EV_FLIGHT_ARRIVED, p_fSt);
 }
 
 /**
  *  \brief Writing the flight returning at end of file.
  *
+ *  The flight is the one in <tt>flightLanded</tt>.
  *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout 
  *
  *  \param nFic name of the logging file
@@ -238,37 +894,139 @@ void saveFlightArrived (char nFic[], FULL_STAT *p_fSt)
 
 void saveFlightReturning (char nFic[], FULL_STAT *p_fSt)
 {
-    FILE *fic;                                                                                      /* file descriptor */
-
-    fic = openLog(nFic,"a");
-
-    fprintf(fic,"Flight %d : Returning \n", p_fSt->nFlight);
-    printHeader(fic);
-
-    closeLog(fic);
+    saveEvent(nFic, EV_FLIGHT_RETURNING, p_fSt);
 }
 
 /**
  *  \brief Writing summary of air lift at the end of the file.
  *
  *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout 
+ *  With the <tt>LOG_BINARY</tt> backend the buffered records are flushed as well.
  *
  *  \param nFic name of the logging file
  *  \param p_fSt pointer to the location where the full internal state of the problem is stored
  */
 
 void saveAirLiftResult (char nFic[], FULL_STAT *p_fSt)
+{
+    saveEvent(nFic, EV_AIRLIFT_RESULT, p_fSt);
+    flushLog();
+}
+
+/**
+ *  \brief Writing a sequence of binary records in the formatted text layout at the end of the file.
+ *
+ *  Each record produces exactly the lines the corresponding operation of the <tt>LOG_TEXT</tt> backend would.
+ *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout
+ *
+ *  \param nFic name of the logging file
+ *  \param rec pointer to the first record
+ *  \param n number of records
+ *
+ *  \return \c false, if a record failed the check
+ */
+
+bool saveRecords (char nFic[], LOG_RECORD *rec, unsigned int n)
 {
     FILE *fic;                                                                                      /* file descriptor */
+    unsigned int r;
+    bool ok = true;
+
     fic = openLog(nFic,"a");
+    for (r = 0; (r < n) && ok; r++, rec = nextRecord(rec)) {
+        ok = (logCheck == NULL) || logCheck(rec->event, &rec->fSt);
+        printEvent(fic, rec->event, &rec->fSt);                                  /* the failing record is written too */
+    }
+    closeLog(fic);
+    return ok;
+}
 
-    fprintf(fic,"AirLift result\n");
+/**
+ *  \brief Draining of the shared ring into the logging file.
+ *
+ *  Life cycle of the logger process: the records pushed by the <tt>LOG_RING</tt> backend are written in the
+ *  formatted text layout, in batches, until the ring is closed and empty, or until a record fails the check.
+ *
+ *  \param nFic name of the logging file
+ *  \param lsh pointer to the logging data shared by all the processes
+ *
+ *  \return \c false, if a record failed the check
+ */
 
-    int f;
-    fprintf(fic,"AirLift used %d Flights\n", p_fSt->nFlight);
-    for(f=0; f<p_fSt->nFlight; f++) {
-        fprintf(fic,"Flight %d took %2d passengers\n", f+1, p_fSt->nPassengersInFlight[f]);
+bool drainLog (char nFic[], LOG_SHARED *lsh)
+{
+    unsigned int head, tail, n;
+    bool closed;
+
+    tail = lsh->tail;
+    while (true) {
+        closed = __atomic_load_n (&lsh->closed, __ATOMIC_ACQUIRE);
+        head = __atomic_load_n (&lsh->seq, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            if (closed) {
+                return true;
+            }
+            usleep (LOGPOLL);
+            continue;
+        }
+        while (head != tail) {                                     /* a batch is contiguous up to the end of the ring */
+            n = head - tail;
+            if (n > lsh->nSlots - tail % lsh->nSlots) {
+                n = lsh->nSlots - tail % lsh->nSlots;
+            }
+            if (!saveRecords (nFic, ringSlot (lsh, tail), n)) {
+                return false;
+            }
+            tail += n;
+            __atomic_store_n (&lsh->tail, tail, __ATOMIC_RELEASE);
+        }
     }
+}
 
-    closeLog(fic);
+/**
+ *  \brief Closing of the shared ring.
+ *
+ *  No more records may be pushed; <tt>drainLog</tt> returns once the remaining ones are written.
+ *
+ *  \param lsh pointer to the logging data shared by all the processes
+ */
+
+void closeRing (LOG_SHARED *lsh)
+{
+    __atomic_store_n (&lsh->closed, true, __ATOMIC_RELEASE);
+}
+
+/**
+ *  \brief Truncation of the mapped logging file to its contents.
+ *
+ *  Must be called after the last event is written with the <tt>LOG_MMAP</tt> backend, and does nothing with the
+ *  other ones; no more events may be written to the file.
+ *
+ *  \param nFic name of the logging file
+ */
+
+void truncateLog (char nFic[])
+{
+    int fd;                                                                                        /* file descriptor */
+
+    if (logBackend != LOG_MMAP) {
+        return;
+    }
+    if ((mapAddr != NULL) && (munmap (mapAddr, mapLen) == -1)) {
+        perror ("error on unmapping the log file");
+        exit (EXIT_FAILURE);
+    }
+    mapAddr = NULL;
+    if ((fd = open (binLogName(nFic), O_RDWR)) == -1) {
+        perror ("error on opening log file");
+        exit (EXIT_FAILURE);
+    }
+    if (ftruncate (fd, logSh->mapTail) == -1) {
+        perror ("error on truncating the log file");
+        exit (EXIT_FAILURE);
+    }
+    if (close (fd) == -1) {
+        perror ("error on closing of log file");
+        exit (EXIT_FAILURE);
+    }
 }
@@ -13,6 +13,13 @@
  *     \li Writing the flight arrival at the end of the file.
  *     \li Writing the flight returning at the end of the file.
  *     \li writing summary of air lift at the end of the file.
+ *     \li selection of the logging backend (formatted text, binary records, shared ring or mapped file)
+ *     \li decoding of binary records into the formatted text layout
+ *     \li draining of the shared ring by the logger process
+ *     \li truncation of the mapped logging file to its contents
+ *     \li timing of the events by a virtual time clock
+ *     \li selection of the delta layout of the state lines
+ *     \li checking of the records decoded or drained.
  *
  *  \author Nuno Lau - January 2022
  */
@@ -22,6 +29,237 @@
 
 #include "probDataStruct.h"
 
+/* Logging backends */
+
+/** \brief every event is formatted and appended to the logging file as it happens */
+#define  LOG_TEXT                     0
+/** \brief every event is stored as a binary record in a per-process buffer, flushed in batches */
+#define  LOG_BINARY                   1
+/** \brief every event is pushed to a ring in shared memory, formatted by a dedicated logger process */
+#define  LOG_RING                     2
+/** \brief every event is formatted and copied into a region reserved in the logging file, mapped by every process */
+#define  LOG_MMAP                     3
+
+/** \brief default number of slots of the shared ring */
+#define  LOGSLOTS                   256
+
+/* Log record event tags */
+
+/** \brief full state line */
+#define  EV_STATE                     0
+/** \brief start of boarding */
+#define  EV_START_BOARDING            1
+/** \brief passenger passport checked */
+#define  EV_PASSENGER_CHECKED         2
+/** \brief flight departed */
+#define  EV_FLIGHT_DEPARTED           3
+/** \brief flight arrived */
+#define  EV_FLIGHT_ARRIVED            4
+/** \brief flight returning */
+#define  EV_FLIGHT_RETURNING          5
+/** \brief summary of air lift */
+#define  EV_AIRLIFT_RESULT            6
+
+/** \brief binary logging file identification */
+#define  LOG_MAGIC           0x474f4c41
+
+/**
+ *  \brief Definition of <em>binary log record</em> data type.
+ *
+ *  A snapshot of the full state of the problem taken when the event was logged.
+ *  Its size depends on the problem parameters, see <tt>logRecordSize</tt>.
+ */
+typedef struct
+{ /** \brief global order of the event (records are sorted by it when decoded) */
+    unsigned int seq;
+    /** \brief event tag */
+    unsigned int event;
+    /** \brief full state of the problem at the time of the event (variable size: must be the last field) */
+    FULL_STAT fSt;
+
+} LOG_RECORD;
+
+/**
+ *  \brief Definition of <em>binary logging file header</em> data type.
+ */
+typedef struct
+{ /** \brief file identification (LOG_MAGIC) */
+    unsigned int magic;
+    /** \brief size of each record in bytes */
+    unsigned int recSize;
+
+} LOG_HEADER;
+
+/**
+ *  \brief Definition of <em>shared ring of log records</em> data type.
+ *
+ *  Records are pushed by the intervening entities inside the critical region, so there is a single producer at
+ *  any time, and popped without locking by the logger process.
+ *  <tt>seq</tt> also numbers the records of the <tt>LOG_BINARY</tt> backend.
+ *  The slots are stored at <tt>slotOff</tt> bytes from the start of this structure, so the location is
+ *  valid in every process that maps the shared region.
+ *  The two sequence numbers are in cache lines of their own in the cache line aware layout.
+ *  With the <tt>LOG_MMAP</tt> backend, a region of the mapped logging file is reserved for every event by moving
+ *  <tt>mapTail</tt> on atomically.
+ */
+typedef struct
+{ /** \brief end of the contents of the mapped logging file */
+    size_t mapTail;
+    /** \brief sequence number of the next record to be pushed */
+    unsigned int seq;
+    CACHE_PAD (seqPad, sizeof (size_t) + sizeof (unsigned int))
+    /** \brief sequence number of the next record to be popped */
+    unsigned int tail;
+    CACHE_PAD (tailPad, sizeof (unsigned int))
+    /** \brief no more records will be pushed */
+    bool closed;
+    /** \brief number of slots, the record with sequence number <tt>s</tt> is stored at slot <tt>s % nSlots</tt> */
+    unsigned int nSlots;
+    /** \brief size of each slot in bytes */
+    unsigned int slotSize;
+    /** \brief offset of the first slot */
+    size_t slotOff;
+    /** \brief offset of the virtual time clock (\c 0, if events are not timed) */
+    size_t clockOff;
+    /** \brief size of the mapped logging file, doubled whenever a reservation passes it */
+    size_t mapSize;
+    /** \brief number of times a mapped logging file was created or extended, kept by <tt>initLogShared</tt>, a
+     *  process maps the file again when it changes */
+    unsigned int mapGen;
+
+} LOG_SHARED;
+
+/**
+ *  \brief Definition of <em>delta layout</em> data type.
+ *
+ *  In the delta layout of the formatted text, a state line starts with <tt>~</tt> and only lists the entities whose
+ *  state changed since the previous line, each one as its column name and <tt>old>new</tt>, followed by <tt>|</tt>
+ *  and the counters; every <tt>keyframe</tt> lines, and first of all, the full state line is written instead.
+ *  The column names are written only once, below the title line.
+ *  The last state written is kept here, so the layout must be shared by every process writing to the file.
+ */
+typedef struct
+{ /** \brief period of the full state lines */
+    unsigned int keyframe;
+    /** \brief number of state lines written to the file so far */
+    unsigned int nRows;
+    /** \brief last state written (variable size: must be the last field) */
+    FULL_STAT fSt;
+
+} LOG_DELTA;
+
+/**
+ *  \brief Size of the delta layout data.
+ *
+ *  \param par problem parameters
+ *
+ *  \return size in bytes
+ */
+static inline size_t logDeltaSize (const PARAM *par)
+{
+    return offsetof (LOG_DELTA, fSt) + fullStatSize (par);
+}
+
+/**
+ *  \brief Size of a binary log record.
+ *
+ *  \param par problem parameters
+ *
+ *  \return size in bytes
+ */
+static inline size_t logRecordSize (const PARAM *par)
+{
+    return offsetof (LOG_RECORD, fSt) + fullStatSize (par);
+}
+
+/**
+ *  \brief Initialization of the logging data shared by all the processes.
+ *
+ *  \param lsh pointer to the logging data
+ *  \param slots pointer to the storage of the ring slots, in the same shared region
+ *  \param nSlots number of slots
+ *  \param par problem parameters
+ */
+
+extern void initLogShared (LOG_SHARED *lsh, void *slots, unsigned int nSlots, const PARAM *par);
+
+/**
+ *  \brief Timing of the events by a virtual time clock.
+ *
+ *  The time is stored in the full state of the problem whenever an event is logged, and it is written in the
+ *  formatted text layout if <tt>virtualTime</tt> is set in the full state.
+ *
+ *  \param lsh pointer to the logging data
+ *  \param clock pointer to the virtual time (us), in the same shared region
+ */
+
+extern void initLogClock (LOG_SHARED *lsh, const unsigned long long *clock);
+
+/**
+ *  \brief Initialization of the delta layout.
+ *
+ *  \param delta pointer to the delta layout data
+ *  \param keyframe period of the full state lines
+ */
+
+extern void initLogDelta (LOG_DELTA *delta, unsigned int keyframe);
+
+/**
+ *  \brief Selection of the delta layout of the formatted text.
+ *
+ *  Must be called by every process writing to the file, after <tt>setLogBackend</tt>; a process that does not
+ *  call it writes full state lines. The binary records are not affected, their layout is selected when they are
+ *  decoded.
+ *
+ *  \param delta pointer to the delta layout data, in a shared region if more than one process writes to the file
+ *         (\c NULL, for full state lines)
+ */
+
+extern void setLogDelta (LOG_DELTA *delta);
+
+/**
+ *  \brief Selection of the check of the records decoded or drained.
+ *
+ *  Every record written by <tt>saveRecords</tt> and <tt>drainLog</tt> is first given to the check, the
+ *  formatted text of the others is not affected.
+ *
+ *  \param check function checking an event and the state logged with it, \c false if it fails (\c NULL: none)
+ */
+
+extern void setLogCheck (bool (*check) (unsigned int event, FULL_STAT *p_fSt));
+
+/**
+ *  \brief Selection of the logging backend.
+ *
+ *  Must be called by every process before any other logging operation; a process that does not call it
+ *  uses the <tt>LOG_TEXT</tt> backend.
+ *  With the <tt>LOG_BINARY</tt> backend every operation stores a record in a buffer local to the process,
+ *  which is appended to the logging file when it fills up, upon <tt>flushLog</tt> and on process exit.
+ *  Records written by different processes are ordered by a sequence number that is taken from
+ *  <tt>lsh</tt>, so the caller must be inside the critical region when logging.
+ *  With the <tt>LOG_RING</tt> backend every operation pushes a record to the ring in <tt>lsh</tt>, waiting for a
+ *  free slot if necessary, and the logging file is only written by <tt>drainLog</tt>.
+ *  With the <tt>LOG_MMAP</tt> backend every operation reserves a region of the logging file in <tt>lsh</tt> and
+ *  writes the event into it, through a mapping of the file local to the process; a full state line, whose width is
+ *  known once its columns are formatted, is copied straight from the last one formatted by the process, the other
+ *  lines are formatted in a memory stream first. There are no
+ *  system calls but the ones extending the file when it runs out and mapping it again, so the caller must be inside
+ *  the log critical region; the file is truncated to its contents by <tt>truncateLog</tt>.
+ *
+ *  \param backend logging backend (<tt>LOG_TEXT</tt>, <tt>LOG_BINARY</tt>, <tt>LOG_RING</tt> or <tt>LOG_MMAP</tt>)
+ *  \param lsh pointer to the logging data shared by all the processes (unused by <tt>LOG_TEXT</tt>)
+ */
+
+extern void setLogBackend (unsigned int backend, LOG_SHARED *lsh);
+
+/**
+ *  \brief Flushing of the records buffered by the <tt>LOG_BINARY</tt> backend.
+ *
+ *  The records are appended to the logging file named in the operations that produced them.
+ */
+
+extern void flushLog (void);
+
 /**
  *  \brief File initialization.
  *
@@ -32,10 +270,16 @@
  *       \li a title line
  *       \li a blank line.
  *
+ *  With the <tt>LOG_BINARY</tt> backend the header is a <tt>LOG_HEADER</tt> and the records follow it.
+ *  With the <tt>LOG_MMAP</tt> backend the file is extended to a size large enough for the events of a usual run,
+ *  without taking disk space until the events are written, and doubled whenever it runs out.
+ *  With the delta layout the next state line is a full one.
+ *
  *  \param nFic name of the logging file
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
  */
 
-extern void createLog (char nFic[]);
+extern void createLog (char nFic[], FULL_STAT *p_fSt);
 
 /**
  *  \brief Writing the start of Boarding Process and header.
@@ -79,6 +323,7 @@ extern void saveState (char nFic[], FULL_STAT *p_fSt);
 /**
  *  \brief Writing the flight arrival at the end of the file.
  *
+ *  The flight is the one in <tt>flightLanded</tt>.
  *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout 
  *
  *  \param nFic name of the logging file
@@ -90,6 +335,7 @@ extern void saveFlightArrived (char nFic[], FULL_STAT *p_fSt);
 /**
  *  \brief Writing the flight returning at the end of the file.
  *
+ *  The flight is the one in <tt>flightLanded</tt>.
  *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout 
  *
  *  \param nFic name of the logging file
@@ -112,6 +358,8 @@ void savePassengerChecked (char nFic[], FULL_STAT *p_fSt);
 /**
  *  \brief Writing summary of air lift at the end of the file.
  *
+ *  The summary has the flights used and the passengers each one took, the mean load factor of the flights and the
+ *  time the air lift took, either virtual or, if it is set in <tt>makespan</tt>, real.
  *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout 
  *
  *  \param nFic name of the logging file
@@ -120,4 +368,56 @@ void savePassengerChecked (char nFic[], FULL_STAT *p_fSt);
 
 extern void saveAirLiftResult (char nFic[], FULL_STAT *p_fSt);
 
+/**
+ *  \brief Writing a sequence of binary records in the formatted text layout at the end of the file.
+ *
+ *  Each record produces exactly the lines the corresponding operation of the <tt>LOG_TEXT</tt> backend would.
+ *  The records are stored contiguously, each one taking <tt>logRecordSize</tt> bytes.
+ *  If <tt>nFic</tt> is a null pointer or a null string, the lines are written to stdout
+ *
+ *  \param nFic name of the logging file
+ *  \param rec pointer to the first record
+ *  \param n number of records
+ *
+ *  \return \c false, if a record failed the check selected by <tt>setLogCheck</tt> (it is the last one written)
+ */
+
+extern bool saveRecords (char nFic[], LOG_RECORD *rec, unsigned int n);
+
+/**
+ *  \brief Draining of the shared ring into the logging file.
+ *
+ *  Life cycle of the logger process: the records pushed by the <tt>LOG_RING</tt> backend are written in the
+ *  formatted text layout, in batches, until the ring is closed and empty, or until a record fails the check
+ *  selected by <tt>setLogCheck</tt>.
+ *
+ *  \param nFic name of the logging file
+ *  \param lsh pointer to the logging data shared by all the processes
+ *
+ *  \return \c false, if a record failed the check
+ */
+
+extern bool drainLog (char nFic[], LOG_SHARED *lsh);
+
+/**
+ *  \brief Closing of the shared ring.
+ *
+ *  No more records may be pushed; <tt>drainLog</tt> returns once the remaining ones are written.
+ *
+ *  \param lsh pointer to the logging data shared by all the processes
+ */
+
+extern void closeRing (LOG_SHARED *lsh);
+
+/**
+ *  \brief Truncation of the mapped logging file to its contents.
+ *
+ *  Must be called after the last event is written with the <tt>LOG_MMAP</tt> backend, and does nothing with the
+ *  other ones; no more events may be written to the file.
+ *
+ *  \param nFic name of the logging file
+ */
+
+extern void truncateLog (char nFic[]);
+
 #endif /* LOGGING_H_ */
@@ -0,0 +1,537 @@
+/**
+ *  \file microAirLift.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Microbenchmarks of the primitives on the hot path of the simulation.
+ *
+ *  Each benchmark is repeated a number of times and the cost of one operation (ns) is recorded on every
+ *  repetition:
+ *    \li <tt>lock</tt>: <em>down</em> and <em>up</em> of a mutex nobody else uses
+ *    \li <tt>contended</tt>: a critical region on a mutex, entered in turn by a number of entities at the same time
+ *    \li <tt>handshake</tt>: round trip of a handshake between two entities, one <em>up</em> and one <em>down</em>
+ *        on each side, as between a passenger and a hostess or between a pilot and a hostess
+ *    \li <tt>log_text</tt>, <tt>log_binary</tt>, <tt>log_mmap</tt>: writing of a state line (<tt>saveState</tt>)
+ *        with every logging backend but the shared ring, which is written by a process of its own, for a number of
+ *        passengers.
+ *
+ *  The entities are processes sharing a semaphore set, as in the simulation, or threads of the benchmark process
+ *  sharing a set private to it. The repetitions are written in CSV format and a summary per benchmark (mean,
+ *  standard deviation, min, median and max of the cost) is printed on stderr.
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-i</tt> number of operations of the semaphore benchmarks per repetition
+ *    \li <tt>-l</tt> number of state lines of the logging benchmarks per repetition
+ *    \li <tt>-R</tt> number of repetitions
+ *    \li <tt>-c</tt> number of entities of the contended benchmark
+ *    \li <tt>-n</tt> comma separated list of numbers of passengers of the logging benchmarks
+ *    \li <tt>-t</tt> the entities are threads
+ *    \li <tt>-V</tt> name of the build variant, so that the results of different builds can be merged
+ *    \li <tt>-o</tt> name of the output file (stdout if missing).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+#include <sys/wait.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "logging.h"
+#include "semaphore.h"
+
+/** \brief name of the logging file of the logging benchmarks */
+#define   LOGFILE       "micro.log"
+
+/** \brief project of the key of the semaphore set, the simulations take the ones from <tt>'a'</tt> on */
+#define   KEYPROJ       'M'
+
+/** \brief max number of entities of the contended benchmark */
+#define   MAXCONTEND    16
+
+/** \brief max number of numbers of passengers of the logging benchmarks */
+#define   MAXSIZES      16
+
+/* Semaphores of the set */
+
+/** \brief mutex of the lock benchmarks */
+#define   MUTEX         1
+/** \brief first half of the handshake */
+#define   PING          2
+/** \brief second half of the handshake */
+#define   PONG          3
+/** \brief start of the entities of the contended benchmark */
+#define   GO            4
+/** \brief end of the entities of the contended benchmark */
+#define   DONE          5
+/** \brief number of semaphores of the set */
+#define   NSEM          5
+
+/** \brief semaphore set access identifier */
+static int semgid = -1;
+
+/** \brief process that created the semaphore set */
+static pid_t owner;
+
+/** \brief the entities are threads */
+static bool threads = false;
+
+/** \brief number of operations of the semaphore benchmarks per repetition */
+static unsigned int nIter = 100000;
+
+/**
+ *  \brief Removal of the semaphore set on exit.
+ *
+ *  Only the process that created it removes it, not the entities it generated.
+ */
+
+static void teardown (void)
+{
+    if ((semgid != -1) && (getpid () == owner)) {
+        semDestroy (semgid);
+        semgid = -1;
+    }
+}
+
+/**
+ *  \brief Reading of the monotonic clock.
+ *
+ *  \return time (ns)
+ */
+
+static unsigned long long now (void)
+{
+    struct timespec t;
+
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return (unsigned long long) t.tv_sec * 1000000000ULL + (unsigned long long) t.tv_nsec;
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore of the set, the program is terminated if it fails.
+ *
+ *  \param sindex semaphore location in the set
+ */
+
+static void down (unsigned int sindex)
+{
+    if (semDown (semgid, sindex) == -1) {
+        perror ("error on the down operation for semaphore access (MB)");
+        exit (EXIT_FAILURE);
+    }
+}
+
+/**
+ *  \brief <em>Up</em> of a semaphore of the set, the program is terminated if it fails.
+ *
+ *  \param sindex semaphore location in the set
+ */
+
+static void up (unsigned int sindex)
+{
+    if (semUp (semgid, sindex) == -1) {
+        perror ("error on the up operation for semaphore access (MB)");
+        exit (EXIT_FAILURE);
+    }
+}
+
+/**
+ *  \brief Life cycle of an entity of the contended benchmark.
+ *
+ *  \param arg unused
+ *
+ *  \return \c NULL
+ */
+
+static void *contender (void *arg)
+{
+    unsigned int i;
+
+    down (GO);
+    for (i = 0; i < nIter; i++) {
+        down (MUTEX);
+        up (MUTEX);
+    }
+    up (DONE);
+    return NULL;
+}
+
+/**
+ *  \brief Life cycle of the entity answering the handshake.
+ *
+ *  \param arg unused
+ *
+ *  \return \c NULL
+ */
+
+static void *responder (void *arg)
+{
+    unsigned int i;
+
+    for (i = 0; i < nIter; i++) {
+        down (PING);
+        up (PONG);
+    }
+    return NULL;
+}
+
+/**
+ *  \brief Generation of the entities of a benchmark, as processes or threads.
+ *
+ *  \param body life cycle of the entities
+ *  \param n number of entities
+ *  \param pid storage for the process identifiers
+ *  \param thr storage for the thread identifiers
+ */
+
+static void spawn (void *(*body) (void *), unsigned int n, pid_t pid[], pthread_t thr[])
+{
+    unsigned int e;
+
+    fflush (NULL);                                                                /* nothing pending is written twice */
+    for (e = 0; e < n; e++) {
+        if (threads) {
+            if ((errno = pthread_create (&thr[e], NULL, body, NULL)) != 0) {
+                perror ("error on creating an entity thread");
+                exit (EXIT_FAILURE);
+            }
+        }
+        else if ((pid[e] = fork ()) < 0) {
+            perror ("error on the fork operation for an entity");
+            exit (EXIT_FAILURE);
+        }
+        else if (pid[e] == 0) {
+            body (NULL);
+            _exit (EXIT_SUCCESS);
+        }
+    }
+}
+
+/**
+ *  \brief Waiting for the entities of a benchmark to end.
+ *
+ *  \param n number of entities
+ *  \param pid process identifiers
+ *  \param thr thread identifiers
+ */
+
+static void reap (unsigned int n, pid_t pid[], pthread_t thr[])
+{
+    unsigned int e;
+    int status;
+
+    for (e = 0; e < n; e++) {
+        if (threads) {
+            pthread_join (thr[e], NULL);
+        }
+        else if ((waitpid (pid[e], &status, 0) == -1) || !WIFEXITED (status) || (WEXITSTATUS (status) != 0)) {
+            fprintf (stderr, "An entity of the benchmark failed!\n");
+            exit (EXIT_FAILURE);
+        }
+    }
+}
+
+/**
+ *  \brief Lock benchmark: <em>down</em> and <em>up</em> of a mutex nobody else uses.
+ *
+ *  \return cost of a critical region (ns)
+ */
+
+static double lock (void)
+{
+    unsigned long long t0 = now ();
+    unsigned int i;
+
+    for (i = 0; i < nIter; i++) {
+        down (MUTEX);
+        up (MUTEX);
+    }
+    return (double) (now () - t0) / nIter;
+}
+
+/**
+ *  \brief Contended benchmark: a critical region entered in turn by a number of entities.
+ *
+ *  The entities are generated before the clock is started and all start at the same time.
+ *
+ *  \param n number of entities
+ *
+ *  \return cost of a critical region (ns)
+ */
+
+static double contended (unsigned int n)
+{
+    pid_t pid[MAXCONTEND];
+    pthread_t thr[MAXCONTEND];
+    unsigned long long t0;
+    unsigned int e;
+
+    spawn (contender, n, pid, thr);
+    t0 = now ();
+    if (semUpN (semgid, GO, n) == -1) {
+        perror ("error on the up operation for semaphore access (MB)");
+        exit (EXIT_FAILURE);
+    }
+    for (e = 0; e < n; e++) {
+        down (DONE);
+    }
+    t0 = now () - t0;
+    reap (n, pid, thr);
+    return (double) t0 / ((double) n * nIter);
+}
+
+/**
+ *  \brief Handshake benchmark: round trip between two entities.
+ *
+ *  The benchmark process starts every handshake and a single entity answers it.
+ *
+ *  \return cost of a round trip (ns)
+ */
+
+static double handshake (void)
+{
+    pid_t pid[1];
+    pthread_t thr[1];
+    unsigned long long t0;
+    unsigned int i;
+
+    spawn (responder, 1, pid, thr);
+    t0 = now ();
+    for (i = 0; i < nIter; i++) {
+        up (PING);
+        down (PONG);
+    }
+    t0 = now () - t0;
+    reap (1, pid, thr);
+    return (double) t0 / nIter;
+}
+
+/**
+ *  \brief Logging benchmark: writing of state lines, one passenger changing state on every line.
+ *
+ *  The logging file is created anew, outside the time measured, before it fills up the room the
+ *  <tt>LOG_MMAP</tt> backend reserves for a run, and the records the <tt>LOG_BINARY</tt> backend keeps are flushed
+ *  in the time measured.
+ *
+ *  \param backend logging backend (<tt>LOG_TEXT</tt>, <tt>LOG_BINARY</tt> or <tt>LOG_MMAP</tt>)
+ *  \param fst full state of the problem
+ *  \param lsh logging data
+ *  \param nRows number of state lines
+ *
+ *  \return cost of a state line (ns)
+ */
+
+static double logRows (unsigned int backend, FULL_STAT *fst, LOG_SHARED *lsh, unsigned int nRows)
+{
+    unsigned int n = fst->par.nPassengers,
+                 fit = 16 * n,                                    /* state lines the mapped logging file has room for */
+                 done, k, r;
+    unsigned long long t0, total = 0;
+
+    setLogBackend (backend, lsh);
+    for (done = 0; done < nRows; done += k) {
+        createLog (LOGFILE, fst);
+        k = (nRows - done < fit) ? nRows - done : fit;
+        t0 = now ();
+        for (r = 0; r < k; r++) {
+            passengerStat (fst)[(done + r) % n] = (passengerStat (fst)[(done + r) % n] + 1) % 4;
+            fst->nPassInQueue = (done + r) % n;
+            saveState (LOGFILE, fst);
+        }
+        flushLog ();
+        total += now () - t0;
+        truncateLog (LOGFILE);
+    }
+    unlink (LOGFILE);
+    return (double) total / nRows;
+}
+
+/**
+ *  \brief Ordering of costs.
+ */
+
+static int byCost (const void *a, const void *b)
+{
+    double ca = *(const double *) a,
+           cb = *(const double *) b;
+
+    return (ca > cb) - (ca < cb);
+}
+
+/**
+ *  \brief Writing of the repetitions of a benchmark and of its summary on stderr.
+ *
+ *  \param out output file
+ *  \param variant build variant
+ *  \param bench name of the benchmark
+ *  \param param parameter of the benchmark (entities or passengers)
+ *  \param ops operations per repetition
+ *  \param cost cost of an operation on every repetition (ns), sorted on return
+ *  \param nReps number of repetitions
+ */
+
+static void report (FILE *out, char variant[], char bench[], unsigned int param, unsigned int ops, double cost[],
+                    unsigned int nReps)
+{
+    double mean = 0.0, var = 0.0, med;
+    unsigned int r;
+
+    for (r = 0; r < nReps; r++) {
+        fprintf (out, "%s,%s,%u,%u,%u,%.1f\n", variant, bench, param, r + 1, ops, cost[r]);
+        mean += cost[r];
+    }
+    fflush (out);
+    mean /= nReps;
+    for (r = 0; r < nReps; r++) {
+        var += (cost[r] - mean) * (cost[r] - mean);
+    }
+    var = (nReps > 1) ? var / (nReps - 1) : 0.0;
+    qsort (cost, nReps, sizeof (double), byCost);
+    med = (nReps % 2 == 1) ? cost[nReps/2] : (cost[nReps/2-1] + cost[nReps/2]) / 2;
+    fprintf (stderr, "%-8s %-10s %6u %10.1f %10.1f %10.1f %10.1f %10.1f\n", variant, bench, param, mean, sqrt (var),
+             cost[0], med, cost[nReps-1]);
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is running every benchmark the requested number of times and writing the costs measured.
+ */
+
+int main (int argc, char *argv[])
+{
+    unsigned int nReps = 5;                                                              /* repetitions per benchmark */
+    unsigned int nRows = 5000;                                                  /* state lines per logging repetition */
+    unsigned int nContend = 2;                                                 /* entities of the contended benchmark */
+    unsigned int sizes[MAXSIZES] = { N, 100, 1000 };                          /* passengers of the logging benchmarks */
+    unsigned int nSizes = 3;
+    unsigned int backends[] = { LOG_TEXT, LOG_BINARY, LOG_MMAP };
+    char *backName[] = { "log_text", "log_binary", "log_mmap" };
+    char *variant = "all";                                                                           /* build variant */
+    FILE *out = stdout;                                                                                /* output file */
+    double *cost;                                                          /* cost of an operation on each repetition */
+    PARAM par;                                                                /* dimensions of the logging benchmarks */
+    FULL_STAT *fst;                                                           /* full state of the logging benchmarks */
+    LOG_SHARED lsh;                                                                                   /* logging data */
+    char *tok, *tinp;
+    unsigned int b, s, r;
+    unsigned long val;
+    int key, opt;
+
+    while ((opt = getopt (argc, argv, "i:l:R:c:n:tV:o:")) != -1) {
+        switch (opt) {
+            case 'i':
+                nIter = (unsigned int) atoi (optarg);
+                break;
+            case 'l':
+                nRows = (unsigned int) atoi (optarg);
+                break;
+            case 'R':
+                nReps = (unsigned int) atoi (optarg);
+                break;
+            case 'c':
+                nContend = (unsigned int) atoi (optarg);
+                break;
+            case 'n':
+                for (nSizes = 0, tok = strtok (optarg, ","); tok != NULL; tok = strtok (NULL, ",")) {
+                    val = strtoul (tok, &tinp, 0);
+                    if ((*tinp != '\0') || (val == 0) || (val > 100000) || (nSizes == MAXSIZES)) {
+                        fprintf (stderr, "Wrong list of numbers of passengers (\"%s\")!\n", tok);
+                        exit (EXIT_FAILURE);
+                    }
+                    sizes[nSizes++] = (unsigned int) val;
+                }
+                break;
+            case 't':
+                threads = true;
+                break;
+            case 'V':
+                variant = optarg;
+                break;
+            case 'o':
+                if ((out = fopen (optarg, "w")) == NULL) {
+                    perror ("error on opening the output file");
+                    exit (EXIT_FAILURE);
+                }
+                break;
+            default:
+                fprintf (stderr, "Usage: %s [-i operations] [-l lines] [-R repetitions] [-c entities] "
+                         "[-n passengers,...] [-t] [-V variant] [-o output]\n", argv[0]);
+                exit (EXIT_FAILURE);
+        }
+    }
+    if ((nIter == 0) || (nRows == 0) || (nReps == 0) || (nSizes == 0)) {
+        fprintf (stderr, "The numbers of operations, lines, repetitions and passengers must be positive!\n");
+        exit (EXIT_FAILURE);
+    }
+    if ((nContend < 2) || (nContend > MAXCONTEND)) {
+        fprintf (stderr, "The number of entities of the contended benchmark must be between 2 and %d!\n", MAXCONTEND);
+        exit (EXIT_FAILURE);
+    }
+    if ((cost = malloc (nReps * sizeof (double))) == NULL) {
+        perror ("error on allocating the costs array");
+        exit (EXIT_FAILURE);
+    }
+
+    owner = getpid ();
+    if (threads) {
+        semgid = semCreateLocal (NSEM);
+    }
+    else if ((key = ftok (".", KEYPROJ)) != -1) {
+        semgid = semCreate (key, NSEM);
+    }
+    if (semgid == -1) {
+        perror ("error on creating the semaphore set");
+        exit (EXIT_FAILURE);
+    }
+    atexit (teardown);
+    up (MUTEX);
+
+    fprintf (out, "variant,bench,param,rep,ops,ns_per_op\n");
+    fprintf (stderr, "%-8s %-10s %6s %10s %10s %10s %10s %10s\n", "variant", "bench", "param", "mean_ns", "sd_ns",
+             "min_ns", "median_ns", "max_ns");
+    for (r = 0; r < nReps; r++) {
+        cost[r] = lock ();
+    }
+    report (out, variant, "lock", 1, nIter, cost, nReps);
+    for (r = 0; r < nReps; r++) {
+        cost[r] = contended (nContend);
+    }
+    report (out, variant, "contended", nContend, nIter, cost, nReps);
+    for (r = 0; r < nReps; r++) {
+        cost[r] = handshake ();
+    }
+    report (out, variant, "handshake", 2, nIter, cost, nReps);
+
+    for (s = 0; s < nSizes; s++) {
+        par = (PARAM) { sizes[s], MINFC, MAXFC, MAXNF, NHT, NPT };
+        if ((fst = calloc (1, fullStatSize (&par))) == NULL) {
+            perror ("error on allocating the full state");
+            exit (EXIT_FAILURE);
+        }
+        fst->par = par;
+        initLogShared (&lsh, &lsh + 1, 0, &par);
+        for (b = 0; b < sizeof (backends) / sizeof (backends[0]); b++) {
+            for (r = 0; r < nReps; r++) {
+                cost[r] = logRows (backends[b], fst, &lsh, nRows);
+            }
+            report (out, variant, backName[b], sizes[s], nRows, cost, nReps);
+        }
+        free (fst);
+    }
+
+    free (cost);
+    if (out != stdout) {
+        fclose (out);
+    }
+
+    return EXIT_SUCCESS;
+}
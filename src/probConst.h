@@ -11,7 +11,7 @@
 #ifndef PROBCONST_H_
 #define PROBCONST_H_
 
-/* Generic parameters */
+/* Generic parameters (defaults, they may be changed at launch) */
 
 /** \brief number of passengers */
 #define  N        21 
@@ -25,6 +25,18 @@
 /** \brief max number of flights */
 #define  MAXNF    10
 
+/** \brief number of hostesses (boarding gates) */
+#define  NHT       1
+
+/** \brief max number of hostesses (boarding gates), fixed at build time */
+#define  MAXHT    10
+
+/** \brief number of planes (one pilot each) */
+#define  NPT       1
+
+/** \brief max number of planes, fixed at build time */
+#define  MAXPT    10
+
 /** \brief max passenger travel duration */
 #define  MAXTRAVEL   30000.0 
 
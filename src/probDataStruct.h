@@ -14,38 +14,95 @@
 #define PROBDATASTRUCT_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "probConst.h"
 
+/** \brief size of a cache line (bytes) */
+#define CACHELINE  64
+
+/*
+ *  Cache line aware layout (-DCACHE_ALIGNED, make aligned).
+ *
+ *  The fields written by different entities, or by a domain and not by the others, are moved to cache lines of
+ *  their own, so that they are not invalidated by each other's updates. Padding members are used instead of
+ *  alignment attributes, so that the full state of the problem may still be copied into any buffer (log
+ *  records, ring slots, simulations), and it is really aligned where it is stored at an aligned location, as
+ *  in the shared region. With the default layout the padding members are empty and the fields are packed.
+ */
+
+#ifdef CACHE_ALIGNED
+/** \brief padding of the fields of <tt>size</tt> bytes before it to a whole number of cache lines */
+#define CACHE_PAD(name,size)  char name[(CACHELINE - (size) % CACHELINE) % CACHELINE];
+/** \brief rounding of an offset up to the start of a cache line */
+#define CACHE_ROUND(off)      (((off) + CACHELINE - 1) & ~(size_t) (CACHELINE - 1))
+#else
+#define CACHE_PAD(name,size)
+#define CACHE_ROUND(off)      (off)
+#endif
+
+
+/**
+ *  \brief Definition of <em>problem parameters</em> data type.
+ *
+ *  They set the dimensions of the full state of the problem.
+ */
+typedef struct
+{ /** \brief number of passengers */
+    unsigned int nPassengers;
+    /** \brief min flight capacity */
+    unsigned int minFC;
+    /** \brief max flight capacity */
+    unsigned int maxFC;
+    /** \brief max number of flights */
+    unsigned int maxNF;
+    /** \brief number of hostesses (boarding gates) */
+    unsigned int nHostesses;
+    /** \brief number of planes (one pilot each) */
+    unsigned int nPilots;
+
+} PARAM;
+
 
 /**
  *  \brief Definition of <em>state of the intervening entities</em> data type.
+ *
+ *  The passengers state array is stored at the end of the full state of the problem.
+ *  The states of the pilots and of the hostesses are in cache lines of their own in the cache line aware layout.
  */
 typedef struct
-{ /** \brief pilot state */
-    unsigned int pilotStat;
-    /** \brief hostess state */
-    unsigned int hostessStat;
-    /** \brief passengers state array */
-    unsigned int passengerStat[N];
+{ /** \brief pilot state at each plane (<tt>par.nPilots</tt> entries in use) */
+    unsigned int pilotStat[MAXPT];
+    CACHE_PAD (pilotPad, MAXPT * sizeof (unsigned int))
+    /** \brief hostess state at each boarding gate (<tt>par.nHostesses</tt> entries in use) */
+    unsigned int hostessStat[MAXHT];
+    CACHE_PAD (hostessPad, MAXHT * sizeof (unsigned int))
 
 } STAT;
 
 
 /**
  *  \brief Definition of <em>full state of the problem</em> data type.
+ *
+ *  Its size depends on the problem parameters, see <tt>fullStatSize</tt>, and a copy must always include
+ *  the arrays stored after the fixed fields.
+ *  In the cache line aware layout, the flight number, the counter of the queue domain and the other counters are
+ *  in cache lines of their own, and so are the arrays, which start at <tt>VAR_SKIP</tt> entries of <tt>var</tt>.
  */
 typedef struct
-{ /** \brief state of all intervening entities */
+{ /** \brief problem parameters */
+    PARAM par;
+    CACHE_PAD (parPad, sizeof (PARAM))
+    /** \brief state of all intervening entities */
     STAT st;
-    /** \brief number of passengers at each flight */
-    unsigned int nPassengersInFlight[MAXNF];
-    /** \brief flight number */
+    /** \brief flight number (of the plane being boarded, flights are numbered across the fleet) */
     unsigned int nFlight;
+    CACHE_PAD (flightPad, sizeof (unsigned int))
 
     /** \brief number of passengers waiting */
     unsigned int nPassInQueue;
-    /** \brief number of passengers flying */
+    CACHE_PAD (queuePad, sizeof (unsigned int))
+    /** \brief number of passengers flying, in every plane */
     unsigned int nPassInFlight;
     /** \brief total number of passengers already boarded in every flight */
     unsigned int totalPassBoarded;
@@ -53,8 +110,78 @@ typedef struct
     bool finished;
     /** \brief passenger id of last passenger to check passport */
     int passengerChecked;
+    /** \brief plane being boarded */
+    unsigned int boardingPlane;
+    /** \brief flight number of last plane to arrive at destination or to start returning */
+    unsigned int flightLanded;
+    /** \brief flight number of each plane */
+    unsigned int planeFlight[MAXPT];
+    /** \brief number of passengers flying in each plane */
+    unsigned int planePass[MAXPT];
+    /** \brief events are timed by a virtual time clock */
+    bool virtualTime;
+    /** \brief virtual time of the event (us) */
+    unsigned long long vtime;
+    /** \brief real time the air lift took (us), set with its result (\c 0, if it is not known, as in virtual time) */
+    unsigned long long makespan;
+    /** \brief passengers state array (<tt>par.nPassengers</tt> entries) followed by
+     *  number of passengers at each flight (<tt>par.maxNF</tt> entries) and
+     *  plane of each flight (<tt>par.maxNF</tt> entries) */
+    unsigned int var[];
 
 } FULL_STAT;
 
+/** \brief number of entries of <tt>var</tt> before the passengers state array (padding to a cache line) */
+#define VAR_SKIP  ((CACHE_ROUND (offsetof (FULL_STAT, var)) - offsetof (FULL_STAT, var)) / sizeof (unsigned int))
+
+
+/**
+ *  \brief Size of the full state of the problem.
+ *
+ *  \param par problem parameters
+ *
+ *  \return size in bytes
+ */
+static inline size_t fullStatSize (const PARAM *par)
+{
+    return sizeof (FULL_STAT) + (VAR_SKIP + par->nPassengers + 2 * par->maxNF) * sizeof (unsigned int);
+}
+
+/**
+ *  \brief Passengers state array.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ *
+ *  \return pointer to the state of passenger 0
+ */
+static inline unsigned int *passengerStat (FULL_STAT *p_fSt)
+{
+    return p_fSt->var + VAR_SKIP;
+}
+
+/**
+ *  \brief Number of passengers at each flight.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ *
+ *  \return pointer to the number of passengers of flight 1
+ */
+static inline unsigned int *passengersPerFlight (FULL_STAT *p_fSt)
+{
+    return p_fSt->var + VAR_SKIP + p_fSt->par.nPassengers;
+}
+
+/**
+ *  \brief Plane of each flight.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ *
+ *  \return pointer to the plane of flight 1
+ */
+static inline unsigned int *planePerFlight (FULL_STAT *p_fSt)
+{
+    return p_fSt->var + VAR_SKIP + p_fSt->par.nPassengers + p_fSt->par.maxNF;
+}
+
 
 #endif /* PROBDATASTRUCT_H_ */
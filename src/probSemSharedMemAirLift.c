@@ -6,23 +6,75 @@
  *  Synchronization based on semaphores and shared memory.
  *  Implementation with SVIPC.
  *
- *  Generator process of the intervening entities.
+ *  Generator process of the intervening entities, either as processes of their own or as threads.
+ *  It may also run the simulation many times over as a persistent server: the worker processes are forked once
+ *  and stay attached to the shared region and the semaphore set, which are reset in place between runs.
  *
- *  Upon execution, one parameter is requested:
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-n</tt> number of passengers, <tt>-m</tt> min flight capacity, <tt>-M</tt> max flight capacity and
+ *        <tt>-f</tt> max number of flights (the defaults are the values in probConst.h)
+ *    \li <tt>-H</tt> number of hostesses, each one boarding passengers at a gate of her own (up to <tt>MAXHT</tt>)
+ *    \li <tt>-P</tt> number of planes, each one flown by a pilot of its own (up to <tt>MAXPT</tt>)
+ *    \li <tt>-b</tt> to select the binary logging backend (decode the file afterwards with <tt>logDecoder</tt>)
+ *    \li <tt>-r</tt> to select the shared ring logging backend, drained by a logger process
+ *    \li <tt>-w</tt> to select the mapped file logging backend, the events are written into a mapping of the
+ *        logging file, which grows as needed and is truncated to its contents at the end of the simulation
+ *    \li <tt>-d</tt> to write the state lines in the delta layout, the argument is the period of the full ones
+ *        (expand the file afterwards with <tt>expand_log.awk</tt>; the layout of a binary log is selected when it is
+ *        decoded)
+ *    \li <tt>-t</tt> to run the intervening entities as threads of this process
+ *    \li <tt>-W</tt> number of worker threads the passengers run on as tasks, instead of a thread each (implies
+ *        <tt>-t</tt>, not in virtual time)
+ *    \li <tt>-c</tt> to check the invariants of the problem on the events as they are drained from the shared ring
+ *        (implies <tt>-r</tt>), the simulation is aborted on the first violation
+ *    \li <tt>-T</tt> time limit, in seconds, of every <em>down</em> of the intervening entities, an entity that is
+ *        blocked for longer terminates and so the simulation is aborted (no limit, if missing)
+ *    \li <tt>-p</tt> boarding policy of the hostesses, <tt>greedy</tt>, <tt>hold[:us]</tt> or <tt>predict[:us]</tt>
+ *        (see boardingPolicy.h; greedy, if missing, and the only one in virtual time)
+ *    \li <tt>-e</tt> name of the file the timeline of the flights is written to at the end of the simulation, as
+ *        CSV if it ends in <tt>.csv</tt> and as a columnar binary file otherwise (see timeline.h), suffixed by
+ *        <tt>.r</tt> as the logging file, if there is more than one run
+ *    \li <tt>-l</tt> to time every synchronization point and print the latencies at the end of the simulation
+ *    \li <tt>-v</tt> to run in virtual time, the argument is the real time taken by each unit of virtual time
+ *        (0 to run as fast as possible), the events are logged with their virtual time
+ *    \li <tt>-s</tt> or <tt>--seed</tt> base seed of the random generators, the same travel and flight times are
+ *        drawn on every run with the same seed (a different one on each run, if missing)
+ *    \li <tt>-R</tt> number of runs on a pool of worker processes (or threads, with <tt>-t</tt>), run <tt>r</tt>
+ *        is seeded with <tt>seed + r</tt> and, if there is more than one, logged into the file suffixed by
+ *        <tt>.r</tt>
+ *    \li <tt>-i</tt> instance of the simulation in the directory (the first free one, if missing)
+ *    \li <tt>-A</tt> list of the CPUs the simulation runs on (as in <tt>0-3,8</tt>; any, if missing)
  *    \li name of the logging file.
  *
+ *  The generator supervises the processes it forked: if one of them terminates abnormally, or the generator is
+ *  terminated by a signal, the remaining ones are killed and the semaphore set and the shared region are removed.
+ *  They are removed on any other termination of the generator too.
+ *
+ *  Up to <tt>MAXINST</tt> simulations may run side by side in the same directory: each instance has keys of its
+ *  own and, but for instance 0, its error files are suffixed by <tt>.instance</tt>.
+ *
  *  \author Nuno Lau - January 2022
  */
 
+#define _GNU_SOURCE                                                                              /* sched_setaffinity */
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <errno.h>
 #include <unistd.h>
+#include <sched.h>
+#include <getopt.h>
 #include <sys/wait.h>
 #include <sys/types.h>
 #include <sys/ipc.h>
+#include <sys/sem.h>
+#include <sys/shm.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/prctl.h>
 
 #include "probConst.h"
 #include "probDataStruct.h"
@@ -30,6 +82,11 @@
 #include "sharedDataSync.h"
 #include "semaphore.h"
 #include "sharedMemory.h"
+#include "semSharedMemEntities.h"
+#include "randomGen.h"
+#include "logCheck.h"
+#include "boardingPolicy.h"
+#include "timeline.h"
 
 /** \brief name of pilot process */
 #define   PILOT         "./pilot"
@@ -40,135 +97,377 @@
 /** \brief name of passenger process */
 #define   PASSENGER     "./passenger"
 
+/** \brief stack size of the intervening entities threads */
+#define   STACKSIZE     (128 * 1024)
+
+/** \brief first of the semaphores the pool workers wait on for the start of a run, after the ones of the problem,
+ *  worker <tt>w</tt> uses <tt>POOLGO + w</tt> */
+#define   POOLGO(nSem)                 ((nSem) + 1)
+
+/** \brief semaphore the generator waits on for the pool workers to end a run */
+#define   POOLDONE(nSem, nWorkers)     (POOLGO (nSem) + (nWorkers))
+
+/** \brief max number of instances of the simulation in the same directory, instance <tt>i</tt> has the key of
+ *  project <tt>'a' + i</tt> */
+#define   MAXINST       64
+
+/** \brief binding of each kind of entity (<tt>RND_PASSENGER</tt>, <tt>RND_HOSTESS</tt> or <tt>RND_PILOT</tt>) */
+static void (*entityBind[]) (char [], int, SHARED_DATA *, unsigned int) = { passengerBind, hostessBind, pilotBind };
+
+/** \brief life cycle of each kind of entity */
+static void *(*entityThread[]) (void *) = { passengerThread, hostessThread, pilotThread };
+
+/** \brief generator process and the semaphore set and shared region it removes on termination (-1: none) */
+static pid_t genPid;
+static int ipcSemgid = -1, ipcShmid = -1;
+
+/** \brief entity processes or pool workers (passengers, then hostesses, then pilots; 0: terminated) */
+static int *entityPid;
+static unsigned int nEntityPid;
+
+/** \brief logger process, while it is not expected to terminate (0: none) */
+static volatile pid_t loggerPid;
+
+/** \brief the pool workers are not expected to terminate */
+static volatile bool poolWatched;
+
+/** \brief instance of the simulation in the directory */
+static unsigned int instance;
+
 /**
- *  \brief Main program.
+ *  \brief Conversion of a numerical command line parameter.
+ *
+ *  The program is terminated if the value is not a positive integer.
  *
- *  Its role is starting the simulation by generating the intervening entities processes (pilot, hostess and passengers)
- *  and waiting for their termination.
+ *  \param arg command line parameter
+ *  \param name name of the parameter, for error reporting
+ *
+ *  \return value of the parameter
  */
 
-int main (int argc, char *argv[])
+static unsigned int getParam (char *arg, char *name)
 {
-    char nFic[51];                                                                              /*name of logging file */
-    char nFicErr[] = "error_        ";                                                     /* base name of error files */
-    int shmid,                                                                      /* shared memory access identifier */
-        semgid;                                                                     /* semaphore set access identifier */
-    unsigned int  m;                                                                             /* counting variables */
-    SHARED_DATA *sh;                                                                /* pointer to shared memory region */
-    int pidPT,                                                                             /* pilot process identifier */
-        pidHT,                                                                     /* hostess process identifier array */
-        pidPG[N];                                                             /* passengers processes identifier array */
-    int key;                                                           /*access key to shared memory and semaphore set */
-    char num[2][12];                                                     /* numeric value conversion (up to 10 digits) */
-    int status,                                                                                    /* execution status */
-        info;                                                                                               /* info id */
-    int p;
+    char *tinp;                                                                     /* numerical parameters test flag */
+    long val;
 
-    /* getting log file name */
-    if(argc==2) {
-        strcpy(nFic, argv[1]);
+    val = strtol (arg, &tinp, 0);
+    if ((*tinp != '\0') || (val <= 0) || (val > 1000000)) {
+        fprintf (stderr, "Wrong value for the %s (\"%s\")!\n", name, arg);
+        exit (EXIT_FAILURE);
     }
-    else strcpy(nFic, "");
+    return (unsigned int) val;
+}
 
-    /* composing command line */
+/**
+ *  \brief Binding of the simulation to a list of CPUs.
+ *
+ *  The affinity is inherited by every process and thread of the simulation.
+ *  The program is terminated if the list is wrong.
+ *
+ *  \param list comma separated CPUs or ranges of CPUs
+ */
+
+static void setAffinity (char *list)
+{
+    cpu_set_t set;                                                                                /* CPUs of the list */
+    char *tinp = list;                                                              /* numerical parameters test flag */
+    long first, last;
 
-    if ((key = ftok (".", 'a')) == -1) {
-        perror ("error on generating the key");
+    CPU_ZERO (&set);
+    do {
+        first = last = strtol (tinp, &tinp, 10);
+        if (*tinp == '-') {
+            last = strtol (tinp + 1, &tinp, 10);
+        }
+        if ((first < 0) || (last < first) || (last >= CPU_SETSIZE) || ((*tinp != ',') && (*tinp != '\0'))) {
+            fprintf (stderr, "Wrong value for the list of CPUs (\"%s\")!\n", list);
+            exit (EXIT_FAILURE);
+        }
+        for (; first <= last; first++) {
+            CPU_SET (first, &set);
+        }
+    } while (*tinp++ == ',');
+    if (sched_setaffinity (0, sizeof (set), &set) == -1) {
+        perror ("error on binding the simulation to the CPUs");
         exit (EXIT_FAILURE);
     }
-    sprintf (num[1], "%d", key);
+}
 
-    /* creating and initializing the shared memory region and the log file */
+/**
+ *  \brief Name of the error file of an entity.
+ *
+ *  \param name storage for the name (32 characters)
+ *  \param kind kind of entity (<tt>PG</tt>, <tt>HT</tt> or <tt>PT</tt>)
+ *  \param id entity identification, or -1 if it is the only one of its kind
+ */
 
-    if ((shmid = shmemCreate (key, sizeof (SHARED_DATA))) == -1) { 
-        perror ("error on creating the shared memory region");
-        exit (EXIT_FAILURE);
+static void errorFileName (char name[], char *kind, int id)
+{
+    int n = (id < 0) ? sprintf (name, "error_%s", kind) : sprintf (name, "error_%s%02d", kind, id);
+
+    if (instance != 0) {
+        sprintf (name + n, ".%u", instance);
     }
-    if (shmemAttach (shmid, (void **) &sh) == -1) { 
-        perror ("error on mapping the shared region on the process address space");
-        exit (EXIT_FAILURE);
+}
+
+/**
+ *  \brief Killing of the processes forked by the generator that are still running.
+ *
+ *  Only async-signal-safe operations are carried out.
+ */
+
+static void killEntities (void)
+{
+    pid_t pidLG = loggerPid;                                                             /* logger process identifier */
+    unsigned int e;
+
+    loggerPid = 0;                                                         /* they are not expected to run any longer */
+    poolWatched = false;
+    for (e = 0; e < nEntityPid; e++) {
+        if (entityPid[e] > 0) {
+            kill (entityPid[e], SIGKILL);
+        }
+    }
+    if (pidLG > 0) {
+        kill (pidLG, SIGKILL);
     }
+}
 
-    srandom ((unsigned int) getpid ());                                                      /* initialize random generator */
+/**
+ *  \brief Teardown of the simulation on exit.
+ *
+ *  The processes forked by the generator that are still running are killed and the semaphore set and the shared
+ *  region are removed. Nothing is done in the other processes, which inherit the handlers of the generator.
+ */
 
+static void teardown (void)
+{
+    if (getpid () != genPid) {
+        return;
+    }
+    killEntities ();
+    if (ipcSemgid != -1) {
+        semDestroy (ipcSemgid);
+        ipcSemgid = -1;
+    }
+    if (ipcShmid != -1) {
+        shmemDestroy (ipcShmid);
+        ipcShmid = -1;
+    }
+}
 
-    /* initialize problem internal status */
+/**
+ *  \brief Teardown of the simulation from a signal handler.
+ *
+ *  As <tt>teardown</tt>, but the semaphore set and the shared region are removed by their identifiers with plain
+ *  system calls (<tt>kill</tt>, <tt>semctl</tt> and <tt>shmctl</tt>), none of the state of the semaphore module is
+ *  touched: <tt>semDestroy</tt> calls <tt>sem_destroy</tt>, which is not async-signal-safe, with the POSIX
+ *  semaphores. These go away with the shared memory block they are stored in.
+ */
 
-    sh->fSt.st.pilotStat   = FLYING_BACK;                                   /* the pilot is flying towards starting airport */
-    sh->fSt.st.hostessStat = WAIT_FOR_FLIGHT;                            /* the hostess is waiting for the flight to arrive */
-    for (p = 0; p < N; p++) {
-        sh->fSt.st.passengerStat[p] = GOING_TO_AIRPORT;                          /* the passengers are going to the airport */
+static void teardownNow (void)
+{
+    if (getpid () != genPid) {
+        return;
     }
-    sh->fSt.finished         = false;                                       
-    sh->fSt.nPassInQueue     = 0;                                          
-    sh->fSt.nPassInFlight    = 0;                                         
-    sh->fSt.totalPassBoarded = 0;                                        
+    killEntities ();
+    if (ipcSemgid != -1) {
+#ifdef SEM_POSIX
+        shmctl (ipcSemgid, IPC_RMID, NULL);                               /* the block the semaphores are stored in */
+#else
+        semctl (ipcSemgid, 0, IPC_RMID);
+#endif
+        ipcSemgid = -1;
+    }
+    if (ipcShmid != -1) {
+        shmctl (ipcShmid, IPC_RMID, NULL);
+        ipcShmid = -1;
+    }
+}
 
-    /* initialize problem internal status */
+/**
+ *  \brief Abortion of the simulation.
+ *
+ *  \param msg reason, written to stderr by the generator
+ */
 
-    createLog (nFic);                                                                             /* log file creation */
+static void abortRun (const char *msg)
+{
+    if (getpid () == genPid) {
+        if (write (STDERR_FILENO, msg, strlen (msg)) == -1) {
+            /* nothing else to report it on */
+        }
+        teardownNow ();
+    }
+    _exit (EXIT_FAILURE);
+}
 
-    /* initialize semaphore ids */
+/**
+ *  \brief Handler of the termination signals.
+ *
+ *  \param sig signal number
+ */
 
-    sh->mutex = MUTEX;                                                              /* mutual exclusion semaphore id */
-    sh->passengersInQueue = PASSENGERSINQUEUE;                                       
-    sh->passengersWaitInQueue = PASSENGERSWAITINQUEUE;                              
-    sh->passengersWaitInFlight = PASSENGERSWAITINFLIGHT;                           
-    sh->readyForBoarding = READYFORBOARDING;                                      
-    sh->readyToFlight = READYTOFLIGHT;                                           
-    sh->idShown = IDSHOWN;                                                      
-    sh->planeEmpty = PLANEEMPTY;                                                      
+static void terminated (int sig)
+{
+    abortRun ("The simulation was terminated by a signal!\n");
+}
 
-    /* creating and initializing the semaphore set */
+/**
+ *  \brief Handler of the termination of a child process.
+ *
+ *  The simulation is aborted if the logger process or a pool worker terminated while it was expected to run.
+ *
+ *  \param sig signal number
+ */
 
-    if ((semgid = semCreate (key, SEM_NU)) == -1) { 
-        perror ("error on creating the semaphore set");
-        exit (EXIT_FAILURE);
+static void childTerminated (int sig)
+{
+    int err = errno;                                                                     /* the handler may interrupt */
+    int status;                                                                                   /* execution status */
+    unsigned int e;
+
+    if (getpid () != genPid) {
+        return;
     }
-    if (semUp (semgid, sh->mutex) == -1) {                                      /* enabling access to critical region */
-        perror ("error on executing the up operation for semaphore access");
-        exit (EXIT_FAILURE);
+    if ((loggerPid > 0) && (waitpid (loggerPid, &status, WNOHANG) == loggerPid)) {
+        loggerPid = 0;
+        abortRun ("The logger process terminated prematurely, the simulation was aborted!\n");
+    }
+    for (e = 0; poolWatched && (e < nEntityPid); e++) {
+        if ((entityPid[e] > 0) && (waitpid (entityPid[e], &status, WNOHANG) == entityPid[e])) {
+            entityPid[e] = 0;
+            abortRun ("A pool worker terminated prematurely, the simulation was aborted!\n");
+        }
+    }
+    errno = err;
+}
+
+/**
+ *  \brief Supervision of a child process by the generator.
+ *
+ *  Called by the child process after the fork, so that it is killed if the generator dies without a chance to
+ *  tear the simulation down.
+ */
+
+static void superviseChild (void)
+{
+    prctl (PR_SET_PDEATHSIG, SIGKILL);
+    if (getppid () != genPid) {                                                       /* the generator died meanwhile */
+        _exit (EXIT_FAILURE);
     }
+}
+
+/**
+ *  \brief Abortion of the simulation on the abnormal termination of an entity process.
+ *
+ *  \param par problem parameters
+ *  \param e entity (passengers, then hostesses, then pilots)
+ *  \param status execution status
+ */
+
+static void entityFailed (PARAM *par, unsigned int e, int status)
+{
+    static char *kind[] = { "passenger", "hostess", "pilot" };
+    unsigned int k = (e < par->nPassengers) ? 0 : (e < par->nPassengers + par->nHostesses) ? 1 : 2;
+    unsigned int id = e - ((k == 0) ? 0 : (k == 1) ? par->nPassengers : par->nPassengers + par->nHostesses);
+
+    if (WIFSIGNALED (status)) {
+        fprintf (stderr, "The %s %u process was killed by signal %d, ", kind[k], id, WTERMSIG (status));
+    }
+    else fprintf (stderr, "The %s %u process terminated with status %d, ", kind[k], id, WEXITSTATUS (status));
+    fflush (stderr);
+    abortRun ("the simulation was aborted!\n");
+}
+
+/**
+ *  \brief Generation of the intervening entities as processes.
+ *
+ *  Every entity is a process of its own, running the pilot, hostess or passenger program.
+ *  The function returns when all of them have terminated.
+ *
+ *  \param nFic name of logging file
+ *  \param nKey access key to shared memory and semaphore set, as a string
+ *  \param semgid semaphore set access identifier
+ *  \param par problem parameters
+ *  \param pidLG logger process identifier (\c 0 if there is none)
+ *  \param seed base seed of the random generators
+ */
 
-    /* generation of intervening entities processes */
+static void generateProcesses (char nFic[], char nKey[], int semgid, PARAM *par, int pidLG, unsigned int seed)
+{
+    char nFicErr[32];                                                                          /* name of error files */
+    unsigned int  m;                                                                            /* counting variables */
+    int *pidPT,                                                                     /* pilot process identifier array */
+        *pidHT,                                                                   /* hostess process identifier array */
+        *pidPG;                                                               /* passengers processes identifier array */
+    char num[12],                                                       /* numeric value conversion (up to 10 digits) */
+         sd[12];                                                                                /* seed of the entity */
+    int status,                                                                                   /* execution status */
+        info;                                                                                              /* info id */
+    unsigned int nEnt = par->nPassengers + par->nHostesses + par->nPilots;                      /* number of entities */
+    unsigned int e;
+    int p, g;
+
+    if ((pidPG = calloc (nEnt, sizeof (int))) == NULL) {
+        perror ("error on allocating the entities processes identifier array");
+        exit (EXIT_FAILURE);
+    }
+    pidHT = pidPG + par->nPassengers;                                         /* the generator supervises all of them */
+    pidPT = pidHT + par->nHostesses;
+    entityPid = pidPG;
+    nEntityPid = nEnt;
 
-    strcpy (nFicErr + 6, "PG");
-    for (p = 0; p < N; p++) {                                                                  /* passenger processes */
+    for (p = 0; p < par->nPassengers; p++) {                                                   /* passenger processes */
         if ((pidPG[p] = fork ()) < 0) {
             perror ("error on the fork operation for the passenger");
             exit (EXIT_FAILURE);
         }
-        sprintf(num[0],"%d",p);
-        sprintf(nFicErr+8,"%02d",p); 
-        if (pidPG[p] == 0)
-            if (execl (PASSENGER, PASSENGER, num[0], nFic, num[1],nFicErr, NULL) < 0) { 
+        sprintf(num,"%d",p);
+        sprintf(sd,"%u",rndSeed (seed, RND_PASSENGER, p));
+        errorFileName (nFicErr, "PG", p);
+        if (pidPG[p] == 0) {
+            superviseChild ();
+            if (execl (PASSENGER, PASSENGER, num, nFic, nKey, sd, nFicErr, NULL) < 0) { 
                 perror ("error on the generation of the passenger process");
                 exit (EXIT_FAILURE);
             }
+        }
     }
 
-    strcpy (nFicErr + 6, "HT");
-    if ((pidHT = fork ()) < 0)  {                                                               /* hostess process */
-        perror ("error on the fork operation for the hostess");
-        exit (EXIT_FAILURE);
-    }
-    if (pidHT == 0) {
-        if (execl (HOSTESS, HOSTESS, nFic, num[1], nFicErr, NULL) < 0) {
-            perror ("error on the generation of the hostess process");
+    for (g = 0; g < par->nHostesses; g++) {                                                      /* hostess processes */
+        if ((pidHT[g] = fork ()) < 0)  {
+            perror ("error on the fork operation for the hostess");
             exit (EXIT_FAILURE);
         }
+        sprintf(num,"%d",g);
+        sprintf(sd,"%u",rndSeed (seed, RND_HOSTESS, g));
+        errorFileName (nFicErr, "HT", (par->nHostesses > 1) ? g : -1);
+        if (pidHT[g] == 0) {
+            superviseChild ();
+            if (execl (HOSTESS, HOSTESS, num, nFic, nKey, sd, nFicErr, NULL) < 0) {
+                perror ("error on the generation of the hostess process");
+                exit (EXIT_FAILURE);
+            }
+        }
     }
 
-    strcpy (nFicErr + 6, "PT");
-    if ((pidPT = fork ()) < 0) {                                                                   /* pilot process */
-        perror ("error on the fork operation for the pilot");
-        exit (EXIT_FAILURE);
-    }
-    if (pidPT == 0)
-        if (execl (PILOT, PILOT, nFic, num[1], nFicErr, NULL) < 0) { 
-            perror ("error on the generation of the referee process");
+    for (g = 0; g < par->nPilots; g++) {                                                           /* pilot processes */
+        if ((pidPT[g] = fork ()) < 0) {
+            perror ("error on the fork operation for the pilot");
             exit (EXIT_FAILURE);
         }
+        sprintf(num,"%d",g);
+        sprintf(sd,"%u",rndSeed (seed, RND_PILOT, g));
+        errorFileName (nFicErr, "PT", (par->nPilots > 1) ? g : -1);
+        if (pidPT[g] == 0) {
+            superviseChild ();
+            if (execl (PILOT, PILOT, num, nFic, nKey, sd, nFicErr, NULL) < 0) { 
+                perror ("error on the generation of the referee process");
+                exit (EXIT_FAILURE);
+            }
+        }
+    }
 
     /* signaling start of operations */
 
@@ -177,19 +476,818 @@ int main (int argc, char *argv[])
         exit (EXIT_FAILURE);
     }
 
-    /* waiting for the termination of the intervening entities processes */
+    /* waiting for the termination of the intervening entities processes, the first one that fails aborts the
+       simulation */
 
     m = 0;
     do {
-        info = wait (&status);
-        if (info == -1)
-        { perror ("error on waiting for an intervening process");
+        if ((info = waitpid (-1, &status, 0)) == -1) {
+            perror ("error on waiting for an intervening process");
             exit (EXIT_FAILURE);
         }
+        if ((pidLG != 0) && (info == pidLG)) {
+            loggerPid = 0;
+            abortRun ("The logger process terminated prematurely, the simulation was aborted!\n");
+        }
+        for (e = 0; (e < nEnt) && (pidPG[e] != info); e++);
+        if (e == nEnt) {
+            continue;
+        }
+        pidPG[e] = 0;
+        if (!WIFEXITED (status) || (WEXITSTATUS (status) != EXIT_SUCCESS)) {
+            entityFailed (par, e, status);
+        }
         m += 1;
-    } while (m < N+2);
+    } while (m < nEnt);
+
+    nEntityPid = 0;
+    entityPid = NULL;
+    free (pidPG);
+}
+
+/**
+ *  \brief Generation of the intervening entities as threads.
+ *
+ *  Every entity is a thread of the generator process, the semaphore set must be private to it. The passengers may
+ *  instead be tasks run by a few worker threads.
+ *  The function returns when all of them have terminated.
+ *
+ *  \param nFic name of logging file
+ *  \param semgid semaphore set access identifier
+ *  \param sh pointer to shared memory region
+ *  \param seed base seed of the random generators
+ *  \param nTaskWorkers number of worker threads of the passenger tasks (0: a thread per passenger)
+ */
+
+static void generateThreads (char nFic[], int semgid, SHARED_DATA *sh, unsigned int seed, unsigned int nTaskWorkers)
+{
+    pthread_attr_t attr;                                                                        /* threads attributes */
+    pthread_t thrPT[MAXPT],                                                             /* pilot threads handle array */
+              thrHT[MAXHT],                                                           /* hostess threads handle array */
+              *thrPG;                                                             /* passengers threads handle array */
+    unsigned int p, g;
+
+    if ((thrPG = malloc (((nTaskWorkers == 0) ? sh->fSt.par.nPassengers : 1) * sizeof (pthread_t))) == NULL) {
+        perror ("error on allocating the passengers threads handle array");
+        exit (EXIT_FAILURE);
+    }
+    pthread_attr_init (&attr);
+    pthread_attr_setstacksize (&attr, STACKSIZE);
+
+    pilotBind (nFic, semgid, sh, seed);
+    hostessBind (nFic, semgid, sh, seed);
+    passengerBind (nFic, semgid, sh, seed);
+
+    if (nTaskWorkers != 0) {                                                                       /* passenger tasks */
+        passengerTasksStart (nTaskWorkers);
+    }
+    else for (p = 0; p < sh->fSt.par.nPassengers; p++) {                                         /* passenger threads */
+        if (pthread_create (&thrPG[p], &attr, passengerThread, (void *) (unsigned long) p) != 0) {
+            fprintf (stderr, "error on the generation of the passenger thread\n");
+            exit (EXIT_FAILURE);
+        }
+    }
+    for (g = 0; g < sh->fSt.par.nHostesses; g++) {                                                 /* hostess threads */
+        if (pthread_create (&thrHT[g], &attr, hostessThread, (void *) (unsigned long) g) != 0) {
+            fprintf (stderr, "error on the generation of the hostess thread\n");
+            exit (EXIT_FAILURE);
+        }
+    }
+    for (g = 0; g < sh->fSt.par.nPilots; g++) {                                                      /* pilot threads */
+        if (pthread_create (&thrPT[g], &attr, pilotThread, (void *) (unsigned long) g) != 0) {
+            fprintf (stderr, "error on the generation of the pilot thread\n");
+            exit (EXIT_FAILURE);
+        }
+    }
+
+    /* waiting for the termination of the intervening entities threads */
+
+    if (nTaskWorkers != 0) {
+        passengerTasksJoin ();
+    }
+    else for (p = 0; p < sh->fSt.par.nPassengers; p++) {
+        pthread_join (thrPG[p], NULL);
+    }
+    for (g = 0; g < sh->fSt.par.nHostesses; g++) {
+        pthread_join (thrHT[g], NULL);
+    }
+    for (g = 0; g < sh->fSt.par.nPilots; g++) {
+        pthread_join (thrPT[g], NULL);
+    }
+
+    pthread_attr_destroy (&attr);
+    free (thrPG);
+}
+
+/**
+ *  \brief Name of the logging file of a run.
+ *
+ *  With more than one run each one is logged into a file of its own, the runs logged to stdout follow each other.
+ *
+ *  \param nFic name of logging file
+ *  \param runs number of runs
+ *  \param r run
+ *  \param name storage for the name (51 characters)
+ */
+
+static void runLogName (char nFic[], unsigned int runs, unsigned int r, char name[])
+{
+    if ((runs > 1) && (nFic[0] != '\0')) {
+        snprintf (name, 51, "%s.%u", nFic, r);
+    }
+    else strcpy (name, nFic);
+}
 
-    saveAirLiftResult(nFic,&sh->fSt);
+/**
+ *  \brief Generation of the intervening entities as a pool of worker processes.
+ *
+ *  Every entity is a process forked off the generator, so it is still attached to its shared region and semaphore
+ *  set, that goes through the life cycle of the entity once per run: it waits for the start of the run on a
+ *  semaphore of its own, binds itself to the logging file and seed of the run and signals the end of it.
+ *  The function returns at once, the workers terminate when the pool is stopped.
+ *
+ *  \param nFic name of logging file
+ *  \param runs number of runs
+ *  \param semgid semaphore set access identifier
+ *  \param nSem number of semaphores of the problem, the ones of the pool follow them
+ *  \param sh pointer to shared memory region
+ *  \param seed base seed of the random generators
+ *  \param pid storage for the worker processes identifiers (passengers, then hostesses, then pilots)
+ */
+
+static void generatePool (char nFic[], unsigned int runs, int semgid, unsigned int nSem, SHARED_DATA *sh,
+                          unsigned int seed, int pid[])
+{
+    static char *kindName[] = { "PG", "HT", "PT" };
+    char nFicErr[32];                                                                          /* name of error files */
+    char name[51];                                                                     /* name of logging file of run */
+    unsigned int n[] = { sh->fSt.par.nPassengers, sh->fSt.par.nHostesses, sh->fSt.par.nPilots };
+    unsigned int nWorkers = n[RND_PASSENGER] + n[RND_HOSTESS] + n[RND_PILOT];
+    unsigned int k, id, w;
+
+    sh->poolStop = false;
+    entityPid = pid;                                                          /* the generator supervises all of them */
+    nEntityPid = nWorkers;
+    for (k = RND_PASSENGER, w = 0; k <= RND_PILOT; k++) {
+        for (id = 0; id < n[k]; id++, w++) {
+            if ((pid[w] = fork ()) < 0) {
+                perror ("error on the fork operation for a pool worker");
+                exit (EXIT_FAILURE);
+            }
+            if (pid[w] != 0) {
+                continue;
+            }
+            superviseChild ();
+            errorFileName (nFicErr, kindName[k], (int) id);
+            freopen (nFicErr, "w", stderr);
+            while (true) {
+                if (semDown (semgid, POOLGO (nSem) + w) == -1) {
+                    perror ("error on the down operation for the start of a run");
+                    exit (EXIT_FAILURE);
+                }
+                if (sh->poolStop) {
+                    exit (EXIT_SUCCESS);
+                }
+                runLogName (nFic, runs, sh->poolRun, name);
+                entityBind[k] (name, semgid, sh, seed + sh->poolRun);
+                entityThread[k] ((void *) (unsigned long) id);
+                semInstrument (NULL, 0);                                         /* the pool operations are not timed */
+                flushLog ();                                            /* the records must be in the file of the run */
+                if (semUp (semgid, POOLDONE (nSem, nWorkers)) == -1) {
+                    perror ("error on the up operation for the end of a run");
+                    exit (EXIT_FAILURE);
+                }
+            }
+        }
+    }
+    poolWatched = true;                                                           /* they only terminate when stopped */
+}
+
+/**
+ *  \brief Running the pool of worker processes once.
+ *
+ *  The function returns when every worker has ended the run.
+ *
+ *  \param semgid semaphore set access identifier
+ *  \param nSem number of semaphores of the problem, the ones of the pool follow them
+ *  \param sh pointer to shared memory region
+ *  \param nWorkers number of worker processes
+ *  \param r run
+ */
+
+static void runPool (int semgid, unsigned int nSem, SHARED_DATA *sh, unsigned int nWorkers, unsigned int r)
+{
+    unsigned int w;
+
+    sh->poolRun = r;
+    for (w = 0; w < nWorkers; w++) {
+        if (semUp (semgid, POOLGO (nSem) + w) == -1) {
+            perror ("error on the up operation for the start of a run");
+            exit (EXIT_FAILURE);
+        }
+    }
+    for (w = 0; w < nWorkers; w++) {
+        if (semDown (semgid, POOLDONE (nSem, nWorkers)) == -1) {
+            perror ("error on the down operation for the end of a run");
+            exit (EXIT_FAILURE);
+        }
+    }
+}
+
+/**
+ *  \brief Stopping the pool of worker processes.
+ *
+ *  The function returns when every worker has terminated.
+ *
+ *  \param semgid semaphore set access identifier
+ *  \param nSem number of semaphores of the problem, the ones of the pool follow them
+ *  \param sh pointer to shared memory region
+ *  \param nWorkers number of worker processes
+ *  \param pid worker processes identifiers
+ */
+
+static void stopPool (int semgid, unsigned int nSem, SHARED_DATA *sh, unsigned int nWorkers, int pid[])
+{
+    unsigned int w;
+    int status;                                                                                   /* execution status */
+
+    poolWatched = false;
+    sh->poolStop = true;
+    for (w = 0; w < nWorkers; w++) {
+        if (semUp (semgid, POOLGO (nSem) + w) == -1) {
+            perror ("error on the up operation for the start of a run");
+            exit (EXIT_FAILURE);
+        }
+    }
+    for (w = 0; w < nWorkers; w++) {
+        if (waitpid (pid[w], &status, 0) == -1) {
+            perror ("error on waiting for a pool worker");
+            exit (EXIT_FAILURE);
+        }
+        pid[w] = 0;
+    }
+    nEntityPid = 0;
+    entityPid = NULL;
+}
+
+/**
+ *  \brief Initialization of the problem internal status and of the semaphore set, in place, before every run.
+ *
+ *  Only the pool workers may be blocked, waiting for the start of the run, and the ring of log records, if any,
+ *  must be drained.
+ *  Every semaphore is set by a single operation, the ones protecting critical regions to 1 and the others to 0,
+ *  except that in virtual time the critical regions of the problem are enabled afterwards by accounted
+ *  <em>up</em>s, since the clock keeps the value each semaphore would have.
+ *
+ *  \param sh pointer to shared memory region
+ *  \param semgid semaphore set access identifier
+ *  \param nSem number of semaphores in set
+ *  \param scale virtual time scale (< 0: real time)
+ */
+
+static void resetRun (SHARED_DATA *sh, int semgid, unsigned int nSem, double scale)
+{
+    PARAM *par = &sh->fSt.par;                                                                  /* problem parameters */
+    unsigned short *val;                                                                  /* values of the semaphores */
+    unsigned int p, g;
+
+    memset (&sh->fSt.st, 0, fullStatSize (par) - offsetof (FULL_STAT, st));      /* as a new region, dimensions aside */
+    memset (passengerQueue (sh), 0, 2 * par->nPassengers * sizeof (unsigned int));
+    memset (sh->gateOpen, 0, sizeof (sh->gateOpen));
+    memset (sh->planeReady, 0, sizeof (sh->planeReady));
+    for (g = 0; g < par->nPilots; g++) {
+        sh->fSt.st.pilotStat[g] = FLYING_BACK;                      /* the pilots are flying towards starting airport */
+    }
+    for (g = 0; g < par->nHostesses; g++) {
+        sh->fSt.st.hostessStat[g] = WAIT_FOR_FLIGHT;            /* the hostesses are waiting for the flight to arrive */
+    }
+    for (p = 0; p < par->nPassengers; p++) {
+        passengerStat (&sh->fSt)[p] = GOING_TO_AIRPORT;                    /* the passengers are going to the airport */
+    }
+    sh->fSt.finished         = false;                                       
+    sh->fSt.nPassInQueue     = 0;                                          
+    sh->fSt.nPassInFlight    = 0;                                         
+    sh->fSt.totalPassBoarded = 0;                                        
+    sh->nGatesOpen           = 0;
+    sh->boardingClosed       = false;
+    sh->nPassChecking        = 0;
+    sh->nPassHolding         = 0;
+    sh->queueHead = sh->queueTail = 0;
+    sh->boarding             = false;
+    sh->readyHead = sh->readyTail = 0;
+    sh->queueSeq = sh->flightSeq = 0;
+    sh->fSt.virtualTime      = (scale >= 0.0);
+    sh->fSt.vtime            = 0;
+    if (scale >= 0.0) {                                          /* every entity is running until it sleeps or blocks */
+        simClockInit (simClock (sh), CLOCKLOCK (par->nPassengers), CLOCKWAKE (par->nPassengers),
+                      CLOCKSLEEPERS (par->nPassengers), SEM_NU (par->nPassengers),
+                      par->nPassengers + par->nHostesses + par->nPilots, scale);
+    }
+    initLogShared (&sh->logSh, (char *) sh + ringSlotsOffset (par), LOGSLOTS, par);
+    if (scale >= 0.0) {
+        initLogClock (&sh->logSh, &simClock (sh)->now);
+    }
+
+    if ((val = calloc (nSem + 1, sizeof (unsigned short))) == NULL) {
+        perror ("error on allocating the values of the semaphores");
+        exit (EXIT_FAILURE);
+    }
+    if (scale >= 0.0) {
+        val[CLOCKLOCK (par->nPassengers)] = 1;
+    }
+    else val[sh->mutex] = val[sh->queueMutex] = val[sh->logMutex] = 1;         /* enabling access to critical regions */
+    if (semSetAll (semgid, val) == -1) {
+        perror ("error on setting the semaphore set");
+        exit (EXIT_FAILURE);
+    }
+    free (val);
+    if (scale >= 0.0) {                                                   /* the operations from now on are accounted */
+        simClockBind (simClock (sh), semgid, 0);
+        if ((semUp (semgid, sh->mutex) == -1) || (semUp (semgid, sh->queueMutex) == -1) ||
+            (semUp (semgid, sh->logMutex) == -1)) {                            /* enabling access to critical regions */
+            perror ("error on executing the up operation for semaphore access");
+            exit (EXIT_FAILURE);
+        }
+    }
+}
+
+/**
+ *  \brief Name of a semaphore of the set.
+ *
+ *  \param sindex semaphore location in the set (1 .. LAT_INDEXES)
+ *  \param name storage for the name
+ */
+
+static void semName (unsigned int sindex, char name[])
+{
+    if (sindex == MUTEX) {
+        strcpy (name, "mutex");
+    }
+    else if (sindex == QUEUEMUTEX) {
+        strcpy (name, "queueMutex");
+    }
+    else if (sindex == LOGMUTEX) {
+        strcpy (name, "logMutex");
+    }
+    else if (sindex == PASSENGERSINQUEUE) {
+        strcpy (name, "passengersInQueue");
+    }
+    else if (sindex < READYTOFLIGHT) {
+        sprintf (name, "passengersWaitInFlight[%u]", sindex - PASSENGERSWAITINFLIGHT);
+    }
+    else if (sindex < PLANEEMPTY) {
+        sprintf (name, "readyToFlight[%u]", sindex - READYTOFLIGHT);
+    }
+    else if (sindex < BOARDINGTURN) {
+        sprintf (name, "planeEmpty[%u]", sindex - PLANEEMPTY);
+    }
+    else if (sindex < READYFORBOARDING) {
+        sprintf (name, "boardingTurn[%u]", sindex - BOARDINGTURN);
+    }
+    else if (sindex < PASSENGERCALLED) {
+        sprintf (name, "readyForBoarding[%u]", sindex - READYFORBOARDING);
+    }
+    else strcpy (name, "passengerCalled[*]");
+}
+
+/**
+ *  \brief Printing of a row of the latencies report.
+ *
+ *  \param name name of the semaphore
+ *  \param entity name of the entity class
+ *  \param kind name of the latency kind
+ *  \param h histogram
+ */
+
+static void printLatencyRow (char name[], char entity[], char kind[], SEM_HIST *h)
+{
+    printf ("%-26s %-4s %-4s %10llu %10.1f %10.1f %10.1f %12.1f\n", name, entity, kind, h->count,
+            semHistPercentile (h, 0.5) / 1000.0, semHistPercentile (h, 0.99) / 1000.0, h->max / 1000.0,
+            (double) h->total / h->count / 1000.0);
+}
+
+/**
+ *  \brief Printing of the latencies of the synchronization points.
+ *
+ *  There is a row per semaphore, entity class and latency kind (the time blocked in a <em>down</em> and, for the
+ *  mutex, the time the critical region is held), followed by the waits of every entity class on all semaphores.
+ *
+ *  \param st latency statistics
+ */
+
+static void printLatency (SEM_STATS *st)
+{
+    static char *entity[LAT_ENTITIES] = { "PT", "HT", "PG" },
+                *kind[2] = { "wait", "hold" };
+    char name[32];                                                                                  /* semaphore name */
+    SEM_HIST *h, all;                                                                  /* histogram, merged histogram */
+    unsigned int e, i, k, b;
+
+    printf ("\nLatency of the synchronization points (us)\n");
+    printf ("%-26s %-4s %-4s %10s %10s %10s %10s %12s\n", "semaphore", "who", "kind", "count", "p50", "p99", "max",
+            "mean");
+    for (i = 1; i <= LAT_INDEXES; i++) {
+        semName (i, name);
+        for (e = 0; e < LAT_ENTITIES; e++) {
+            for (k = SEM_WAIT; k <= SEM_HOLD; k++) {
+                if ((h = semHist (st, e, i, k))->count != 0) {
+                    printLatencyRow (name, entity[e], kind[k], h);
+                }
+            }
+        }
+    }
+    for (e = 0; e < LAT_ENTITIES; e++) {
+        all = (SEM_HIST) { 0 };
+        for (i = 1; i <= LAT_INDEXES; i++) {
+            h = semHist (st, e, i, SEM_WAIT);
+            all.count += h->count;
+            all.total += h->total;
+            if (h->max > all.max) {
+                all.max = h->max;
+            }
+            for (b = 0; b < SEM_HBUCKETS; b++) {
+                all.bucket[b] += h->bucket[b];
+            }
+        }
+        if (all.count != 0) {
+            printLatencyRow ("all", entity[e], kind[SEM_WAIT], &all);
+        }
+    }
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is starting the simulation by generating the intervening entities processes or threads (pilots,
+ *  hostesses and passengers) and waiting for their termination.
+ */
+
+int main (int argc, char *argv[])
+{
+    char nFic[51];                                                                              /*name of logging file */
+    int shmid,                                                                      /* shared memory access identifier */
+        semgid;                                                                     /* semaphore set access identifier */
+    SHARED_DATA *sh;                                                                /* pointer to shared memory region */
+    int pidLG = 0;                                                                       /* logger process identifier */
+    int key;                                                           /*access key to shared memory and semaphore set */
+    char num[12];                                                       /* numeric value conversion (up to 10 digits) */
+    int status;                                                                                   /* execution status */
+    int p, g;
+    bool threads = false;                                                            /* entities generated as threads */
+    unsigned int nTaskWorkers = 0;                             /* worker threads of passenger tasks (0: not as tasks) */
+    bool latency = false;                                                  /* latencies of the synchronization points */
+    bool check = false;                                                           /* invariants checked by the logger */
+    double scale = -1.0;                                                       /* virtual time scale (< 0: real time) */
+    char *tinp;                                                                     /* numerical parameters test flag */
+    size_t size,                                                                         /* size of the shared region */
+           latencyOff = 0, clockOff = 0, deltaOff = 0, timelineOff = 0;        /* offsets of the optional shared data */
+    unsigned int nSem,                                                    /* number of semaphores used by the problem */
+                 nSemSet;                                                              /* number of semaphores in set */
+    unsigned int runs = 1, r;                                                                       /* number of runs */
+    bool pool = false;                                                 /* entities kept in a pool of worker processes */
+    unsigned int nWorkers;                                                                  /* number of pool workers */
+    int *pidPL = NULL;                                                               /* pool workers identifier array */
+    char runFic[51];                                                                 /* name of logging file of a run */
+    int opt;                                                                                   /* command line option */
+    unsigned int backend = LOG_TEXT;                                                               /* logging backend */
+    unsigned int keyframe = 0;                                 /* period of the full state lines (0: no delta layout) */
+    PARAM par = { N, MINFC, MAXFC, 0, NHT, NPT };                                               /* problem parameters */
+    unsigned int seed = (unsigned int) getpid ();                                   /* base seed of random generators */
+    unsigned int timeout = 0;                                                    /* time limit of the downs (0: none) */
+    BOARD_POLICY policy = { POLICY_GREEDY, 0 };                                       /* boarding policy of hostesses */
+    char tlFic[51] = "",                                                       /* name of timeline file (empty: none) */
+         runTlFic[51];                                                              /* name of timeline file of a run */
+    unsigned int nRows = 0;                                                         /* rows of the timeline (0: none) */
+    struct sigaction sa;                                                                   /* supervision of children */
+    bool fixedInstance = false;                                                 /* instance given on the command line */
+    static struct option longOpts[] = { { "seed", required_argument, NULL, 's' }, { NULL, 0, NULL, 0 } };
+
+    /* getting problem parameters, logging backend and log file name */
+    while ((opt = getopt_long (argc, argv, "n:m:M:f:H:P:brwd:tW:cT:p:e:lv:s:R:i:A:", longOpts, NULL)) != -1) {
+        switch (opt) {
+            case 'n':
+                par.nPassengers = getParam (optarg, "number of passengers");
+                break;
+            case 'm':
+                par.minFC = getParam (optarg, "min flight capacity");
+                break;
+            case 'M':
+                par.maxFC = getParam (optarg, "max flight capacity");
+                break;
+            case 'f':
+                par.maxNF = getParam (optarg, "max number of flights");
+                break;
+            case 'H':
+                par.nHostesses = getParam (optarg, "number of hostesses");
+                break;
+            case 'P':
+                par.nPilots = getParam (optarg, "number of planes");
+                break;
+            case 'b':
+                backend = LOG_BINARY;
+                break;
+            case 'r':
+                backend = LOG_RING;
+                break;
+            case 'w':
+                backend = LOG_MMAP;
+                break;
+            case 'd':
+                keyframe = getParam (optarg, "period of the full state lines");
+                break;
+            case 't':
+                threads = true;
+                break;
+            case 'W':
+                nTaskWorkers = getParam (optarg, "number of passenger task workers");
+                threads = true;
+                break;
+            case 'c':
+                check = true;
+                break;
+            case 'T':
+                timeout = getParam (optarg, "time limit of the downs");
+                break;
+            case 'p':
+                if (!policyParse (optarg, &policy)) {
+                    fprintf (stderr, "The boarding policy is wrong (greedy, hold[:us] or predict[:us])!\n");
+                    exit (EXIT_FAILURE);
+                }
+                break;
+            case 'e':
+                if (strlen (optarg) > 40) {                                           /* room for the suffix of a run */
+                    fprintf (stderr, "The name of the timeline file is too long!\n");
+                    exit (EXIT_FAILURE);
+                }
+                strcpy (tlFic, optarg);
+                break;
+            case 'l':
+                latency = true;
+                break;
+            case 'v':
+                scale = strtod (optarg, &tinp);
+                if ((*tinp != '\0') || (scale < 0.0)) {
+                    fprintf (stderr, "The virtual time scale is wrong!\n");
+                    exit (EXIT_FAILURE);
+                }
+                break;
+            case 's':
+                seed = (unsigned int) strtoul (optarg, &tinp, 0);
+                if ((*tinp != '\0') || (*optarg == '\0')) {
+                    fprintf (stderr, "The seed is wrong!\n");
+                    exit (EXIT_FAILURE);
+                }
+                break;
+            case 'R':
+                runs = getParam (optarg, "number of runs");
+                pool = true;
+                break;
+            case 'i':
+                instance = (unsigned int) strtoul (optarg, &tinp, 0);
+                if ((*tinp != '\0') || (*optarg == '\0') || (instance >= MAXINST)) {
+                    fprintf (stderr, "The instance is wrong (0 .. %d)!\n", MAXINST - 1);
+                    exit (EXIT_FAILURE);
+                }
+                fixedInstance = true;
+                break;
+            case 'A':
+                setAffinity (optarg);
+                break;
+            default:
+                fprintf (stderr, "Usage: %s [-n passengers] [-m min-capacity] [-M max-capacity] [-f max-flights] "
+                                 "[-H hostesses] [-P planes] [-b | -r | -w] [-d keyframe] [-t] [-W workers] [-c] "
+                                 "[-T seconds] [-p policy] [-e timeline] [-l] [-v scale] [-s seed] [-R runs] "
+                                 "[-i instance] [-A cpus] [log-file]\n", argv[0]);
+                exit (EXIT_FAILURE);
+        }
+    }
+    if (par.minFC > par.maxFC) {
+        fprintf (stderr, "The min flight capacity is larger than the max flight capacity!\n");
+        exit (EXIT_FAILURE);
+    }
+    if (par.nHostesses > MAXHT) {
+        fprintf (stderr, "The number of hostesses is larger than %d!\n", MAXHT);
+        exit (EXIT_FAILURE);
+    }
+    if (par.nPilots > MAXPT) {
+        fprintf (stderr, "The number of planes is larger than %d!\n", MAXPT);
+        exit (EXIT_FAILURE);
+    }
+    if (par.maxNF == 0) {                                                        /* enough flights for the worst case */
+        par.maxNF = (par.nPassengers + par.minFC - 1) / par.minFC;
+        if (par.maxNF < MAXNF) {
+            par.maxNF = MAXNF;
+        }
+    }
+    else if (par.maxNF < (par.nPassengers + par.minFC - 1) / par.minFC) {
+        fprintf (stderr, "The max number of flights is too small for the number of passengers!\n");
+        exit (EXIT_FAILURE);
+    }
+    if ((nTaskWorkers != 0) && (scale >= 0.0)) {                     /* the virtual clock has a sleeper per passenger */
+        fprintf (stderr, "The passenger tasks do not run in virtual time!\n");
+        exit (EXIT_FAILURE);
+    }
+    if ((policy.kind != POLICY_GREEDY) && (scale >= 0.0)) {             /* the virtual clock does not time out a down */
+        fprintf (stderr, "The boarding policies that hold a flight do not run in virtual time, use desAirLift -p!\n");
+        exit (EXIT_FAILURE);
+    }
+    if (check && (backend != LOG_TEXT) && (backend != LOG_RING)) {
+        fprintf (stderr, "The invariants are checked on the shared ring, check a binary log with logDecoder -c!\n");
+        exit (EXIT_FAILURE);
+    }
+    if (check) {                                                /* the logger terminates and so aborts the simulation */
+        backend = LOG_RING;
+    }
+    pool = pool && !threads;                                           /* the threads are generated again on each run */
+    if(optind==argc-1) {
+        strcpy(nFic, argv[optind]);
+    }
+    else strcpy(nFic, "");
+
+    /* supervision of the processes of the simulation, which is torn down on any termination of the generator */
+
+    genPid = getpid ();
+    memset (&sa, 0, sizeof (sa));
+    sigemptyset (&sa.sa_mask);
+    sa.sa_handler = terminated;
+    sigaction (SIGINT, &sa, NULL);
+    sigaction (SIGTERM, &sa, NULL);
+    sigaction (SIGHUP, &sa, NULL);
+    sa.sa_handler = childTerminated;
+    sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigaction (SIGCHLD, &sa, NULL);
+    atexit (teardown);
+    semTimeout (timeout);                                 /* the threads and the forked processes have the same limit */
+
+    /* creating and initializing the shared memory region */
+
+    size = sharedDataSize (&par, (backend == LOG_RING) ? LOGSLOTS : 0);
+    if (latency) {                                                        /* the optional shared data are placed last */
+        latencyOff = size = (size + 7) & ~(size_t) 7;
+        size += semStatsSize (LAT_ENTITIES, LAT_INDEXES);
+    }
+    if (scale >= 0.0) {
+        clockOff = size = (size + 7) & ~(size_t) 7;
+        size += simClockSize (CLOCKSLEEPERS (par.nPassengers), SEM_NU (par.nPassengers));
+    }
+    if ((keyframe != 0) && (backend != LOG_BINARY)) {
+        deltaOff = size = (size + 7) & ~(size_t) 7;
+        size += logDeltaSize (&par);
+    }
+    if (tlFic[0] != '\0') {                                         /* every passenger and every step of every flight */
+        nRows = 2 * par.nPassengers + 5 * par.maxNF;
+        timelineOff = size = (size + 7) & ~(size_t) 7;
+        size += timelineSize (par.nPassengers, nRows);
+    }
+    nSem = (scale >= 0.0) ? SEM_NU_CLOCK (par.nPassengers) : SEM_NU (par.nPassengers);
+    for (; ; instance++) {                                 /* the region is created by the instance that owns the key */
+        if ((key = ftok (".", 'a' + instance)) == -1) {
+            perror ("error on generating the key");
+            exit (EXIT_FAILURE);
+        }
+        if ((shmid = shmemCreate (key, size)) != -1) {
+            break;
+        }
+        if ((errno != EEXIST) || fixedInstance || (instance == MAXINST - 1)) {
+            perror ("error on creating the shared memory region");
+            exit (EXIT_FAILURE);
+        }
+    }
+    sprintf (num, "%d", key);                                                               /* composing command line */
+    if (shmemAttach (shmid, (void **) &sh) == -1) { 
+        perror ("error on mapping the shared region on the process address space");
+        exit (EXIT_FAILURE);
+    }
+    ipcShmid = shmid;
+
+    /* initialize problem internal status */
+
+    sh->fSt.par = par;                                         /* the dimensions are read by every intervening entity */
+    sh->latencyOff           = latencyOff;
+    if (latency) {                                                               /* the latencies of every run add up */
+        semStatsInit (latencyStats (sh), LAT_ENTITIES, LAT_INDEXES, MUTEX);
+    }
+    sh->clockOff             = clockOff;
+    sh->downTimeout          = timeout;
+    sh->policy               = policy;
+    sh->logBackend           = backend;
+    setLogBackend (sh->logBackend, &sh->logSh);
+    sh->deltaOff             = deltaOff;
+    if (deltaOff != 0) {                                               /* shared by every process writing to the file */
+        initLogDelta (logDelta (sh), keyframe);
+    }
+    setLogDelta (logDelta (sh));
+    sh->timelineOff          = timelineOff;
+    timelineBind (timeline (sh));                                            /* inherited by the threads and the pool */
+
+    /* initialize semaphore ids */
+
+    sh->mutex = MUTEX;                                                              /* mutual exclusion semaphore id */
+    sh->queueMutex = QUEUEMUTEX;
+    sh->logMutex = LOGMUTEX;
+    sh->passengersInQueue = PASSENGERSINQUEUE;                                       
+    sh->passengerCalled = PASSENGERCALLED;                                                       /* one per passenger */
+    for (p = 0; p < MAXPT; p++) {                                                                /* one set per plane */
+        sh->passengersWaitInFlight[p] = PASSENGERSWAITINFLIGHT + p;
+        sh->readyToFlight[p] = READYTOFLIGHT + p;
+        sh->planeEmpty[p] = PLANEEMPTY + p;
+        sh->boardingTurn[p] = BOARDINGTURN + p;
+    }
+    for (g = 0; g < MAXHT; g++) {                                                                     /* one per gate */
+        sh->readyForBoarding[g] = READYFORBOARDING + g;
+    }
+
+    /* creating the semaphore set, its semaphores are set before every run */
+
+    nWorkers = (pool) ? par.nPassengers + par.nHostesses + par.nPilots : 0;
+    nSemSet = (pool) ? POOLDONE (nSem, nWorkers) : nSem;
+    if ((semgid = (threads) ? semCreateLocal (nSemSet) : semCreate (key, nSemSet)) == -1) {
+        perror ("error on creating the semaphore set");
+        if (!threads && (errno == EINVAL)) {                                      /* SVIPC sets are bounded by SEMMSL */
+            fprintf (stderr, "There is one semaphore per passenger (two with -v, three with -R), use -t for a larger "
+                             "number of passengers!\n");
+        }
+        shmemDestroy (shmid);
+        exit (EXIT_FAILURE);
+    }
+    if (!threads) {                                               /* a process private set goes away with the process */
+        ipcSemgid = semgid;
+    }
+
+    /* generation of intervening entities, once for all the runs in a pool */
+
+    if (pool) {
+        if ((pidPL = malloc (nWorkers * sizeof (int))) == NULL) {
+            perror ("error on allocating the pool workers identifier array");
+            exit (EXIT_FAILURE);
+        }
+        generatePool (nFic, runs, semgid, nSem, sh, seed, pidPL);
+    }
+
+    for (r = 0; r < runs; r++) {
+        runLogName (nFic, runs, r, runFic);
+        resetRun (sh, semgid, nSemSet, scale);
+        createLog (runFic, &sh->fSt);                                                            /* log file creation */
+
+        if (backend == LOG_RING) {                                                                  /* logger process */
+            if ((pidLG = fork ()) < 0) {
+                perror ("error on the fork operation for the logger");
+                exit (EXIT_FAILURE);
+            }
+            if (pidLG == 0) {
+                superviseChild ();
+                if (check) {
+                    checkInit (&par);
+                    setLogCheck (checkEvent);
+                }
+                exit ((drainLog (runFic, &sh->logSh)) ? EXIT_SUCCESS : EXIT_FAILURE);
+            }
+            loggerPid = pidLG;
+        }
+
+        sh->runStart = policyClock ();                                   /* the passengers start going to the airport */
+        if (nRows != 0) {
+            timelineInit (timeline (sh), par.nPassengers, nRows, (scale >= 0.0) ? &simClock (sh)->now : NULL);
+        }
+        if (threads) {
+            generateThreads (runFic, semgid, sh, seed + r, nTaskWorkers);
+        }
+        else if (pool) {
+            runPool (semgid, nSem, sh, nWorkers, r);
+        }
+        else generateProcesses (runFic, num, semgid, &par, pidLG, seed);
+
+        if (scale < 0.0) {
+            sh->fSt.makespan = policyClock () - sh->runStart;
+        }
+        saveAirLiftResult(runFic,&sh->fSt);
+        truncateLog (runFic);                                         /* the mapped logging file takes its final size */
+        if (nRows != 0) {
+            runLogName (tlFic, runs, r, runTlFic);
+            if ((p = timelineExport (timeline (sh), runTlFic)) != 0) {
+                fprintf (stderr, "%d events were dropped from the timeline!\n", p);
+            }
+        }
+
+        if (backend == LOG_RING) {                                        /* waiting for the logger to drain the ring */
+            loggerPid = 0;                                                        /* it terminates once it is drained */
+            closeRing (&sh->logSh);
+            if (waitpid (pidLG, &status, 0) == -1) {
+                perror ("error on waiting for the logger process");
+                exit (EXIT_FAILURE);
+            }
+            if (!WIFEXITED (status) || (WEXITSTATUS (status) != EXIT_SUCCESS)) {
+                abortRun ("The logger process failed, the simulation was aborted!\n");
+            }
+        }
+    }
+    if (pool) {
+        stopPool (semgid, nSem, sh, nWorkers, pidPL);
+        free (pidPL);
+    }
+    if (latency) {
+        printLatency (latencyStats (sh));
+    }
 
     /* destruction of semaphore set and shared region */
 
@@ -197,6 +1295,7 @@ int main (int argc, char *argv[])
         perror ("error on destructing the semaphore set");
         exit (EXIT_FAILURE);
     }
+    ipcSemgid = -1;
     if (shmemDettach (sh) == -1) { 
         perror ("error on unmapping the shared region off the process address space");
         exit (EXIT_FAILURE);
@@ -205,6 +1304,7 @@ int main (int argc, char *argv[])
         perror ("error on destructing the shared region");
         exit (EXIT_FAILURE);
     }
+    ipcShmid = -1;
 
     return EXIT_SUCCESS;
 }
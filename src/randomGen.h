@@ -0,0 +1,100 @@
+/**
+ *  \file randomGen.h (interface file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Random generator of an intervening entity.
+ *
+ *  Every entity draws its travel and flight times from a generator of its own, seeded from a base seed and its
+ *  identification, so that the same base seed gives the same times to every entity whatever the order the
+ *  entities are scheduled in and whether they are processes or threads. The numbers are the ones
+ *  <tt>random</tt> would return after <tt>srandom</tt> with the same seed.
+ *
+ *  Operations defined on the generator:
+ *     \li derivation of the seed of an entity from a base seed
+ *     \li initialization
+ *     \li next number.
+ */
+
+#ifndef RANDOMGEN_H_
+#define RANDOMGEN_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* Kinds of entity, for the derivation of seeds */
+
+/** \brief passenger */
+#define  RND_PASSENGER      0
+/** \brief hostess */
+#define  RND_HOSTESS        1
+/** \brief pilot */
+#define  RND_PILOT          2
+
+/** \brief size of the state of the generator, the one <tt>srandom</tt> uses */
+#define  RND_STATE        128
+
+/**
+ *  \brief Definition of <em>random generator</em> data type.
+ */
+typedef struct
+{ /** \brief state of the generator */
+    struct random_data data;
+    /** \brief storage of the state */
+    char state[RND_STATE];
+
+} RND_GEN;
+
+/**
+ *  \brief Derivation of the seed of an entity.
+ *
+ *  The bits of the base seed, the kind of entity and its identification are mixed, so that close base seeds and
+ *  entities give unrelated seeds.
+ *
+ *  \param seed base seed
+ *  \param kind kind of entity (<tt>RND_PASSENGER</tt>, <tt>RND_HOSTESS</tt> or <tt>RND_PILOT</tt>)
+ *  \param id identification of the entity
+ *
+ *  \return seed of the entity
+ */
+static inline unsigned int rndSeed (unsigned int seed, unsigned int kind, unsigned int id)
+{
+    uint32_t h = seed ^ (kind * 0x85ebca6bu) ^ (id * 0x9e3779b9u);
+
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ *  \brief Initialization of a generator.
+ *
+ *  \param g generator
+ *  \param seed seed
+ */
+static inline void rndInit (RND_GEN *g, unsigned int seed)
+{
+    memset (&g->data, 0, sizeof (g->data));
+    initstate_r (seed, g->state, RND_STATE, &g->data);
+}
+
+/**
+ *  \brief Next number of a generator, between 0 and <tt>RAND_MAX</tt>.
+ *
+ *  \param g generator
+ *
+ *  \return number
+ */
+static inline long rndNext (RND_GEN *g)
+{
+    int32_t r;
+
+    random_r (&g->data, &r);
+    return r;
+}
+
+#endif /* RANDOMGEN_H_ */
@@ -0,0 +1,103 @@
+/**
+ *  \file semSharedMemEntities.h (interface file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Synchronization based on semaphores and shared memory.
+ *
+ *  Life cycles of the intervening entities as threads of the generator process.
+ *
+ *  Each entity is first bound to the logging file, the semaphore set and the shared region of the generator
+ *  process, once for all the threads of that kind, and then its life cycle is started as a thread. The passengers
+ *  may instead be run as tasks over a few worker threads.
+ */
+
+#ifndef SEMSHAREDMEMENTITIES_H_
+#define SEMSHAREDMEMENTITIES_H_
+
+#include "sharedDataSync.h"
+
+/**
+ *  \brief Binding of the pilots to the resources of the generator process.
+ *
+ *  \param name logging file name
+ *  \param sgid semaphore set access identifier
+ *  \param shared pointer to shared memory region
+ *  \param seed base seed of the random generators, the one of each entity is derived from it and its
+ *  identification
+ */
+
+extern void pilotBind (char name[], int sgid, SHARED_DATA *shared, unsigned int seed);
+
+/**
+ *  \brief Life cycle of a pilot as a thread of the generator process.
+ *
+ *  \param arg plane flown by the pilot, cast to a pointer
+ *
+ *  \return \c NULL
+ */
+
+extern void *pilotThread (void *arg);
+
+/**
+ *  \brief Binding of the hostesses to the resources of the generator process.
+ *
+ *  \param name logging file name
+ *  \param sgid semaphore set access identifier
+ *  \param shared pointer to shared memory region
+ *  \param seed base seed of the random generators, the one of each entity is derived from it and its
+ *  identification
+ */
+
+extern void hostessBind (char name[], int sgid, SHARED_DATA *shared, unsigned int seed);
+
+/**
+ *  \brief Life cycle of a hostess as a thread of the generator process.
+ *
+ *  \param arg boarding gate, cast to a pointer
+ *
+ *  \return \c NULL
+ */
+
+extern void *hostessThread (void *arg);
+
+/**
+ *  \brief Binding of the passengers to the resources of the generator process.
+ *
+ *  \param name logging file name
+ *  \param sgid semaphore set access identifier
+ *  \param shared pointer to shared memory region
+ *  \param seed base seed of the random generators, the one of each entity is derived from it and its
+ *  identification
+ */
+
+extern void passengerBind (char name[], int sgid, SHARED_DATA *shared, unsigned int seed);
+
+/**
+ *  \brief Life cycle of a passenger as a thread of the generator process.
+ *
+ *  \param arg passenger id, cast to a pointer
+ *
+ *  \return \c NULL
+ */
+
+extern void *passengerThread (void *arg);
+
+/**
+ *  \brief Generation of the passengers as tasks multiplexed over a pool of worker threads.
+ *
+ *  Each task is run by a worker from one wait of the life cycle of the passenger to the next one, while the waits
+ *  themselves are done by a queue waiter thread and a waiter thread per plane. The passengers must be bound first.
+ *
+ *  \param nWorkers number of worker threads
+ */
+
+extern void passengerTasksStart (unsigned int nWorkers);
+
+/**
+ *  \brief Waiting for every passenger task to reach the destination.
+ */
+
+extern void passengerTasksJoin (void);
+
+#endif /* SEMSHAREDMEMENTITIES_H_ */
@@ -6,12 +6,14 @@
  *  Synchronization based on semaphores and shared memory.
  *  Implementation with SVIPC.
  *
- *  Definition of the operations carried out by the hostess:
+ *  Definition of the operations carried out by each hostess, at her own boarding gate:
  *     \li waitForNextFlight
  *     \li waitForPassenger
  *     \li checkPassport
  *     \li signalReadyToFlight
  *
+ *  The life cycle runs either as a process of its own or as a thread of the generator process.
+ *
  *  \author Nuno Lau - January 2022
  */
 
@@ -22,6 +24,7 @@
 #include <sys/types.h>
 #include <string.h>
 #include <math.h>
+#include <errno.h>
 
 #include "probConst.h"
 #include "probDataStruct.h"
@@ -29,30 +32,44 @@
 #include "sharedDataSync.h"
 #include "semaphore.h"
 #include "sharedMemory.h"
+#include "semSharedMemEntities.h"
+#include "randomGen.h"
+#include "boardingPolicy.h"
+#include "timeline.h"
+#include "trace.h"
 
 /** \brief logging file name */
 static char nFic[51];
 
-/** \brief shared memory block access identifier */
-static int shmid;
-
 /** \brief semaphore set access identifier */
 static int semgid;
 
 /** \brief pointer to shared memory region */
 static SHARED_DATA *sh;
 
+/** \brief base seed of the random generators of the hostesses run as threads */
+static unsigned int baseSeed;
+
+/** \brief random generator of the hostess */
+static __thread RND_GEN rnd;
+
+/** \brief the seat claimed by the hostess may still be released */
+static __thread bool holding;
+
 /** \brief hostess waits for next flight */
-static void waitForNextFlight ();
+static bool waitForNextFlight (unsigned int gate);
 
 /** \brief hostess waits for passenger */
-static void waitForPassenger();
+static bool waitForPassenger (unsigned int gate);
 
 /** \brief hostess checks passport */
-static bool checkPassport ();
+static bool checkPassport (unsigned int gate);
 
 /** \brief hostess signals boarding is complete */
-static void signalReadyToFlight ();
+static void signalReadyToFlight (unsigned int gate);
+
+/** \brief test of boarding completion across gates */
+static bool boardingComplete (unsigned int *hold);
 
 
 /** \brief getter for number of passengers flying */
@@ -61,6 +78,14 @@ static int nPassengersInFlight ();
 /** \brief getter for number of passengers waiting */
 static int nPassengersInQueue ();
 
+/** \brief life cycle of the hostess */
+static void lifeCycle (unsigned int gate, unsigned int seed);
+
+#ifndef THREAD_ENGINE
+
+/** \brief shared memory block access identifier */
+static int shmid;
+
 /**
  *  \brief Main program.
  *
@@ -71,22 +96,34 @@ int main (int argc, char *argv[])
 {
     int key;                                                           /*access key to shared memory and semaphore set */
     char *tinp;                                                                      /* numerical parameters test flag */
+    unsigned int seed;                                                                    /* seed of random generator */
+    int g;
 
     /* validation of command line parameters */
 
-    if (argc != 4) { 
+    if (argc != 6) { 
         freopen ("error_HT", "a", stderr);
         fprintf (stderr, "Number of parameters is incorrect!\n");
         return EXIT_FAILURE;
     }
-    else freopen (argv[3], "w", stderr);
+    else freopen (argv[5], "w", stderr);
 
-    strcpy (nFic, argv[1]);
-    key = (unsigned int) strtol (argv[2], &tinp, 0);
+    g = (unsigned int) strtol (argv[1], &tinp, 0);
+    if (*tinp != '\0') { 
+        fprintf (stderr, "Hostess process identification is wrong!\n");
+        return EXIT_FAILURE;
+    }
+    strcpy (nFic, argv[2]);
+    key = (unsigned int) strtol (argv[3], &tinp, 0);
     if (*tinp != '\0')
     { fprintf (stderr, "Error on the access key communication!\n");
         return EXIT_FAILURE;
     }
+    seed = (unsigned int) strtoul (argv[4], &tinp, 0);
+    if (*tinp != '\0') {
+        fprintf (stderr, "Error on the seed communication!\n");
+        return EXIT_FAILURE;
+    }
 
     /* connection to the semaphore set and the shared memory region and mapping the shared region onto the
        process address space */
@@ -103,23 +140,18 @@ int main (int argc, char *argv[])
         perror ("error on mapping the shared region on the process address space");
         return EXIT_FAILURE;
     }
-
-    srandom ((unsigned int) getpid ());                                                 /* initialize random generator */
+    setLogBackend (sh->logBackend, &sh->logSh);                                         /* same backend as the others */
+    setLogDelta (logDelta (sh));                                                         /* same layout as the others */
+    semTimeout (sh->downTimeout);                                                    /* same time limit as the others */
+    timelineBind (timeline (sh));                                                      /* same timeline as the others */
+    if ((g < 0) || (g >= sh->fSt.par.nHostesses)) {                        /* validated against the shared dimensions */
+        fprintf (stderr, "Hostess process identification is wrong!\n");
+        return EXIT_FAILURE;
+    }
 
     /* simulation of the life cycle of the hostess */
 
-    int nPassengers=0;
-    bool lastPassengerInFlight;
-
-    while(nPassengers < N ) {
-        waitForNextFlight();
-        do { 
-            waitForPassenger();
-            lastPassengerInFlight = checkPassport();
-            nPassengers++;
-        } while (!lastPassengerInFlight);
-        signalReadyToFlight();
-    }
+    lifeCycle(g, seed);
 
     /* unmapping the shared region off the process address space */
 
@@ -131,118 +163,283 @@ int main (int argc, char *argv[])
     return EXIT_SUCCESS;
 }
 
+#endif /* THREAD_ENGINE */
+
+/**
+ *  \brief Binding of the hostesses to the resources of the generator process.
+ *
+ *  \param name logging file name
+ *  \param sgid semaphore set access identifier
+ *  \param shared pointer to shared memory region
+ *  \param seed base seed of the random generators
+ */
+
+void hostessBind (char name[], int sgid, SHARED_DATA *shared, unsigned int seed)
+{
+    baseSeed = seed;
+    strcpy (nFic, name);
+    semgid = sgid;
+    sh = shared;
+}
+
+/**
+ *  \brief Life cycle of a hostess as a thread of the generator process.
+ *
+ *  \param arg boarding gate, cast to a pointer
+ *
+ *  \return \c NULL
+ */
+
+void *hostessThread (void *arg)
+{
+    unsigned int id = (unsigned int) (unsigned long) arg;
+
+    lifeCycle(id, rndSeed (baseSeed, RND_HOSTESS, id));
+    return NULL;
+}
+
+/**
+ *  \brief life cycle of the hostess
+ *
+ *  The hostess boards the passengers at her gate, flight after flight, until every one of them has been claimed by
+ *  some gate.
+ *
+ *  \param gate boarding gate
+ *  \param seed seed of the random generator
+ */
+
+static void lifeCycle (unsigned int gate, unsigned int seed)
+{
+    bool lastPassengerInFlight;
+
+    rndInit (&rnd, seed);                                                              /* initialize random generator */
+    semInstrument (latencyStats (sh), LAT_HOSTESS);                           /* timing of the synchronization points */
+    simClockBind (simClock (sh), semgid, 0);                                           /* never sleeps, but it blocks */
+
+    while (waitForNextFlight(gate)) {
+        do { 
+            lastPassengerInFlight = !waitForPassenger(gate) || checkPassport(gate);
+        } while (!lastPassengerInFlight);
+        signalReadyToFlight(gate);
+    }
+    simExit ();
+}
+
 /**
  *  \brief wait for Next Flight.
  *
  *  Hostess updates its state and waits for plane to be ready for boarding
  *  The internal state should be saved.
  *
+ *  \param gate boarding gate
+ *
+ *  \return true if there is a next flight (false if every passenger has already been claimed by some gate, for
+ *  good, and the gate is not expected to take part in the flight being boarded)
  */
 
-static void waitForNextFlight ()
+static bool waitForNextFlight (unsigned int gate)
 {
-    if (semDown (semgid, sh->mutex) == -1)  {                                                  /* enter critical region */
+    bool over;
+
+    if (semDown (semgid, sh->mutex) == -1)  {                                         /* enter flight critical region */
         perror ("error on the down operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    sh->fSt.st.hostessStat = WAIT_FOR_FLIGHT; // Alterar estado da hospedeira
-    saveState(nFic, &(sh->fSt));              // Guardar estados
+    over = sh->fSt.totalPassBoarded + sh->nPassChecking - sh->nPassHolding         // Determinar se já não há mais voos
+           == sh->fSt.par.nPassengers && !sh->gateOpen[gate];                       // em que a porta tenha de participar
     
-    if (semUp (semgid, sh->mutex) == -1)                                                       /* exit critical region */
+    if (semUp (semgid, sh->mutex) == -1)                                               /* exit flight critical region */
     { 
         perror ("error on the up operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    semDown(semgid, sh->readyForBoarding); // Esperar autorização do piloto para começar o embarque
+    if (over)
+        return false;
+    if (semDown (semgid, sh->logMutex) == -1) {                                          /* enter log critical region */
+        perror ("error on the down operation for semaphore access (HT)");
+        exit (EXIT_FAILURE);
+    }
+    sh->fSt.st.hostessStat[gate] = WAIT_FOR_FLIGHT; // Alterar estado da hospedeira
+    TRACE_HOSTESS (gate, sh->fSt.st.hostessStat[gate]); // Assinalar a transição de estado
+    saveState(nFic, stateSnapshot (sh));            // Guardar estados
+    if (semUp (semgid, sh->logMutex) == -1) {                                             /* exit log critical region */
+        perror ("error on the up operation for semaphore access (HT)");
+        exit (EXIT_FAILURE);
+    }
+    if (semDown(semgid, sh->readyForBoarding[gate]) == -1) { // Esperar autorização do piloto para começar o embarque
+        perror ("error on the down operation for semaphore access (HT)");
+        exit (EXIT_FAILURE);
+    }
+
+    return !sh->fSt.finished; // O último voo pode partir enquanto esta porta espera
 }
 
 /**
  *  \brief hostess waits for passenger
  *
- *  hostess waits for passengers to arrive at airport.
+ *  hostess claims a seat of the flight and waits for passengers to arrive at airport.
+ *  No seat is claimed if boarding is already complete, taking into account the passports being checked at the
+ *  other gates.
+ *  A seat claimed while the boarding policy holds the flight waits for its passenger only for a while, then it is
+ *  released and the boarding is closed.
  *  The internal state should be saved.
+ *
+ *  \param gate boarding gate
+ *
+ *  \return true if a seat was claimed
  */
 
-static void waitForPassenger ()
+static bool waitForPassenger (unsigned int gate)
 {
-    if (semDown (semgid, sh->mutex) == -1)                                                      /* enter critical region */
+    bool complete;
+    unsigned int hold;                                                     /* time to wait for the passenger (0: all) */
+    int stat;
+
+    if (semDown (semgid, sh->mutex) == -1)                                            /* enter flight critical region */
     { 
         perror ("error on the down operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    sh->fSt.st.hostessStat = WAIT_FOR_PASSENGER; // Alterar estado da hospedeira
-    saveState(nFic, &(sh->fSt));                 // Guardar estados
-
-    if (semUp (semgid, sh->mutex) == -1) {                                                  /* exit critical region */
+    complete = boardingComplete(&hold); // Decidir atomicamente se ainda há lugar para mais um passageiro
+    if (complete)
+        sh->boardingClosed = true;
+    else sh->nPassChecking++;      // Reservar lugar no voo
+    holding = !complete && (hold != 0);
+    if (holding)
+        sh->nPassHolding++;        // que pode ser libertado
+
+    if (semUp (semgid, sh->mutex) == -1) {                                             /* exit flight critical region */
         perror ("error on the up operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    semDown(semgid, sh->passengersInQueue); // Esperar pelo próximo passageiro
+    if (complete)
+        return false;
+    if (semDown (semgid, sh->logMutex) == -1) {                                          /* enter log critical region */
+        perror ("error on the down operation for semaphore access (HT)");
+        exit (EXIT_FAILURE);
+    }
+    sh->fSt.st.hostessStat[gate] = WAIT_FOR_PASSENGER; // Alterar estado da hospedeira
+    TRACE_HOSTESS (gate, sh->fSt.st.hostessStat[gate]); // Assinalar a transição de estado
+    saveState(nFic, stateSnapshot (sh));               // Guardar estados
+    if (semUp (semgid, sh->logMutex) == -1) {                                             /* exit log critical region */
+        perror ("error on the up operation for semaphore access (HT)");
+        exit (EXIT_FAILURE);
+    }
+    stat = (hold == 0) ? semDown(semgid, sh->passengersInQueue)            // Esperar pelo próximo passageiro
+                       : semDownTimed(semgid, sh->passengersInQueue, hold); // ou só durante o tempo da política
+    if ((stat == -1) && (errno == EAGAIN)) {
+        if (semDown (semgid, sh->mutex) == -1) {                                      /* enter flight critical region */
+            perror ("error on the down operation for semaphore access (HT)");
+            exit (EXIT_FAILURE);
+        }
+        sh->nPassChecking--;        // Libertar a reserva do lugar
+        sh->nPassHolding--;
+        sh->boardingClosed = true;  // e fechar o embarque, o voo já tem a capacidade mínima
+        if (semUp (semgid, sh->mutex) == -1) {                                         /* exit flight critical region */
+            perror ("error on the up operation for semaphore access (HT)");
+            exit (EXIT_FAILURE);
+        }
+        return false;
+    }
+    if (stat == -1) {
+        perror ("error on the down operation for semaphore access (HT)");
+        exit (EXIT_FAILURE);
+    }
+
+    return true;
 }
 
 /**
  *  \brief passport check
  *
- *  The hostess checks passenger passport and waits for passenger to show id
+ *  The hostess calls the passenger at the head of the queue, whose id is known from the queue itself, checks the
+ *  passport and wakes up exactly that passenger.
  *  The internal state should be saved twice.
  *
+ *  \param gate boarding gate
+ *
  *  \return should be true if this is the last passenger for this flight
  *    that is: 
  *      - flight is at its maximum capacity 
  *      - flight is at or higher than minimum capacity and no passenger waiting 
  *      - no more passengers
+ *    counting the passports being checked at the other gates, the decision is taken in the same critical region
+ *    that updates the number of passengers
  */
 
-static bool checkPassport()
+static bool checkPassport(unsigned int gate)
 {
+    SEM_OP leave[] = { { sh->logMutex, 1 }, { sh->mutex, 1 }, { 0, 1 } };
+    FULL_STAT *snap;                                                                         /* snapshot of the state */
+    unsigned int id, hold;
     bool last;
 
     /* insert your code here */
 
-    if (semDown (semgid, sh->mutex) == -1) {                                                     /* enter critical region */
+    if (semDown (semgid, sh->logMutex) == -1) {                                          /* enter log critical region */
         perror ("error on the down operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    sh->fSt.st.hostessStat = CHECK_PASSPORT; // Alterar estado da hospedeira
-    saveState(nFic, &(sh->fSt));             // Guardar estados
+    sh->fSt.st.hostessStat[gate] = CHECK_PASSPORT;  // Alterar estado da hospedeira
+    TRACE_HOSTESS (gate, sh->fSt.st.hostessStat[gate]); // Assinalar a transição de estado
+    saveState(nFic, stateSnapshot (sh));            // Guardar estados
 
-    if (semUp (semgid, sh->mutex) == -1)     {                                                 /* exit critical region */
+    if (semUp (semgid, sh->logMutex) == -1) {                                             /* exit log critical region */
         perror ("error on the up operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
     }
-
-    /* insert your code here */
-    semUp(semgid, sh->passengersWaitInQueue); // Autorizar passageiro a sair da fila
-    semDown(semgid, sh->idShown);             // Esperar que o passageiro mostre o ID
-
-    if (semDown (semgid, sh->mutex) == -1)  {                                                 /* enter critical region */
+    if ((semDown (semgid, sh->mutex) == -1) ||                             /* enter flight and queue critical regions */
+        (semDown (semgid, sh->queueMutex) == -1)) {
         perror ("error on the down operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
+    stateWriteBegin (&sh->flightSeq);
+    stateWriteBegin (&sh->queueSeq);
+    id = passengerQueue(sh)[sh->queueHead++];       // Chamar o primeiro passageiro da fila
+    passengerPlane(sh)[id] = sh->fSt.boardingPlane; // Indicar-lhe o avião
+    leave[2].sindex = sh->passengerCalled + id;
     sh->fSt.nPassInQueue--;     // Decrementar nr de passageiros na fila
-    sh->fSt.nPassInFlight++;    // Incrementar nr de passageiros no voo
+    __atomic_add_fetch (&sh->fSt.nPassInFlight, 1, __ATOMIC_RELAXED);      // Incrementar nr de passageiros no voo
+    __atomic_add_fetch (&sh->fSt.planePass[sh->fSt.boardingPlane], 1, __ATOMIC_RELAXED);
     sh->fSt.totalPassBoarded++; // Incrementar nr de passageiros totais que já embarcaram
+    timelineEvent (TL_CHECKED, sh->fSt.nFlight, sh->fSt.boardingPlane, id); // Registar o tempo de espera na fila
+    sh->nPassChecking--;        // Libertar a reserva do lugar
+    if (holding)
+        sh->nPassHolding--;
+    stateWriteEnd (&sh->queueSeq);
 
-    last = nPassengersInFlight() == MAXFC 
-        || (nPassengersInFlight() >= MINFC && nPassengersInQueue() == 0)
-        || sh->fSt.totalPassBoarded == N; // Determinar se é o último passageiro no voo
+    last = boardingComplete(&hold); // Determinar se é o último passageiro no voo
+    if (last)
+        sh->boardingClosed = true;
 
-    savePassengerChecked(nFic, &(sh->fSt)); // Identificar o passageiro que embarcou
-    saveState(nFic, &(sh->fSt));            // Guardar estados
+    sh->fSt.passengerChecked = id;          // Identificar o passageiro que embarcou
+    stateWriteEnd (&sh->flightSeq);
+
+    if (semUp (semgid, sh->queueMutex) == -1) {                                         /* exit queue critical region */
+        perror ("error on the up operation for semaphore access (HT)");
+        exit (EXIT_FAILURE);
+    }
+    if (semDown (semgid, sh->logMutex) == -1) {                                          /* enter log critical region */
+        perror ("error on the down operation for semaphore access (HT)");
+        exit (EXIT_FAILURE);
+    }
+    snap = stateSnapshot (sh);
+    savePassengerChecked(nFic, snap);
+    saveState(nFic, snap);                          // Guardar estados
 
-    if (semUp (semgid, sh->mutex) == -1) {                                                     /* exit critical region */
+    if (semOpBatch (semgid, leave, 3) == -1) {  /* exit log and flight critical regions and authorize passenger to board */
         perror ("error on the up operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
     }
@@ -252,46 +449,112 @@ static bool checkPassport()
     return last;
 }
 
+/**
+ *  \brief boarding completion test
+ *
+ *  Must be called in the flight critical region, the passengers may keep joining the queue meanwhile.
+ *  The passports being checked count as boarded passengers and the passengers in queue they are waiting for are no
+ *  longer available.
+ *  A flight with its min capacity and no passenger available is complete unless the boarding policy waits for one
+ *  more passenger.
+ *
+ *  \param hold storage for the time the next seat may wait for its passenger (us), \c 0 if there is no limit
+ *
+ *  \return true if no more seats of the current flight may be claimed
+ */
+
+static bool boardingComplete(unsigned int *hold)
+{
+    unsigned int claimed = nPassengersInFlight() + sh->nPassChecking;
+
+    *hold = 0;
+    if (sh->boardingClosed || claimed == sh->fSt.par.maxFC
+        || sh->fSt.totalPassBoarded + sh->nPassChecking == sh->fSt.par.nPassengers)
+        return true;
+    if (claimed >= sh->fSt.par.minFC && nPassengersInQueue() <= sh->nPassChecking) {
+        *hold = policyHold (&sh->policy, sh->fSt.par.nPassengers - sh->fSt.totalPassBoarded - nPassengersInQueue(),
+                            policyClock () - sh->runStart);                      // Esperar mais um passageiro?
+        return *hold == 0;
+    }
+    return false;
+}
+
 static int nPassengersInFlight()
 {
-    return sh->fSt.nPassInFlight;
+    return sh->fSt.planePass[sh->fSt.boardingPlane];
 }
 
 static int nPassengersInQueue()
 {
-    return sh->fSt.nPassInQueue;
+    return __atomic_load_n (&sh->fSt.nPassInQueue, __ATOMIC_RELAXED);
 }
 
 /**
  *  \brief signal ready to flight 
  *
+ *  The hostess leaves her gate, the last one to leave closes boarding for every gate.
  *  The flight is ready to go.
  *  The hostess updates her state, registers the number of passengers in this flight 
  *  and checks if the airlift is finished (all passengers have boarded).
- *  Hostess informs pilot that plane is ready to flight.
+ *  Hostess informs pilot that plane is ready to flight and gives the turn to board to the next plane waiting.
+ *  When the airlift is finished, the hostesses waiting for a next flight at the other gates and the planes waiting
+ *  for their turn are released.
  *  The internal state should be saved.
+ *
+ *  \param gate boarding gate
  */
-void signalReadyToFlight()
+void signalReadyToFlight(unsigned int gate)
 {
-    if (semDown (semgid, sh->mutex) == -1) {                                                /* enter critical region */
+    SEM_OP leave[MAXHT+MAXPT+2] = { { sh->mutex, 1 } };
+    FULL_STAT *snap;                                                                         /* snapshot of the state */
+    unsigned int nops = 1, g, plane;
+
+    if (semDown (semgid, sh->mutex) == -1) {                                          /* enter flight critical region */
         perror ("error on the down operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    sh->fSt.st.hostessStat = READY_TO_FLIGHT;                               // Alterar estado da hospedeira
-    sh->fSt.nPassengersInFlight[sh->fSt.nFlight-1] = sh->fSt.nPassInFlight; // Guardar nr de passageiros no voo
-    sh->fSt.finished = sh->fSt.totalPassBoarded == N;                       // Determinar se todos os passageiros já embarcaram
-    saveState(nFic, &(sh->fSt));                                            // Guardar estados
-    saveFlightDeparted(nFic, &(sh->fSt));                                   // Indicar o começo do voo
+    stateWriteBegin (&sh->flightSeq);
+    sh->gateOpen[gate] = false;
+    if (--sh->nGatesOpen == 0) {                                                    // Última porta a fechar
+        plane = sh->fSt.boardingPlane;
+        passengersPerFlight(&sh->fSt)[sh->fSt.nFlight-1] = sh->fSt.planePass[plane];// Guardar nr de passageiros no voo
+        planePerFlight(&sh->fSt)[sh->fSt.nFlight-1] = plane;                        // e o avião que o fez
+        timelineEvent (TL_DEPARTED, sh->fSt.nFlight, plane, -1);                    // Registar a partida do voo
+        sh->fSt.finished = sh->fSt.totalPassBoarded == sh->fSt.par.nPassengers;     // Determinar se todos os passageiros já embarcaram
+        stateWriteEnd (&sh->flightSeq);
+
+        if (semDown (semgid, sh->logMutex) == -1) {                                      /* enter log critical region */
+            perror ("error on the down operation for semaphore access (HT)");
+            exit (EXIT_FAILURE);
+        }
+        sh->fSt.st.hostessStat[gate] = READY_TO_FLIGHT;                             // Alterar estado da hospedeira
+        TRACE_HOSTESS (gate, sh->fSt.st.hostessStat[gate]); // Assinalar a transição de estado
+        snap = stateSnapshot (sh);
+        saveState(nFic, snap);                                                      // Guardar estados
+        saveFlightDeparted(nFic, snap);                                             // Indicar o começo do voo
+        leave[nops++] = (SEM_OP) { sh->logMutex, 1 };
+
+        stateWriteBegin (&sh->flightSeq);
+        leave[nops++] = (SEM_OP) { sh->readyToFlight[plane], 1 };                  // Autorizar piloto a descolar
+        sh->boarding = sh->fSt.finished ? false : sh->readyHead != sh->readyTail;  // Dar a vez ao próximo avião
+        if (sh->fSt.finished)
+            for (g = 0; g < sh->fSt.par.nHostesses; g++)
+                if (g != gate)
+                    leave[nops++] = (SEM_OP) { sh->readyForBoarding[g], 1 };         // Libertar as outras portas
+        while (sh->readyHead != sh->readyTail) {
+            leave[nops++] = (SEM_OP) { sh->boardingTurn[sh->planeReady[sh->readyHead]], 1 };
+            sh->readyHead = (sh->readyHead + 1) % MAXPT;
+            if (!sh->fSt.finished)
+                break;                                                              // Só o primeiro avião da fila
+        }
+    }
+    stateWriteEnd (&sh->flightSeq);
 
-    if (semUp (semgid, sh->mutex) == -1) {                                                     /* exit critical region */
+    if (semOpBatch (semgid, leave, nops) == -1) {            /* exit critical regions and authorize pilot to take off */
         perror ("error on the up operation for semaphore access (HT)");
         exit (EXIT_FAILURE);
     }
-
-    /* insert your code here */
-    semUp(semgid, sh->readyToFlight); // Autorizar piloto a descolar
 }
 
-
@@ -11,6 +11,11 @@
  *     \li waitInQueue
  *     \li waitUntilDestination
  *
+ *  The life cycle runs either as a process of its own or as a thread of the generator process.
+ *  As threads, the passengers may also be tasks multiplexed over a few worker threads: they block only in
+ *  critical regions, the other waits are carried out on their behalf by a waiter thread per kind and the
+ *  rest of the life cycle goes on as a continuation once the event they wait for has happened.
+ *
  *  \author Nuno Lau - January 2022
  */
 
@@ -21,6 +26,10 @@
 #include <sys/types.h>
 #include <string.h>
 #include <math.h>
+#ifdef THREAD_ENGINE
+#include <pthread.h>
+#include <time.h>
+#endif
 
 #include "probConst.h"
 #include "probDataStruct.h"
@@ -28,23 +37,110 @@
 #include "sharedDataSync.h"
 #include "semaphore.h"
 #include "sharedMemory.h"
+#include "semSharedMemEntities.h"
+#include "randomGen.h"
+#include "timeline.h"
+#include "trace.h"
 
 /** \brief logging file name */
 static char nFic[51];
 
-/** \brief shared memory block access identifier */
-static int shmid;
-
 /** \brief semaphore set access identifier */
 static int semgid;
 
 /** \brief pointer to shared memory region */
 static SHARED_DATA *sh;
 
+/** \brief base seed of the random generators of the passengers run as threads */
+static unsigned int baseSeed;
+
+/** \brief random generator of the passenger */
+static __thread RND_GEN rnd;
+
+#ifdef THREAD_ENGINE
+
+/* Steps of the life cycle of a passenger task, each one the continuation of a wait */
+
+/** \brief joining the queue, once at the airport */
+#define  TASK_JOIN            0
+/** \brief boarding, once called by a hostess */
+#define  TASK_BOARD           1
+/** \brief leaving the plane, once at the destination */
+#define  TASK_LEAVE           2
+
+/**
+ *  \brief Definition of <em>passenger task</em> data type.
+ */
+typedef struct
+{ /** \brief step to be carried out when the task runs */
+    unsigned int step;
+    /** \brief plane boarded */
+    unsigned int plane;
+    /** \brief time of arrival at the airport (us, monotonic clock) */
+    unsigned long long due;
+    /** \brief waiting for the event that makes it ready */
+    bool parked;
+    /** \brief the event happened before it waited for it (call by a hostess) */
+    bool woken;
+    /** \brief next task in the list it belongs to (ready or waiting for a plane to land), -1 if none */
+    int next;
+
+} PASSENGER_TASK;
+
+/**
+ *  \brief Definition of <em>list of tasks</em> data type.
+ */
+typedef struct
+{ /** \brief first and last task, -1 if empty */
+    int head, tail;
+
+} TASK_LIST;
+
+/** \brief scheduler of the passenger tasks: lists, counters and waits are protected by <tt>taskLock</tt> */
+static pthread_mutex_t taskLock = PTHREAD_MUTEX_INITIALIZER;
+
+/** \brief workers wait for a ready task or the next arrival at the airport */
+static pthread_cond_t workCond;
+
+/** \brief the queue waiter waits for the passengers to join the queue */
+static pthread_cond_t queueCond;
+
+/** \brief passenger tasks */
+static PASSENGER_TASK *task;
+
+/** \brief tasks in order of arrival at the airport, and the next one to arrive */
+static unsigned int *byDue;
+static unsigned int nextDue;
+
+/** \brief tasks ready to run */
+static TASK_LIST ready;
+
+/** \brief tasks waiting for each plane to land, and the landings no task was waiting for yet */
+static TASK_LIST flying[MAXPT];
+static unsigned int landed[MAXPT];
+
+/** \brief number of tasks that joined the queue and that reached the destination */
+static unsigned int nJoined, nDone;
+
+/** \brief worker, queue waiter and plane waiter threads */
+static pthread_t *taskThr;
+static unsigned int nTaskThr;
+
+#endif /* THREAD_ENGINE */
+
+static unsigned int travelTime (RND_GEN *g);
 static bool travelToAirport ();
-static void waitInQueue (unsigned int passengerId);
-static void waitUntilDestination (unsigned int passengerId);
-// static void leavePlane (unsigned int passengerId);
+static unsigned int waitInQueue (unsigned int passengerId);
+static void joinQueue (unsigned int passengerId);
+static unsigned int boardPlane (unsigned int passengerId);
+static void waitUntilDestination (unsigned int passengerId, unsigned int plane);
+static void leavePlane (unsigned int passengerId, unsigned int plane);
+static void lifeCycle (unsigned int passengerId, unsigned int seed);
+
+#ifndef THREAD_ENGINE
+
+/** \brief shared memory block access identifier */
+static int shmid;
 
 /**
  *  \brief Main program.
@@ -56,19 +152,20 @@ int main (int argc, char *argv[])
 {
     int key;                                                           /*access key to shared memory and semaphore set */
     char *tinp;                                                                      /* numerical parameters test flag */
+    unsigned int seed;                                                                    /* seed of random generator */
     int n;
 
     /* validation of command line parameters */
 
-    if (argc != 5) { 
+    if (argc != 6) { 
         freopen ("error_PG", "a", stderr);
         fprintf (stderr, "Number of parameters is incorrect!\n");
         return EXIT_FAILURE;
     }
-    else freopen (argv[4], "w", stderr);
+    else freopen (argv[5], "w", stderr);
 
     n = (unsigned int) strtol (argv[1], &tinp, 0);
-    if ((*tinp != '\0') || (n >= N)) { 
+    if (*tinp != '\0') { 
         fprintf (stderr, "Passenger process identification is wrong!\n");
         return EXIT_FAILURE;
     }
@@ -78,6 +175,11 @@ int main (int argc, char *argv[])
         fprintf (stderr, "Error on the access key communication!\n");
         return EXIT_FAILURE;
     }
+    seed = (unsigned int) strtoul (argv[4], &tinp, 0);
+    if (*tinp != '\0') {
+        fprintf (stderr, "Error on the seed communication!\n");
+        return EXIT_FAILURE;
+    }
 
     /* connection to the semaphore set and the shared memory region and mapping the shared region onto the
        process address space */
@@ -94,15 +196,18 @@ int main (int argc, char *argv[])
         perror ("error on mapping the shared region on the process address space");
         return EXIT_FAILURE;
     }
-
-    srandom ((unsigned int) getpid ());                                                 /* initialize random generator */
-
+    setLogBackend (sh->logBackend, &sh->logSh);                                         /* same backend as the others */
+    setLogDelta (logDelta (sh));                                                         /* same layout as the others */
+    semTimeout (sh->downTimeout);                                                    /* same time limit as the others */
+    timelineBind (timeline (sh));                                                      /* same timeline as the others */
+    if ((n < 0) || (n >= sh->fSt.par.nPassengers)) {                       /* validated against the shared dimensions */
+        fprintf (stderr, "Passenger process identification is wrong!\n");
+        return EXIT_FAILURE;
+    }
 
     /* simulation of the life cycle of the passenger */
 
-    travelToAirport();
-    waitInQueue(n);
-    waitUntilDestination(n);
+    lifeCycle(n, seed);
 
     /* unmapping the shared region off the process address space */
 
@@ -114,6 +219,380 @@ int main (int argc, char *argv[])
     return EXIT_SUCCESS;
 }
 
+#endif /* THREAD_ENGINE */
+
+/**
+ *  \brief Binding of the passengers to the resources of the generator process.
+ *
+ *  \param name logging file name
+ *  \param sgid semaphore set access identifier
+ *  \param shared pointer to shared memory region
+ *  \param seed base seed of the random generators
+ */
+
+void passengerBind (char name[], int sgid, SHARED_DATA *shared, unsigned int seed)
+{
+    baseSeed = seed;
+    strcpy (nFic, name);
+    semgid = sgid;
+    sh = shared;
+}
+
+/**
+ *  \brief Life cycle of a passenger as a thread of the generator process.
+ *
+ *  \param arg passenger id, cast to a pointer
+ *
+ *  \return \c NULL
+ */
+
+void *passengerThread (void *arg)
+{
+    unsigned int id = (unsigned int) (unsigned long) arg;
+
+    lifeCycle(id, rndSeed (baseSeed, RND_PASSENGER, id));
+    return NULL;
+}
+
+#ifdef THREAD_ENGINE
+
+/**
+ *  \brief Monotonic clock.
+ *
+ *  \return time (us)
+ */
+
+static unsigned long long taskClock (void)
+{
+    struct timespec t;
+
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return (unsigned long long) t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
+
+/**
+ *  \brief Ordering of the tasks by time of arrival at the airport.
+ */
+
+static int byArrival (const void *a, const void *b)
+{
+    unsigned long long da = task[*(const unsigned int *) a].due,
+                       db = task[*(const unsigned int *) b].due;
+
+    return (da > db) - (da < db);
+}
+
+/**
+ *  \brief Appending a task to a list (inside the scheduler lock).
+ *
+ *  \param l list
+ *  \param t task
+ */
+
+static void taskPush (TASK_LIST *l, unsigned int t)
+{
+    task[t].next = -1;
+    if (l->tail == -1) {
+        l->head = (int) t;
+    }
+    else task[l->tail].next = (int) t;
+    l->tail = (int) t;
+}
+
+/**
+ *  \brief Removing the first task of a list (inside the scheduler lock).
+ *
+ *  \param l list
+ *
+ *  \return task, -1 if the list is empty
+ */
+
+static int taskPop (TASK_LIST *l)
+{
+    int t = l->head;
+
+    if (t != -1) {
+        if ((l->head = task[t].next) == -1) {
+            l->tail = -1;
+        }
+    }
+    return t;
+}
+
+/**
+ *  \brief Making a task ready to run (inside the scheduler lock).
+ *
+ *  \param t task
+ */
+
+static void taskReady (unsigned int t)
+{
+    taskPush (&ready, t);
+    pthread_cond_signal (&workCond);
+}
+
+/**
+ *  \brief Carrying out the step of a task, up to its next wait.
+ *
+ *  \param t task, it is the passenger id
+ */
+
+static void taskRun (unsigned int t)
+{
+    PASSENGER_TASK *k = &task[t];
+    unsigned int g;
+
+    switch (k->step) {
+        case TASK_JOIN:
+            joinQueue (t);
+            pthread_mutex_lock (&taskLock);
+            k->step = TASK_BOARD;
+            nJoined++;
+            pthread_cond_signal (&queueCond);
+            if (k->woken) {                                                      /* called before the task was parked */
+                taskReady (t);
+            }
+            else k->parked = true;
+            pthread_mutex_unlock (&taskLock);
+            break;
+        case TASK_BOARD:
+            k->plane = boardPlane (t);
+            pthread_mutex_lock (&taskLock);
+            k->step = TASK_LEAVE;
+            if (landed[k->plane] > 0) {                                    /* the plane landed before the task waited */
+                landed[k->plane]--;
+                taskReady (t);
+            }
+            else taskPush (&flying[k->plane], t);
+            pthread_mutex_unlock (&taskLock);
+            break;
+        case TASK_LEAVE:
+            leavePlane (t, k->plane);
+            pthread_mutex_lock (&taskLock);
+            if (++nDone == sh->fSt.par.nPassengers) {                           /* every worker and waiter terminates */
+                pthread_cond_broadcast (&workCond);
+                for (g = 0; g < sh->fSt.par.nPilots; g++) {
+                    semUp (semgid, sh->passengersWaitInFlight[g]);
+                }
+            }
+            pthread_mutex_unlock (&taskLock);
+            break;
+    }
+}
+
+/**
+ *  \brief Life cycle of a worker: running ready tasks and the ones arriving at the airport.
+ *
+ *  \param arg not used
+ *
+ *  \return \c NULL
+ */
+
+static void *taskWorker (void *arg)
+{
+    unsigned int n = sh->fSt.par.nPassengers;
+    unsigned long long t;
+    struct timespec until;
+    int k;
+
+    semInstrument (latencyStats (sh), LAT_PASSENGER);                         /* timing of the synchronization points */
+    pthread_mutex_lock (&taskLock);
+    while (nDone < n) {
+        if ((k = taskPop (&ready)) != -1) {
+            pthread_mutex_unlock (&taskLock);
+            taskRun ((unsigned int) k);
+            pthread_mutex_lock (&taskLock);
+        }
+        else if ((nextDue < n) && (task[byDue[nextDue]].due <= (t = taskClock ()))) {
+            taskPush (&ready, byDue[nextDue++]);                                            /* arrived at the airport */
+        }
+        else if (nextDue < n) {
+            t = task[byDue[nextDue]].due;
+            until.tv_sec = t / 1000000;
+            until.tv_nsec = (t % 1000000) * 1000;
+            pthread_cond_timedwait (&workCond, &taskLock, &until);
+        }
+        else pthread_cond_wait (&workCond, &taskLock);
+    }
+    pthread_mutex_unlock (&taskLock);
+    return NULL;
+}
+
+/**
+ *  \brief Life cycle of the queue waiter: waiting for the call of every passenger, in queue order.
+ *
+ *  The hostesses call the passengers in queue order, so a passenger called out of order only waits until the
+ *  ones ahead of him, already claimed by a gate, are called.
+ *
+ *  \param arg not used
+ *
+ *  \return \c NULL
+ */
+
+static void *taskQueueWaiter (void *arg)
+{
+    unsigned int n = sh->fSt.par.nPassengers;
+    unsigned int q, t;
+
+    semInstrument (latencyStats (sh), LAT_PASSENGER);                         /* timing of the synchronization points */
+    for (q = 0; q < n; q++) {
+        pthread_mutex_lock (&taskLock);
+        while (nJoined <= q) {                                  /* the position is set once as many passengers joined */
+            pthread_cond_wait (&queueCond, &taskLock);
+        }
+        pthread_mutex_unlock (&taskLock);
+        t = passengerQueue (sh)[q];
+
+        /* insert your code here */
+        if (semDown(semgid, sh->passengerCalled + t) == -1) { // Esperar que uma hospedeira o chame
+            perror ("error on the down operation for semaphore access (PG)");
+            exit (EXIT_FAILURE);
+        }
+
+        pthread_mutex_lock (&taskLock);
+        if (task[t].parked) {
+            task[t].parked = false;
+            taskReady (t);
+        }
+        else task[t].woken = true;
+        pthread_mutex_unlock (&taskLock);
+    }
+    return NULL;
+}
+
+/**
+ *  \brief Life cycle of a plane waiter: waiting for the passengers of the plane to be allowed to leave it.
+ *
+ *  \param arg plane, cast to a pointer
+ *
+ *  \return \c NULL
+ */
+
+static void *taskPlaneWaiter (void *arg)
+{
+    unsigned int plane = (unsigned int) (unsigned long) arg;
+    int t;
+
+    semInstrument (latencyStats (sh), LAT_PASSENGER);                         /* timing of the synchronization points */
+    while (true) {
+        /* insert your code here */
+        if (semDown(semgid, sh->passengersWaitInFlight[plane]) == -1) { // Esperar autorização para desembarcar
+            perror ("error on the down operation for semaphore access (PG)");
+            exit (EXIT_FAILURE);
+        }
+
+        pthread_mutex_lock (&taskLock);
+        if (nDone == sh->fSt.par.nPassengers) {
+            pthread_mutex_unlock (&taskLock);
+            break;
+        }
+        if ((t = taskPop (&flying[plane])) != -1) {
+            taskReady ((unsigned int) t);
+        }
+        else landed[plane]++;
+        pthread_mutex_unlock (&taskLock);
+    }
+    return NULL;
+}
+
+/**
+ *  \brief Generation of the passengers as tasks multiplexed over a pool of worker threads.
+ *
+ *  Every passenger draws the time it takes to reach the airport from its own generator, as a thread would.
+ *  Besides the workers, there are a queue waiter thread and a waiter thread per plane.
+ *  The passengers must be bound first.
+ *
+ *  \param nWorkers number of worker threads
+ */
+
+void passengerTasksStart (unsigned int nWorkers)
+{
+    unsigned int n = sh->fSt.par.nPassengers;
+    unsigned long long t0 = taskClock ();
+    pthread_condattr_t cattr;
+    pthread_attr_t attr;
+    RND_GEN g;
+    unsigned int p, w;
+
+    nTaskThr = nWorkers + 1 + sh->fSt.par.nPilots;
+    if (((task = malloc (n * sizeof (PASSENGER_TASK))) == NULL) ||
+        ((byDue = malloc (n * sizeof (unsigned int))) == NULL) ||
+        ((taskThr = malloc (nTaskThr * sizeof (pthread_t))) == NULL)) {
+        perror ("error on allocating the passenger tasks");
+        exit (EXIT_FAILURE);
+    }
+    for (p = 0; p < n; p++) {
+        rndInit (&g, rndSeed (baseSeed, RND_PASSENGER, p));
+        task[p].step = TASK_JOIN;
+        task[p].due = t0 + travelTime (&g);
+        task[p].parked = task[p].woken = false;
+        byDue[p] = p;
+    }
+    qsort (byDue, n, sizeof (unsigned int), byArrival);
+    nextDue = nJoined = nDone = 0;
+    ready.head = ready.tail = -1;
+    for (p = 0; p < MAXPT; p++) {
+        flying[p].head = flying[p].tail = -1;
+        landed[p] = 0;
+    }
+    pthread_condattr_init (&cattr);
+    pthread_condattr_setclock (&cattr, CLOCK_MONOTONIC);
+    pthread_cond_init (&workCond, &cattr);
+    pthread_cond_init (&queueCond, NULL);
+    pthread_condattr_destroy (&cattr);
+
+    pthread_attr_init (&attr);
+    pthread_attr_setstacksize (&attr, 128 * 1024);
+    for (w = 0; w < nTaskThr; w++) {
+        if (pthread_create (&taskThr[w], &attr, (w < nWorkers) ? taskWorker : (w == nWorkers) ? taskQueueWaiter :
+                            taskPlaneWaiter, (void *) (unsigned long) (w - nWorkers - 1)) != 0) {
+            fprintf (stderr, "error on the generation of the passenger task threads\n");
+            exit (EXIT_FAILURE);
+        }
+    }
+    pthread_attr_destroy (&attr);
+}
+
+/**
+ *  \brief Waiting for every passenger task to reach the destination.
+ */
+
+void passengerTasksJoin (void)
+{
+    unsigned int w;
+
+    for (w = 0; w < nTaskThr; w++) {
+        pthread_join (taskThr[w], NULL);
+    }
+    pthread_cond_destroy (&workCond);
+    pthread_cond_destroy (&queueCond);
+    free (taskThr);
+    free (byDue);
+    free (task);
+}
+
+#endif /* THREAD_ENGINE */
+
+/**
+ *  \brief life cycle of a passenger
+ *
+ *  \param passengerId passenger id
+ *  \param seed seed of the random generator
+ */
+static void lifeCycle (unsigned int passengerId, unsigned int seed)
+{
+    unsigned int plane;
+
+    rndInit (&rnd, seed);                                                              /* initialize random generator */
+    semInstrument (latencyStats (sh), LAT_PASSENGER);                         /* timing of the synchronization points */
+    simClockBind (simClock (sh), semgid, passengerId);                                    /* sleeping in virtual time */
+
+    travelToAirport();
+    plane = waitInQueue(passengerId);
+    waitUntilDestination(passengerId, plane);
+    simExit ();
+}
+
 
 /**
  *  \brief passenger goes to airport
@@ -123,60 +602,127 @@ int main (int argc, char *argv[])
 
 static bool travelToAirport ()
 {
-    usleep((unsigned int) floor ((MAXTRAVEL * random ()) / RAND_MAX + 1000));
+    simSleep(travelTime (&rnd));
 
     return true;
 }
 
+/**
+ *  \brief Time taken by a passenger to reach the airport.
+ *
+ *  \param g random generator of the passenger
+ *
+ *  \return time (us)
+ */
+
+static unsigned int travelTime (RND_GEN *g)
+{
+    return (unsigned int) floor ((MAXTRAVEL * rndNext (g)) / RAND_MAX + 1000);
+}
+
 /**
  *  \brief wait for its turn to be checked by hostess
  *
- *  Passenger should update number of passenger in queue, and inform hostess that he is ready for boarding
- *  after being acknowledged by hostess passenger should provide its id to hostess and giver her permission to read the id
+ *  Passenger should update number of passenger in queue, join the queue and inform hostess that he is ready for
+ *  boarding, then wait until a hostess calls him by his id
  *  The internal state should be saved twice.
  *
  *  \param passengerId passenger id
+ *
+ *  \return plane boarded by the passenger
  */
 
-static void waitInQueue (unsigned int passengerId)
+static unsigned int waitInQueue (unsigned int passengerId)
 {
-    if (semDown (semgid, sh->mutex) == -1) {                                                  /* enter critical region */
+    joinQueue (passengerId);
+
+    /* insert your code here */
+    if (semDown(semgid, sh->passengerCalled + passengerId) == -1) { // Esperar que uma hospedeira o chame
+        perror ("error on the down operation for semaphore access (PG)");
+        exit (EXIT_FAILURE);
+    }
+
+    return boardPlane (passengerId);
+}
+
+/**
+ *  \brief passenger joins the queue
+ *
+ *  Passenger should update number of passenger in queue, join the queue and inform hostess that he is ready for
+ *  boarding.
+ *  The internal state should be saved.
+ *
+ *  \param passengerId passenger id
+ */
+
+static void joinQueue (unsigned int passengerId)
+{
+    SEM_OP inQueue[] = { { sh->logMutex, 1 }, { sh->passengersInQueue, 1 } };
+
+    if (semDown (semgid, sh->queueMutex) == -1) {                                      /* enter queue critical region */
         perror ("error on the down operation for semaphore access (PG)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    sh->fSt.st.passengerStat[passengerId] = IN_QUEUE; // Alterar estado do passageiro
+    stateWriteBegin (&sh->queueSeq);
+    passengerStat(&sh->fSt)[passengerId] = IN_QUEUE; // Alterar estado do passageiro
+    TRACE_PASSENGER (passengerId, passengerStat(&sh->fSt)[passengerId]); // Assinalar a transição de estado
     sh->fSt.nPassInQueue++;                           // Incrementar nr de passageiros na fila
-    saveState(nFic, &(sh->fSt));                      // Guardar estados
+    passengerQueue(sh)[sh->queueTail++] = passengerId; // Entrar na fila por ordem de chegada
+    timelineEvent (TL_QUEUE, 0, -1, passengerId);      // Registar a entrada na fila
+    stateWriteEnd (&sh->queueSeq);
 
-    if (semUp (semgid, sh->mutex) == -1)                                                      /* exit critical region */
-    {
+    if (semUp (semgid, sh->queueMutex) == -1) {                                         /* exit queue critical region */
         perror ("error on the up operation for semaphore access (PG)");
         exit (EXIT_FAILURE);
     }
+    if (semDown (semgid, sh->logMutex) == -1) {                                          /* enter log critical region */
+        perror ("error on the down operation for semaphore access (PG)");
+        exit (EXIT_FAILURE);
+    }
 
     /* insert your code here */
-    semUp(semgid, sh->passengersInQueue);       // Avisar hospedeira que passageiro está à espera na fila
-    semDown(semgid, sh->passengersWaitInQueue); // Esperar autorização da hospedeira para sair da fila
+    saveState(nFic, stateSnapshot (sh));              // Guardar estados
+
+    if (semOpBatch (semgid, inQueue, 2) == -1)     /* exit log critical region and tell hostess passenger is in queue */
+    {
+        perror ("error on the up operation for semaphore access (PG)");
+        exit (EXIT_FAILURE);
+    }
+}
 
-    if (semDown (semgid, sh->mutex) == -1) {                                                  /* enter critical region */
+/**
+ *  \brief passenger called by a hostess boards the plane
+ *
+ *  The internal state should be saved.
+ *
+ *  \param passengerId passenger id
+ *
+ *  \return plane boarded by the passenger
+ */
+
+static unsigned int boardPlane (unsigned int passengerId)
+{
+    unsigned int plane;
+
+    if (semDown (semgid, sh->logMutex) == -1) {                                          /* enter log critical region */
         perror ("error on the down operation for semaphore access (PG)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    sh->fSt.st.passengerStat[passengerId] = IN_FLIGHT; // Alterar estado do passageiro 
-    sh->fSt.passengerChecked = passengerId;            // Guardar ID do passageiro
-    saveState(nFic, &(sh->fSt));                       // Guardar estados
+    passengerStat(&sh->fSt)[passengerId] = IN_FLIGHT; // Alterar estado do passageiro 
+    TRACE_PASSENGER (passengerId, passengerStat(&sh->fSt)[passengerId]); // Assinalar a transição de estado
+    plane = passengerPlane(sh)[passengerId];           // Avião em que embarcou
+    saveState(nFic, stateSnapshot (sh));               // Guardar estados
 
-    if (semUp (semgid, sh->mutex) == -1) {                                                    /* exit critical region */
+    if (semUp (semgid, sh->logMutex) == -1) {                                             /* exit log critical region */
         perror ("error on the up operation for semaphore access (PG)");
         exit (EXIT_FAILURE);
     }
 
-    /* insert your code here */
-    semUp(semgid, sh->idShown); // Autorizar a hospedeira a ler o ID
+    return plane;
 }
 
 /**
@@ -188,27 +734,52 @@ static void waitInQueue (unsigned int passengerId)
  *  The internal state should be saved.
  *
  *  \param passengerId passenger id
+ *  \param plane plane boarded by the passenger
  */
 
-static void waitUntilDestination (unsigned int passengerId)
+static void waitUntilDestination (unsigned int passengerId, unsigned int plane)
 {
     /* insert your code here */
-    semDown(semgid, sh->passengersWaitInFlight); // Esperar autorização do piloto para desembarcar
-
-    if (semDown (semgid, sh->mutex) == -1) {                                                  /* enter critical region */
+    if (semDown(semgid, sh->passengersWaitInFlight[plane]) == -1) { // Esperar autorização do piloto para desembarcar
         perror ("error on the down operation for semaphore access (PG)");
         exit (EXIT_FAILURE);
     }
 
-    /* insert your code here */
-    sh->fSt.st.passengerStat[passengerId] = AT_DESTINATION; // Alterar estado do passageiro
-    sh->fSt.nPassInFlight--;                                // Decrementar nr de passageiros no voo
-    saveState(nFic, &(sh->fSt));                            // Guardar estados
+    leavePlane (passengerId, plane);
+}
 
-    if (sh->fSt.nPassInFlight == 0)
-        semUp(semgid, sh->planeEmpty); // Informar piloto que o avião está vazio
+/**
+ *  \brief passenger leaves the plane at the destination
+ *
+ *  Passenger should update the number of passengers in flight and arrive at destination.
+ *  last passenger must inform pilot that plane is empty.
+ *  The internal state should be saved.
+ *  The passengers leaving a plane do not enter the flight critical region, the counters are updated atomically.
+ *
+ *  \param passengerId passenger id
+ *  \param plane plane boarded by the passenger
+ */
 
-    if (semUp (semgid, sh->mutex) == -1) {                                                    /* exit critical region */
+static void leavePlane (unsigned int passengerId, unsigned int plane)
+{
+    SEM_OP leave[] = { { sh->logMutex, 1 }, { sh->planeEmpty[plane], 1 } };
+    bool last;
+
+    if (semDown (semgid, sh->logMutex) == -1) {                                          /* enter log critical region */
+        perror ("error on the down operation for semaphore access (PG)");
+        exit (EXIT_FAILURE);
+    }
+
+    /* insert your code here */
+    passengerStat(&sh->fSt)[passengerId] = AT_DESTINATION;             // Alterar estado do passageiro
+    TRACE_PASSENGER (passengerId, passengerStat(&sh->fSt)[passengerId]); // Assinalar a transição de estado
+    __atomic_sub_fetch (&sh->fSt.nPassInFlight, 1, __ATOMIC_RELAXED);   // Decrementar nr de passageiros no voo
+    last = __atomic_sub_fetch (&sh->fSt.planePass[plane], 1, __ATOMIC_RELAXED) == 0; // Último a sair informa o piloto que o avião está vazio
+    saveState(nFic, stateSnapshot (sh));                                // Guardar estados
+    if (last)
+        timelineEvent (TL_EMPTY, sh->fSt.planeFlight[plane], plane, -1); // Registar que o avião ficou vazio
+
+    if (semOpBatch (semgid, leave, last ? 2 : 1) == -1) {                                 /* exit log critical region */
         perror ("error on the up operation for semaphore access (PG)");
         exit (EXIT_FAILURE);
     }
@@ -6,12 +6,14 @@
  *  Synchronization based on semaphores and shared memory.
  *  Implementation with SVIPC.
  *
- *  Definition of the operations carried out by the pilot:
+ *  Definition of the operations carried out by each pilot, one per plane:
  *     \li flight
  *     \li signalReadyForBoarding
  *     \li waitUntilReadyToFlight
  *     \li dropPassengersAtTarget
  *
+ *  The life cycle runs either as a process of its own or as a thread of the generator process.
+ *
  *  \author Nuno Lau - January 2022
  */
 
@@ -32,25 +34,39 @@
 #include "sharedDataSync.h"
 #include "semaphore.h"
 #include "sharedMemory.h"
+#include "semSharedMemEntities.h"
+#include "randomGen.h"
+#include "timeline.h"
+#include "trace.h"
 
 
 /** \brief logging file name */
 static char nFic[51];
 
-/** \brief shared memory block access identifier */
-static int shmid;
-
 /** \brief semaphore set access identifier */
 static int semgid;
 
 /** \brief pointer to shared memory region */
 static SHARED_DATA *sh;
 
-static void flight (bool go);
-static void signalReadyForBoarding ();
-static void waitUntilReadyToFlight ();
-static void dropPassengersAtTarget ();
+/** \brief base seed of the random generators of the pilots run as threads */
+static unsigned int baseSeed;
+
+/** \brief random generator of the pilot */
+static __thread RND_GEN rnd;
+
+static void flight (unsigned int plane, bool go);
+static unsigned int startBoarding (unsigned int plane, SEM_OP leave[]);
+static bool signalReadyForBoarding (unsigned int plane);
+static void waitUntilReadyToFlight (unsigned int plane);
+static void dropPassengersAtTarget (unsigned int plane);
 static bool isFinished ();
+static void lifeCycle (unsigned int plane, unsigned int seed);
+
+#ifndef THREAD_ENGINE
+
+/** \brief shared memory block access identifier */
+static int shmid;
 
 /**
  *  \brief Main program.
@@ -62,21 +78,33 @@ int main (int argc, char *argv[])
 {
     int key;                                                           /*access key to shared memory and semaphore set */
     char *tinp;                                                                      /* numerical parameters test flag */
+    unsigned int seed;                                                                    /* seed of random generator */
+    int p;
 
     /* validation of command line parameters */
 
-    if (argc != 4) { 
+    if (argc != 6) { 
         freopen ("error_PT", "a", stderr);
         fprintf (stderr, "Number of parameters is incorrect!\n");
         return EXIT_FAILURE;
     }
-    else freopen (argv[3], "w", stderr);
-    strcpy (nFic, argv[1]);
-    key = (unsigned int) strtol (argv[2], &tinp, 0);
+    else freopen (argv[5], "w", stderr);
+    p = (unsigned int) strtol (argv[1], &tinp, 0);
+    if (*tinp != '\0') { 
+        fprintf (stderr, "Pilot process identification is wrong!\n");
+        return EXIT_FAILURE;
+    }
+    strcpy (nFic, argv[2]);
+    key = (unsigned int) strtol (argv[3], &tinp, 0);
     if (*tinp != '\0') {
         fprintf (stderr, "Error on the access key communication!\n");
         return EXIT_FAILURE;
     }
+    seed = (unsigned int) strtoul (argv[4], &tinp, 0);
+    if (*tinp != '\0') {
+        fprintf (stderr, "Error on the seed communication!\n");
+        return EXIT_FAILURE;
+    }
 
     /* connection to the semaphore set and the shared memory region and mapping the shared region onto the
        process address space */
@@ -93,18 +121,18 @@ int main (int argc, char *argv[])
         perror ("error on mapping the shared region on the process address space");
         return EXIT_FAILURE;
     }
-
-    srandom ((unsigned int) getpid ());                                                 /* initialize random generator */
+    setLogBackend (sh->logBackend, &sh->logSh);                                         /* same backend as the others */
+    setLogDelta (logDelta (sh));                                                         /* same layout as the others */
+    semTimeout (sh->downTimeout);                                                    /* same time limit as the others */
+    timelineBind (timeline (sh));                                                      /* same timeline as the others */
+    if ((p < 0) || (p >= sh->fSt.par.nPilots)) {                           /* validated against the shared dimensions */
+        fprintf (stderr, "Pilot process identification is wrong!\n");
+        return EXIT_FAILURE;
+    }
 
     /* simulation of the life cycle of the pilot */
 
-    while(!isFinished()) {
-        flight(false); // from target to origin
-        signalReadyForBoarding();
-        waitUntilReadyToFlight();
-        flight(true); // from origin to target
-        dropPassengersAtTarget();
-    }
+    lifeCycle(p, seed);
 
     /* unmapping the shared region off the process address space */
 
@@ -116,6 +144,63 @@ int main (int argc, char *argv[])
     return EXIT_SUCCESS;
 }
 
+#endif /* THREAD_ENGINE */
+
+/**
+ *  \brief Binding of the pilots to the resources of the generator process.
+ *
+ *  \param name logging file name
+ *  \param sgid semaphore set access identifier
+ *  \param shared pointer to shared memory region
+ *  \param seed base seed of the random generators
+ */
+
+void pilotBind (char name[], int sgid, SHARED_DATA *shared, unsigned int seed)
+{
+    baseSeed = seed;
+    strcpy (nFic, name);
+    semgid = sgid;
+    sh = shared;
+}
+
+/**
+ *  \brief Life cycle of a pilot as a thread of the generator process.
+ *
+ *  \param arg plane flown by the pilot, cast to a pointer
+ *
+ *  \return \c NULL
+ */
+
+void *pilotThread (void *arg)
+{
+    unsigned int id = (unsigned int) (unsigned long) arg;
+
+    lifeCycle(id, rndSeed (baseSeed, RND_PILOT, id));
+    return NULL;
+}
+/**
+ *  \brief life cycle of the pilot
+ *
+ *  \param plane plane flown by the pilot
+ *  \param seed seed of the random generator
+ */
+static void lifeCycle (unsigned int plane, unsigned int seed)
+{
+    rndInit (&rnd, seed);                                                              /* initialize random generator */
+    semInstrument (latencyStats (sh), LAT_PILOT);                             /* timing of the synchronization points */
+    simClockBind (simClock (sh), semgid, sh->fSt.par.nPassengers + plane);                /* sleeping in virtual time */
+
+    while(!isFinished()) {
+        flight(plane, false); // from target to origin
+        if (!signalReadyForBoarding(plane))
+            break;            // the other planes carried the remaining passengers
+        waitUntilReadyToFlight(plane);
+        flight(plane, true); // from origin to target
+        dropPassengersAtTarget(plane);
+    }
+    simExit ();
+}
+
 /**
  *  \brief test if air lift finished
  */
@@ -131,56 +216,151 @@ static bool isFinished ()
  *  plane back to starting airport (return)
  *  state should be saved.
  *
+ *  \param plane plane flown by the pilot
  *  \param go true if going to destination
  */
 
-static void flight (bool go)
+static void flight (unsigned int plane, bool go)
 {
-    if (semDown (semgid, sh->mutex) == -1) {                                                      /* enter critical region */
+    if (semDown (semgid, sh->logMutex) == -1) {                                          /* enter log critical region */
         perror ("error on the down operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    sh->fSt.st.pilotStat = (go) ? FLYING : FLYING_BACK; // Alterar estado do piloto
-    saveState(nFic, &(sh->fSt));                        // Guardar estados
+    sh->fSt.st.pilotStat[plane] = (go) ? FLYING : FLYING_BACK; // Alterar estado do piloto
+    TRACE_PILOT (plane, sh->fSt.st.pilotStat[plane]); // Assinalar a transição de estado
+    saveState(nFic, stateSnapshot (sh));                       // Guardar estados
 
-    if (semUp (semgid, sh->mutex) == -1) {                                                      /* exit critical region */
+    if (semUp (semgid, sh->logMutex) == -1) {                                             /* exit log critical region */
         perror ("error on the up operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
     }
 
-    usleep((unsigned int) floor ((MAXFLIGHT * random ()) / RAND_MAX + 100.0));
+    simSleep((unsigned int) floor ((MAXFLIGHT * rndNext (&rnd)) / RAND_MAX + 100.0));
+}
+
+/**
+ *  \brief start of boarding of a plane.
+ *
+ *  Must be called in the flight and log critical regions, by the pilot whose turn to board has come.
+ *  The flight number is updated and every boarding gate is opened.
+ *
+ *  \param plane plane to be boarded
+ *  \param leave operations to exit the flight and log critical regions, the gates are appended to them
+ *
+ *  \return number of operations in <tt>leave</tt>
+ */
+
+static unsigned int startBoarding (unsigned int plane, SEM_OP leave[])
+{
+    FULL_STAT *snap;                                                                         /* snapshot of the state */
+    unsigned int g;
+
+    stateWriteBegin (&sh->flightSeq);
+    sh->fSt.nFlight++;                         // Incrementar nr do voo
+    sh->fSt.boardingPlane = plane;             // Avião em embarque
+    sh->fSt.planeFlight[plane] = sh->fSt.nFlight;
+    timelineEvent (TL_BOARDING, sh->fSt.nFlight, plane, -1); // Registar o começo do embarque
+    sh->nGatesOpen = sh->fSt.par.nHostesses;   // Abrir todas as portas de embarque
+    sh->boardingClosed = false;
+    for (g = 0; g < sh->fSt.par.nHostesses; g++) {
+        sh->gateOpen[g] = true;
+        leave[g+2] = (SEM_OP) { sh->readyForBoarding[g], 1 };
+    }
+    stateWriteEnd (&sh->flightSeq);
+    snap = stateSnapshot (sh);
+    saveState(nFic, snap);                     // Guardar estados
+    saveStartBoarding(nFic, snap);             // Indicar o começo do embarque
+
+    return sh->fSt.par.nHostesses + 2;
 }
 
 /**
  *  \brief pilot informs hostess that plane is ready for boarding
  *
- *  The pilot updates its state and signals the hostess that boarding may start
+ *  The pilot updates its state, opens every boarding gate and signals the hostesses that boarding may start
+ *  If another plane is being boarded, the pilot waits for its turn first, planes board in arrival order.
  *  The flight number should be updated.
  *  The internal state should be saved.
+ *
+ *  \param plane plane flown by the pilot
+ *
+ *  \return true if boarding started (false if the airlift finished meanwhile)
  */
 
-static void signalReadyForBoarding ()
+static bool signalReadyForBoarding (unsigned int plane)
 {
-    if (semDown (semgid, sh->mutex) == -1) {                                                      /* enter critical region */
+    SEM_OP leave[MAXHT+2] = { { sh->mutex, 1 }, { sh->logMutex, 1 } };
+    unsigned int nops = 1;
+    bool finished, turn;
+
+    if (semDown (semgid, sh->mutex) == -1) {                                          /* enter flight critical region */
         perror ("error on the down operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    sh->fSt.st.pilotStat = READY_FOR_BOARDING; // Alterar estado do piloto
-    sh->fSt.nFlight++;                         // Incrementar nr do voo
-    saveState(nFic, &(sh->fSt));               // Guardar estados
-    saveStartBoarding(nFic, &(sh->fSt));       // Indicar o começo do embarque
+    finished = sh->fSt.finished;
+    turn = !finished && !sh->boarding;                  // Área de embarque livre
+    if (!finished) {
+        stateWriteBegin (&sh->flightSeq);
+        if (turn)
+            sh->boarding = true;
+        else {
+            sh->planeReady[sh->readyTail] = plane;       // Esperar pela vez na fila de aviões
+            sh->readyTail = (sh->readyTail + 1) % MAXPT;
+        }
+        stateWriteEnd (&sh->flightSeq);
+        if (semDown (semgid, sh->logMutex) == -1) {                                      /* enter log critical region */
+            perror ("error on the down operation for semaphore access (PT)");
+            exit (EXIT_FAILURE);
+        }
+        sh->fSt.st.pilotStat[plane] = READY_FOR_BOARDING; // Alterar estado do piloto
+        TRACE_PILOT (plane, sh->fSt.st.pilotStat[plane]); // Assinalar a transição de estado
+        if (turn)
+            nops = startBoarding(plane, leave);
+        else {
+            saveState(nFic, stateSnapshot (sh));         // Guardar estados
+            nops = 2;
+        }
+    }
 
-    if (semUp (semgid, sh->mutex) == -1) {                                                      /* exit critical region */
+    if (semOpBatch (semgid, leave, nops) == -1) {  /* exit critical regions and authorize hostesses to start boarding */
         perror ("error on the up operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
     }
+    if (finished || turn)
+        return !finished;
+
+    /* insert your code here */
+    if (semDown(semgid, sh->boardingTurn[plane]) == -1) { // Esperar que o avião anterior descole
+        perror ("error on the down operation for semaphore access (PT)");
+        exit (EXIT_FAILURE);
+    }
+
+    if (semDown (semgid, sh->mutex) == -1) {                                          /* enter flight critical region */
+        perror ("error on the down operation for semaphore access (PT)");
+        exit (EXIT_FAILURE);
+    }
 
     /* insert your code here */
-    semUp(semgid, sh->readyForBoarding); // Autorizar hospedeira para começar o embarque
+    finished = sh->fSt.finished;                 // A vez também é dada quando o transporte termina
+    nops = 1;
+    if (!finished) {
+        if (semDown (semgid, sh->logMutex) == -1) {                                      /* enter log critical region */
+            perror ("error on the down operation for semaphore access (PT)");
+            exit (EXIT_FAILURE);
+        }
+        nops = startBoarding(plane, leave);
+    }
+
+    if (semOpBatch (semgid, leave, nops) == -1) {  /* exit critical regions and authorize hostesses to start boarding */
+        perror ("error on the up operation for semaphore access (PT)");
+        exit (EXIT_FAILURE);
+    }
+
+    return !finished;
 }
 
 /**
@@ -188,26 +368,32 @@ static void signalReadyForBoarding ()
  *
  *  The pilot updates its state and wait for Boarding to finish 
  *  The internal state should be saved.
+ *
+ *  \param plane plane flown by the pilot
  */
 
-static void waitUntilReadyToFlight ()
+static void waitUntilReadyToFlight (unsigned int plane)
 {
-    if (semDown (semgid, sh->mutex) == -1) {                                                      /* enter critical region */
+    if (semDown (semgid, sh->logMutex) == -1) {                                          /* enter log critical region */
         perror ("error on the down operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    sh->fSt.st.pilotStat = WAITING_FOR_BOARDING; // Alterar estado do piloto
-    saveState(nFic, &(sh->fSt));                 // Guardar estados
+    sh->fSt.st.pilotStat[plane] = WAITING_FOR_BOARDING; // Alterar estado do piloto
+    TRACE_PILOT (plane, sh->fSt.st.pilotStat[plane]); // Assinalar a transição de estado
+    saveState(nFic, stateSnapshot (sh));                // Guardar estados
 
-    if (semUp (semgid, sh->mutex) == -1) {                                                      /* exit critical region */
+    if (semUp (semgid, sh->logMutex) == -1) {                                             /* exit log critical region */
         perror ("error on the up operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    semDown(semgid, sh->readyToFlight); // Esperar pela hospedeira terminar o embarque
+    if (semDown(semgid, sh->readyToFlight[plane]) == -1) { // Esperar pela hospedeira terminar o embarque
+        perror ("error on the down operation for semaphore access (PT)");
+        exit (EXIT_FAILURE);
+    }
 }
 
 /**
@@ -216,41 +402,63 @@ static void waitUntilReadyToFlight ()
  *  Pilot update its state and allows passengers to leave plane
  *  Pilot must wait for all passengers to leave plane before starting to return.
  *  The internal state should not be saved twice (after allowing passengeres to leave and after the plane is empty).
+ *
+ *  \param plane plane flown by the pilot
  */
 
-static void dropPassengersAtTarget ()
+static void dropPassengersAtTarget (unsigned int plane)
 {
-    if (semDown (semgid, sh->mutex) == -1) {                                                  /* enter critical region */
+    SEM_OP leave[] = { { sh->logMutex, 1 }, { sh->mutex, 1 } };
+    FULL_STAT *snap;                                                                         /* snapshot of the state */
+
+    if ((semDown (semgid, sh->mutex) == -1) ||                               /* enter flight and log critical regions */
+        (semDown (semgid, sh->logMutex) == -1)) {
         perror ("error on the down operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    sh->fSt.st.pilotStat = DROPING_PASSENGERS; // Alterar estado do piloto
-
-    for (int i = 0; i < sh->fSt.nPassInFlight; i++)
-        semUp(semgid, sh->passengersWaitInFlight); // Autorizar passageiros a sair do avião
-
-    saveFlightArrived(nFic, &(sh->fSt)); // Indicar chegada do voo
-    saveState(nFic, &(sh->fSt));         // Guardar estados
+    sh->fSt.st.pilotStat[plane] = DROPING_PASSENGERS; // Alterar estado do piloto
+    TRACE_PILOT (plane, sh->fSt.st.pilotStat[plane]); // Assinalar a transição de estado
+
+    stateWriteBegin (&sh->flightSeq);
+    sh->fSt.flightLanded = sh->fSt.planeFlight[plane];
+    stateWriteEnd (&sh->flightSeq);
+    snap = stateSnapshot (sh);
+    saveFlightArrived(nFic, snap); // Indicar chegada do voo
+    timelineEvent (TL_ARRIVED, sh->fSt.planeFlight[plane], plane, -1);
+    saveState(nFic, snap);         // Guardar estados
+
+    if (semUpN (semgid, sh->passengersWaitInFlight[plane], sh->fSt.planePass[plane]) == -1) { // Autorizar passageiros a sair do avião
+        perror ("error on the up operation for semaphore access (PT)");
+        exit (EXIT_FAILURE);
+    }
 
-    if (semUp (semgid, sh->mutex) == -1)  {                                                   /* exit critical region */
+    if (semOpBatch (semgid, leave, 2) == -1)  {                               /* exit log and flight critical regions */
         perror ("error on the up operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    semDown(semgid, sh->planeEmpty); // Esperar que o avião fique vazio
+    if (semDown(semgid, sh->planeEmpty[plane]) == -1) { // Esperar que o avião fique vazio
+        perror ("error on the down operation for semaphore access (PT)");
+        exit (EXIT_FAILURE);
+    }
 
-    if (semDown (semgid, sh->mutex) == -1) {                                                  /* enter critical region */
+    if ((semDown (semgid, sh->mutex) == -1) ||                               /* enter flight and log critical regions */
+        (semDown (semgid, sh->logMutex) == -1)) {
         perror ("error on the down operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
     }
 
     /* insert your code here */
-    saveFlightReturning(nFic, &(sh->fSt)); // Indicar o regresso do voo
+    stateWriteBegin (&sh->flightSeq);
+    sh->fSt.flightLanded = sh->fSt.planeFlight[plane];
+    stateWriteEnd (&sh->flightSeq);
+    saveFlightReturning(nFic, stateSnapshot (sh)); // Indicar o regresso do voo
+    timelineEvent (TL_RETURNING, sh->fSt.planeFlight[plane], plane, -1);
 
-    if (semUp (semgid, sh->mutex) == -1)  {                                                   /* exit critical region */
+    if (semOpBatch (semgid, leave, 2) == -1)  {                               /* exit log and flight critical regions */
         perror ("error on the up operation for semaphore access (PT)");
         exit (EXIT_FAILURE);
     }
@@ -3,25 +3,391 @@
  *
  *  \brief Semaphore management.
  *
+ *  Two backends are available, selected at build time:
+ *     \li SVIPC semaphore sets (default)
+ *     \li process-shared POSIX semaphores placed in a shared memory block (<tt>SEM_POSIX</tt>), so that operations
+ *         only enter the kernel when a process has to block or to be woken up.
+ *
  *  Operations defined on semaphores:
  *     \li creation of a set of semaphores
+ *     \li creation of a set of semaphores private to the calling process
  *     \li connection to a previously created set of semaphores
  *     \li destruction of a previously created set of semaphores
+ *     \li destruction of a set of semaphores left behind, given its creation key
  *     \li signalling start of operations
+ *     \li setting the value of every semaphore within the set at once
  *     \li <em>down</em> of a semaphore within the set
- *     \li <em>up</em> of a semaphore within the set.
+ *     \li <em>down</em> of a semaphore within the set that gives up after some time
+ *     \li <em>up</em> of a semaphore within the set
+ *     \li <em>up</em> of a semaphore within the set by more than one unit
+ *     \li batch of operations on semaphores within the set
+ *     \li latency instrumentation of the operations
+ *     \li hook called before the operations of the calling process
+ *     \li time limit of the <em>downs</em> of the calling process.
  *
  *  \author António Rui Borges - October 1995
  */
 
+#define _GNU_SOURCE                                                                      /* semtimedop, sem_clockwait */
+
 #include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include "semaphore.h"
+#include "trace.h"
+#include <semaphore.h>
 #include <sys/types.h>
 #include <sys/ipc.h>
 #include <sys/sem.h>
+#include <sys/shm.h>
 
 /** \brief access permission: user r-w */
 #define  MASK           0600
 
+/** \brief max number of operations in a batch */
+#define  MAXOPS         32
+
+/** \brief max number of process private sets and of attached POSIX sets */
+#define  NLOCAL         8
+
+/** \brief identifier of process private set <tt>i</tt> (system identifiers are never negative) */
+#define  LOCALID(i)     (-2 - (i))
+
+/** \brief index of the process private set with identifier <tt>id</tt> */
+#define  LOCALIDX(id)   (-2 - (id))
+
+/** \brief creation key of the shared memory block holding the POSIX set created with key <tt>key</tt> */
+#define  SEMKEY(key)    ((key_t) ((key) ^ 0x80000000))
+
+/**
+ *  \brief Definition of <em>set of POSIX semaphores</em> data type.
+ */
+typedef struct
+        { /** \brief number of semaphores in the set (semaphore 0 is used to signal start of operations) */
+          unsigned int snum;
+          /** \brief semaphores */
+          sem_t sem[];
+        } SEM_SET;
+
+/** \brief process private sets of semaphores */
+static SEM_SET *local[NLOCAL];
+
+#ifdef SEM_POSIX
+/** \brief identifiers of the POSIX sets mapped on the process address space */
+static int attId[NLOCAL];
+
+/** \brief POSIX sets mapped on the process address space */
+static SEM_SET *attSet[NLOCAL];
+#endif
+
+/** \brief hook called before the operations of the calling process */
+static SEM_HOOK hook;
+
+/** \brief time limit of a <em>down</em> of the calling process (0: none) */
+static struct timespec limit;
+
+/** \brief latency statistics of the calling thread (\c NULL if it is not instrumented) */
+static __thread SEM_STATS *instr;
+
+/** \brief entity class of the calling thread */
+static __thread unsigned int instrEntity;
+
+/** \brief time when the calling thread went through a <em>down</em> on the semaphore whose hold time is measured */
+static __thread unsigned long long holdStart;
+
+/**
+ *  \brief Allocation of a set of POSIX semaphores.
+ *
+ *  \param set storage of the set, or \c NULL to allocate it in the process heap
+ *  \param snum number of semaphores in the set (>= 1)
+ *  \param pshared \c 1 if the set is in shared memory, \c 0 otherwise
+ *
+ *  \return pointer to the set, upon success
+ *  \return \c NULL, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static SEM_SET *initSet (SEM_SET *set, unsigned int snum, int pshared)
+{
+  unsigned int s;
+
+  if ((set == NULL) && ((set = malloc (sizeof (SEM_SET) + (snum + 1) * sizeof (sem_t))) == NULL))
+     return NULL;
+  set->snum = snum;
+  for (s = 0; s <= snum; s++)
+    if (sem_init (&set->sem[s], pshared, 0) == -1)
+       return NULL;
+  return set;
+}
+
+/**
+ *  \brief Location of a set of POSIX semaphores.
+ *
+ *  With the SVIPC backend only process private sets are made of POSIX semaphores.
+ *  With the POSIX backend (<tt>SEM_POSIX</tt>) the shared memory block holding a system wide set is mapped on the
+ *  process address space the first time it is used.
+ *
+ *  \param semgid set identifier
+ *
+ *  \return pointer to the set, upon success
+ *  \return \c NULL, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static SEM_SET *posixSet (int semgid)
+{
+  int i;
+
+  if (semgid < -1)
+     { i = LOCALIDX (semgid);
+       if ((i >= NLOCAL) || (local[i] == NULL))
+          { errno = EINVAL;
+            return NULL;
+          }
+       return local[i];
+     }
+#ifdef SEM_POSIX
+  void *add;                                                                                    /* temporary pointer */
+
+  for (i = 0; i < NLOCAL; i++)
+    if ((attSet[i] != NULL) && (attId[i] == semgid))
+       return attSet[i];
+  for (i = 0; (i < NLOCAL) && (attSet[i] != NULL); i++);
+  if (i == NLOCAL)
+     { errno = ENOSPC;
+       return NULL;
+     }
+  if ((add = shmat (semgid, (char *) NULL, 0)) == (void *) -1)
+     return NULL;
+  attId[i] = semgid;
+  attSet[i] = (SEM_SET *) add;
+  return attSet[i];
+#else
+  errno = EINVAL;
+  return NULL;
+#endif
+}
+
+/**
+ *  \brief Location of a POSIX semaphore within a set.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (0 .. snum)
+ *
+ *  \return pointer to the semaphore, upon success
+ *  \return \c NULL, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static sem_t *posixSem (int semgid, unsigned int sindex)
+{
+  SEM_SET *set;
+
+  if ((set = posixSet (semgid)) == NULL)
+     return NULL;
+  if (sindex > set->snum)
+     { errno = EINVAL;
+       return NULL;
+     }
+  return &set->sem[sindex];
+}
+
+/**
+ *  \brief The set is made of SVIPC semaphores.
+ *
+ *  \param semgid set identifier
+ *
+ *  \return \c true, if operations go through <tt>semop</tt>
+ */
+
+static int isSysV (int semgid)
+{
+#ifdef SEM_POSIX
+  return 0;
+#else
+  return semgid >= 0;
+#endif
+}
+
+/**
+ *  \brief Time limit of the <em>downs</em> of the calling process.
+ *
+ *  \return pointer to the limit, or \c NULL if there is none
+ */
+
+static const struct timespec *downLimit (void)
+{
+  return (limit.tv_sec != 0) ? &limit : NULL;
+}
+
+/**
+ *  \brief <em>Down</em> of a POSIX semaphore, resumed when interrupted by a signal.
+ *
+ *  \param sem pointer to the semaphore
+ *  \param lim time limit, or \c NULL if there is none
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static int posixDown (sem_t *sem, const struct timespec *lim)
+{
+  struct timespec end;                                                                       /* end of the time limit */
+
+  if (lim != NULL)
+     { clock_gettime (CLOCK_MONOTONIC, &end);
+       end.tv_sec += lim->tv_sec;
+       if ((end.tv_nsec += lim->tv_nsec) >= 1000000000L)
+          { end.tv_sec++;
+            end.tv_nsec -= 1000000000L;
+          }
+       while (sem_clockwait (sem, CLOCK_MONOTONIC, &end) == -1)
+         if (errno != EINTR)
+            { if (errno == ETIMEDOUT)
+                 errno = EAGAIN;                                                                /* as with semtimedop */
+              return -1;
+            }
+       return 0;
+     }
+  while (sem_wait (sem) == -1)
+    if (errno != EINTR)
+       return -1;
+  return 0;
+}
+
+/**
+ *  \brief Operation on a SVIPC set, within a time limit if there is one.
+ *
+ *  An operation interrupted by a signal handler is resumed, as a <em>down</em> on a POSIX semaphore is, since
+ *  <tt>semop</tt> is never restarted.
+ *
+ *  \param semgid set identifier
+ *  \param ops operations
+ *  \param nops number of operations
+ *  \param lim time limit, or \c NULL if there is none
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+static int sysVOp (int semgid, struct sembuf ops[], size_t nops, const struct timespec *lim)
+{
+  int stat;
+
+  while (((stat = (lim != NULL) ? semtimedop (semgid, ops, nops, lim) : semop (semgid, ops, nops)) == -1) &&
+         (errno == EINTR))
+    ;
+  return stat;
+}
+
+/**
+ *  \brief Reading of the monotonic clock.
+ *
+ *  \return time in nanoseconds
+ */
+
+static unsigned long long now (void)
+{
+  struct timespec t;
+
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return (unsigned long long) t.tv_sec * 1000000000ULL + (unsigned long long) t.tv_nsec;
+}
+
+/**
+ *  \brief Bucket of a latency histogram holding a sample.
+ *
+ *  Values below <tt>SEM_HSUB</tt> have a bucket each, then every power of two is split in <tt>SEM_HSUB</tt> buckets.
+ *
+ *  \param ns sample in nanoseconds
+ *
+ *  \return bucket index
+ */
+
+static unsigned int bucketOf (unsigned long long ns)
+{
+  unsigned int msb, b;
+
+  if (ns < SEM_HSUB)
+     return (unsigned int) ns;
+  msb = 63 - (unsigned int) __builtin_clzll (ns);
+  b = (msb - 1) * SEM_HSUB + (unsigned int) ((ns >> (msb - 2)) & (SEM_HSUB - 1));
+  return (b < SEM_HBUCKETS) ? b : SEM_HBUCKETS - 1;
+}
+
+/**
+ *  \brief Largest value held by a bucket of a latency histogram.
+ *
+ *  \param b bucket index
+ *
+ *  \return value in nanoseconds
+ */
+
+static unsigned long long bucketTop (unsigned int b)
+{
+  unsigned int msb = b / SEM_HSUB + 1;
+
+  if (b < SEM_HSUB)
+     return b;
+  return ((unsigned long long) (SEM_HSUB + b % SEM_HSUB + 1) << (msb - 2)) - 1;
+}
+
+/**
+ *  \brief Accounting of a latency sample of the calling thread.
+ *
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param kind latency kind
+ *  \param ns sample in nanoseconds
+ */
+
+static void account (unsigned int sindex, unsigned int kind, unsigned long long ns)
+{
+  SEM_HIST *h;
+  unsigned long long m;
+
+  if (sindex == 0)
+     return;
+  if (sindex > instr->nIndexes)
+     sindex = instr->nIndexes;
+  h = semHist (instr, instrEntity, sindex, kind);
+  __atomic_fetch_add (&h->count, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add (&h->total, ns, __ATOMIC_RELAXED);
+  __atomic_fetch_add (&h->bucket[bucketOf (ns)], 1, __ATOMIC_RELAXED);
+  m = __atomic_load_n (&h->max, __ATOMIC_RELAXED);
+  while ((ns > m) && !__atomic_compare_exchange_n (&h->max, &m, ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+/**
+ *  \brief Accounting of an <em>up</em> of the calling thread, before it is carried out.
+ *
+ *  \param sindex semaphore location in the set (1 .. snum)
+ */
+
+static void upStart (unsigned int sindex)
+{
+  if ((instr != NULL) && (sindex == instr->holdIndex) && (holdStart != 0))
+     { account (sindex, SEM_HOLD, now () - holdStart);
+       holdStart = 0;
+     }
+}
+
+/**
+ *  \brief Accounting of a <em>down</em> of the calling thread, after it is carried out.
+ *
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param t0 time when the <em>down</em> was started
+ */
+
+static void downEnd (unsigned int sindex, unsigned long long t0)
+{
+  unsigned long long t;
+
+  if (instr != NULL)
+     { t = now ();
+       account (sindex, SEM_WAIT, t - t0);
+       if (sindex == instr->holdIndex)
+          holdStart = t;
+     }
+}
+
 /**
  *  \brief Creation of a set of semaphores.
  *
@@ -37,7 +403,49 @@
 
 int semCreate (int key, unsigned int snum)
 {
+#ifdef SEM_POSIX
+  int semgid;                                                                            /* semaphore set identifier */
+  SEM_SET *set;
+
+  if ((semgid = shmget (SEMKEY (key), sizeof (SEM_SET) + (snum + 1) * sizeof (sem_t), MASK | IPC_CREAT | IPC_EXCL))
+      == -1)
+     return -1;
+  if (((set = posixSet (semgid)) == NULL) || (initSet (set, snum, 1) == NULL))
+     { shmctl (semgid, IPC_RMID, (struct shmid_ds *) NULL);
+       return -1;
+     }
+  return semgid;
+#else
   return semget ((key_t) key, snum+1, MASK | IPC_CREAT | IPC_EXCL);
+#endif
+}
+
+/**
+ *  \brief Creation of a set of semaphores private to the calling process.
+ *
+ *  The set can only be used by the threads of the calling process and its semaphores are POSIX unnamed semaphores,
+ *  so an operation only enters the kernel when a thread has to block or to be woken up.
+ *  All semaphores in the set will be in set to <em>red state</em> upon creation.
+ *  The set is operated with the same functions as a set created by <tt>semCreate</tt>, except <tt>semConnect</tt>.
+ *
+ *  \param snum number of semaphores in the set (>= 1)
+ *
+ *  \return set identifier, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semCreateLocal (unsigned int snum)
+{
+  int i;
+
+  for (i = 0; (i < NLOCAL) && (local[i] != NULL); i++);
+  if (i == NLOCAL)
+     { errno = ENOSPC;
+       return -1;
+     }
+  if ((local[i] = initSet (NULL, snum, 0)) == NULL)
+     return -1;
+  return LOCALID (i);
 }
 
 /**
@@ -54,6 +462,15 @@ int semCreate (int key, unsigned int snum)
 int semConnect (int key)
 {
   int semgid;                                                                            /* semaphore set identifier */
+#ifdef SEM_POSIX
+  sem_t *start;                                                                     /* start of operations semaphore */
+
+  if (((semgid = shmget (SEMKEY (key), 1, MASK)) == -1) || ((start = posixSem (semgid, 0)) == NULL))
+     return -1;
+     else if ((posixDown (start, NULL) == -1) || (sem_post (start) == -1))
+             return -1;
+             else return semgid;
+#else
   struct sembuf init[2] = {{ 0, -1, 0 }, {0, 1, 0}};                                     /* initialization operation */
 
   if ((semgid = semget ((key_t) key, 1, MASK)) == -1)
@@ -61,6 +478,7 @@ int semConnect (int key)
      else if (semop (semgid, init, 2) == -1)
              return -1;
              else return semgid;
+#endif
 }
 
 /**
@@ -76,7 +494,55 @@ int semConnect (int key)
 
 int semDestroy (int semgid)
 {
+  SEM_SET *set;
+  unsigned int s;
+
+  if (isSysV (semgid))
+     return semctl (semgid, 0, IPC_RMID, NULL);
+  if ((set = posixSet (semgid)) == NULL)
+     return -1;
+  for (s = 0; s <= set->snum; s++)
+    sem_destroy (&set->sem[s]);
+  if (semgid < -1)
+     { free (set);
+       local[LOCALIDX (semgid)] = NULL;
+       return 0;
+     }
+#ifdef SEM_POSIX
+  int i;
+
+  for (i = 0; (i < NLOCAL) && (attSet[i] != set); i++);
+  attSet[i] = NULL;
+  shmdt (set);
+#endif
+  return shmctl (semgid, IPC_RMID, (struct shmid_ds *) NULL);
+}
+
+/**
+ *  \brief Destruction of a set of semaphores given its creation key.
+ *
+ *  Meant to remove a set left behind by a program that was killed: no process may be using it.
+ *  The function fails if there is no semaphore set with a creation key equal to <tt>key</tt>.
+ *
+ *  \param key creation key
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semRemove (int key)
+{
+  int semgid;                                                                            /* semaphore set identifier */
+
+#ifdef SEM_POSIX
+  if ((semgid = shmget (SEMKEY (key), 0, MASK)) == -1)
+     return -1;
+  return shmctl (semgid, IPC_RMID, (struct shmid_ds *) NULL);
+#else
+  if ((semgid = semget ((key_t) key, 0, MASK)) == -1)
+     return -1;
   return semctl (semgid, 0, IPC_RMID, NULL);
+#endif
 }
 
 /**
@@ -93,8 +559,81 @@ int semDestroy (int semgid)
 int semSignal (int semgid)
 {
   struct sembuf up = { 0, 1, 0 };                                                         /* all around up operation */
+  sem_t *sem;
+
+  if (isSysV (semgid))
+     return semop (semgid, &up, 1);
+  return ((sem = posixSem (semgid, 0)) == NULL) ? -1 : sem_post (sem);
+}
+
+/**
+ *  \brief Setting the value of every semaphore within the set at once.
+ *
+ *  A SVIPC set is set by a single <tt>SETALL</tt> operation, the semaphores of a POSIX set are drained and raised
+ *  one by one, which is the same as long as no other operation is carried out on them meanwhile.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param val values of the semaphores (<tt>snum + 1</tt> entries, location 0 included)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semSetAll (int semgid, unsigned short val[])
+{
+  union { int val; struct semid_ds *buf; unsigned short *array; } arg;                 /* union semun, caller defined */
+  SEM_SET *set;
+  unsigned int s, u;
+
+  if (isSysV (semgid))
+     { arg.array = val;
+       return semctl (semgid, 0, SETALL, arg);
+     }
+  if ((set = posixSet (semgid)) == NULL)
+     return -1;
+  for (s = 0; s <= set->snum; s++)
+    { while (sem_trywait (&set->sem[s]) == 0)                            /* drained, whoever is blocked stays blocked */
+        ;
+      if (errno != EAGAIN)
+         return -1;
+      for (u = 0; u < val[s]; u++)
+        if (sem_post (&set->sem[s]) == -1)
+           return -1;
+    }
+  return 0;
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore within the set, within a time limit if there is one.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param lim time limit, or \c NULL if there is none
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
 
-  return semop (semgid, &up, 1);
+static int timedDown (int semgid, unsigned int sindex, const struct timespec *lim)
+{
+  struct sembuf down = { 0, -1, 0 };                                                      /* specific down operation */
+  sem_t *sem;
+  unsigned long long t0 = (instr != NULL) ? now () : 0;                                /* time the operation started */
+  int stat;
+
+  if (hook != NULL)
+     hook (sindex, -1);
+  TRACE_SEM_BLOCK (semgid, sindex);
+  if (isSysV (semgid))
+     { down.sem_num = (unsigned short) sindex;
+       stat = sysVOp (semgid, &down, 1, lim);
+     }
+     else stat = ((sem = posixSem (semgid, sindex)) == NULL) ? -1 : posixDown (sem, lim);
+  TRACE_SEM_WAKE (semgid, sindex, stat);
+  if (stat == 0)
+     downEnd (sindex, t0);
+  return stat;
 }
 
 /**
@@ -111,10 +650,27 @@ int semSignal (int semgid)
 
 int semDown (int semgid, unsigned int sindex)
 {
-  struct sembuf down = { 0, -1, 0 };                                                      /* specific down operation */
+  return timedDown (semgid, sindex, downLimit ());
+}
 
-  down.sem_num = (unsigned short) sindex;
-  return semop (semgid, &down, 1);
+/**
+ *  \brief <em>Down</em> of a semaphore within the set, that gives up after some time.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param us time the operation may be blocked for (us)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semDownTimed (int semgid, unsigned int sindex, unsigned int us)
+{
+  struct timespec lim = { (time_t) (us / 1000000), (long) (us % 1000000) * 1000L };            /* specific time limit */
+
+  return timedDown (semgid, sindex, &lim);
 }
 
 /**
@@ -132,7 +688,225 @@ int semDown (int semgid, unsigned int sindex)
 int semUp (int semgid, unsigned int sindex)
 {
   struct sembuf up = { 0, 1, 0 };                                                           /* specific up operation */
+  sem_t *sem;
+
+  if (hook != NULL)
+     hook (sindex, 1);
+  upStart (sindex);
+  if (isSysV (semgid))
+     { up.sem_num = (unsigned short) sindex;
+       return semop (semgid, &up, 1);
+     }
+  return ((sem = posixSem (semgid, sindex)) == NULL) ? -1 : sem_post (sem);
+}
+
+/**
+ *  \brief <em>Up</em> of a semaphore within the set by <tt>n</tt> units.
+ *
+ *  Equivalent to <tt>n</tt> consecutive <em>ups</em>, but carried out as a single operation with SVIPC semaphores.
+ *  Nothing is done if <tt>n</tt> is \c 0.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param n number of units
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semUpN (int semgid, unsigned int sindex, unsigned int n)
+{
+  SEM_OP up = { sindex, (int) n };                                                           /* specific up operation */
+
+  if (n == 0)
+     return 0;
+  return semOpBatch (semgid, &up, 1);
+}
+
+/**
+ *  \brief Batch of operations on semaphores within the set.
+ *
+ *  With SVIPC semaphores the batch is a single atomic operation: either every operation is carried out or the
+ *  process blocks.
+ *  With POSIX semaphores the operations are carried out in order, so <em>downs</em> should only come last.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param ops operations (operations with <tt>delta</tt> equal to \c 0 are not allowed)
+ *  \param nops number of operations
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semOpBatch (int semgid, SEM_OP ops[], unsigned int nops)
+{
+  struct sembuf batch[MAXOPS];                                                                    /* SVIPC operations */
+  sem_t *sem;
+  unsigned int o;
+  unsigned long long t0 = 0;                                                           /* time the operation started */
+  int u, stat = 0;
+
+  if ((nops == 0) || (nops > MAXOPS))
+     { errno = EINVAL;
+       return -1;
+     }
+  for (o = 0; o < nops; o++)
+    if ((ops[o].delta == 0) || (ops[o].delta < -32767) || (ops[o].delta > 32767))
+       { errno = EINVAL;
+         return -1;
+       }
+  if (hook != NULL)
+     for (o = 0; o < nops; o++)
+       hook (ops[o].sindex, ops[o].delta);
+  if (instr != NULL)
+     { for (o = 0; o < nops; o++)
+         if (ops[o].delta > 0)
+            upStart (ops[o].sindex);
+       t0 = now ();
+     }
+  if (isSysV (semgid))
+     { for (o = 0; o < nops; o++)
+         { batch[o].sem_num = (unsigned short) ops[o].sindex;
+           batch[o].sem_op = (short) ops[o].delta;
+           batch[o].sem_flg = 0;
+         }
+       for (o = 0; (o < nops) && (ops[o].delta > 0); o++)
+         ;
+       if (o < nops)                                                            /* the batch blocks on its first down */
+          TRACE_SEM_BLOCK (semgid, ops[o].sindex);
+       stat = sysVOp (semgid, batch, nops, downLimit ());
+       if (o < nops)
+          TRACE_SEM_WAKE (semgid, ops[o].sindex, stat);
+     }
+     else for (o = 0; (o < nops) && (stat == 0); o++)
+            { if ((sem = posixSem (semgid, ops[o].sindex)) == NULL)
+                 stat = -1;
+              for (u = 0; (stat == 0) && (u < ops[o].delta); u++)
+                stat = sem_post (sem);
+              if ((stat == 0) && (ops[o].delta < 0))
+                 TRACE_SEM_BLOCK (semgid, ops[o].sindex);
+              for (u = 0; (stat == 0) && (u > ops[o].delta); u--)
+                stat = posixDown (sem, downLimit ());
+              if (ops[o].delta < 0)
+                 TRACE_SEM_WAKE (semgid, ops[o].sindex, stat);
+            }
+  if (stat == 0)
+     for (o = 0; o < nops; o++)
+       if (ops[o].delta < 0)
+          downEnd (ops[o].sindex, t0);
+  return stat;
+}
+
+/**
+ *  \brief Size of a latency statistics area.
+ *
+ *  \param nEntities number of entity classes
+ *  \param nIndexes number of semaphore locations accounted separately
+ *
+ *  \return size in bytes
+ */
+
+size_t semStatsSize (unsigned int nEntities, unsigned int nIndexes)
+{
+  return sizeof (SEM_STATS) + (size_t) nEntities * nIndexes * 2 * sizeof (SEM_HIST);
+}
+
+/**
+ *  \brief Initialization of a latency statistics area.
+ *
+ *  \param stats statistics area (<tt>semStatsSize</tt> bytes)
+ *  \param nEntities number of entity classes
+ *  \param nIndexes number of semaphore locations accounted separately
+ *  \param holdIndex location of the semaphore whose hold time is measured
+ */
+
+void semStatsInit (SEM_STATS *stats, unsigned int nEntities, unsigned int nIndexes, unsigned int holdIndex)
+{
+  size_t h;
+
+  stats->nEntities = nEntities;
+  stats->nIndexes = nIndexes;
+  stats->holdIndex = holdIndex;
+  for (h = 0; h < (size_t) nEntities * nIndexes * 2; h++)
+    stats->hist[h] = (SEM_HIST) { 0 };
+}
+
+/**
+ *  \brief Instrumentation of the operations carried out by the calling thread.
+ *
+ *  \param stats statistics area, or \c NULL to stop the instrumentation
+ *  \param entity entity class (0 .. nEntities - 1)
+ */
+
+void semInstrument (SEM_STATS *stats, unsigned int entity)
+{
+  instr = stats;
+  instrEntity = entity;
+  holdStart = 0;
+}
 
-  up.sem_num = (unsigned short) sindex;
-  return semop (semgid, &up, 1);
+/**
+ *  \brief Latency histogram.
+ *
+ *  \param stats statistics area
+ *  \param entity entity class (0 .. nEntities - 1)
+ *  \param sindex semaphore location in the set (1 .. nIndexes)
+ *  \param kind latency kind (<tt>SEM_WAIT</tt> or <tt>SEM_HOLD</tt>)
+ *
+ *  \return pointer to the histogram
+ */
+
+SEM_HIST *semHist (SEM_STATS *stats, unsigned int entity, unsigned int sindex, unsigned int kind)
+{
+  return &stats->hist[((size_t) entity * stats->nIndexes + sindex - 1) * 2 + kind];
+}
+
+/**
+ *  \brief Percentile of a latency histogram.
+ *
+ *  \param hist histogram
+ *  \param q fraction of the samples (0 .. 1)
+ *
+ *  \return latency in nanoseconds
+ */
+
+unsigned long long semHistPercentile (const SEM_HIST *hist, double q)
+{
+  unsigned long long rank = (unsigned long long) (q * hist->count + 0.999999),            /* samples up to the value */
+                     seen = 0;
+  unsigned int b;
+
+  if (rank == 0)
+     rank = 1;
+  for (b = 0; b < SEM_HBUCKETS; b++)
+    if ((seen += hist->bucket[b]) >= rank)
+       break;
+  if ((b == SEM_HBUCKETS) || (bucketTop (b) > hist->max))
+     return hist->max;
+  return bucketTop (b);
+}
+
+/**
+ *  \brief Setting of the hook called before the operations of the calling process.
+ *
+ *  \param h the hook, or \c NULL to remove it
+ */
+
+void semHook (SEM_HOOK h)
+{
+  hook = h;
+}
+
+/**
+ *  \brief Setting of the time limit of the <em>downs</em> of the calling process.
+ *
+ *  \param seconds time limit, or \c 0 to remove it
+ */
+
+void semTimeout (unsigned int seconds)
+{
+  limit.tv_sec = (time_t) seconds;
+  limit.tv_nsec = 0;
 }
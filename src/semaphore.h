@@ -3,13 +3,27 @@
  *
  *  \brief Semaphore management.
  *
+ *  Two backends are available, selected at build time:
+ *     \li SVIPC semaphore sets (default)
+ *     \li process-shared POSIX semaphores placed in a shared memory block (<tt>SEM_POSIX</tt>), so that operations
+ *         only enter the kernel when a process has to block or to be woken up.
+ *
  *  Operations defined on semaphores:
  *     \li creation of a set of semaphores
+ *     \li creation of a set of semaphores private to the calling process
  *     \li connection to a previously created set of semaphores
  *     \li destruction of a previously created set of semaphores
+ *     \li destruction of a set of semaphores left behind, given its creation key
  *     \li signalling start of operations
+ *     \li setting the value of every semaphore within the set at once
  *     \li <em>down</em> of a semaphore within the set
- *     \li <em>up</em> of a semaphore within the set.
+ *     \li <em>down</em> of a semaphore within the set that gives up after some time
+ *     \li <em>up</em> of a semaphore within the set
+ *     \li <em>up</em> of a semaphore within the set by more than one unit
+ *     \li batch of operations on semaphores within the set
+ *     \li latency instrumentation of the operations
+ *     \li hook called before the operations of the calling process
+ *     \li time limit of the <em>downs</em> of the calling process.
  *
  *  \author António Rui Borges - October 1995
  */
@@ -17,6 +31,67 @@
 #ifndef SEMAPHORE_H_
 #define SEMAPHORE_H_
 
+#include <stddef.h>
+
+/**
+ *  \brief Definition of <em>semaphore operation</em> data type.
+ */
+typedef struct
+        { /** \brief semaphore location in the set (1 .. snum) */
+          unsigned int sindex;
+          /** \brief units added to the semaphore (> 0: <em>up</em>, < 0: <em>down</em>) */
+          int delta;
+        } SEM_OP;
+
+/** \brief number of buckets per power of two in a latency histogram (relative resolution of 1/4) */
+#define  SEM_HSUB       4
+
+/** \brief number of buckets of a latency histogram (up to 2^40 ns, about 18 minutes) */
+#define  SEM_HBUCKETS   (40 * SEM_HSUB)
+
+/** \brief latency kinds: time blocked in a <em>down</em>, time from a <em>down</em> to the matching <em>up</em> */
+#define  SEM_WAIT       0
+#define  SEM_HOLD       1
+
+/**
+ *  \brief Definition of <em>operation hook</em> data type.
+ *
+ *  It is called with the semaphore location and the units added (> 0: <em>up</em>, < 0: <em>down</em>) before
+ *  the operation is carried out, once per operation within a batch.
+ */
+typedef void (*SEM_HOOK) (unsigned int sindex, int delta);
+
+/**
+ *  \brief Definition of <em>latency histogram</em> data type (times in nanoseconds).
+ */
+typedef struct
+        { /** \brief number of samples */
+          unsigned long long count;
+          /** \brief sum of the samples */
+          unsigned long long total;
+          /** \brief largest sample */
+          unsigned long long max;
+          /** \brief number of samples per bucket */
+          unsigned long long bucket[SEM_HBUCKETS];
+        } SEM_HIST;
+
+/**
+ *  \brief Definition of <em>latency statistics</em> data type.
+ *
+ *  There is one histogram per entity class, semaphore location and latency kind. Locations beyond the last one
+ *  are accounted in the last one. The statistics may be placed in shared memory, they are updated atomically.
+ */
+typedef struct
+        { /** \brief number of entity classes */
+          unsigned int nEntities;
+          /** \brief number of semaphore locations accounted separately (1 .. nIndexes) */
+          unsigned int nIndexes;
+          /** \brief location of the semaphore whose hold time is measured (a mutex) */
+          unsigned int holdIndex;
+          /** \brief histograms, <tt>[entity][location - 1][kind]</tt> */
+          SEM_HIST hist[];
+        } SEM_STATS;
+
 /**
  *  \brief Creation of a set of semaphores.
  *
@@ -32,6 +107,22 @@
 
 extern int semCreate (int key, unsigned int snum);
 
+/**
+ *  \brief Creation of a set of semaphores private to the calling process.
+ *
+ *  The set can only be used by the threads of the calling process and its semaphores are POSIX unnamed semaphores,
+ *  so an operation only enters the kernel when a thread has to block or to be woken up.
+ *  All semaphores in the set will be in set to <em>red state</em> upon creation.
+ *  The set is operated with the same functions as a set created by <tt>semCreate</tt>, except <tt>semConnect</tt>.
+ *
+ *  \param snum number of semaphores in the set (>= 1)
+ *
+ *  \return set identifier, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semCreateLocal (unsigned int snum);
+
 /**
  *  \brief Connection to a previously created set of semaphores.
  *
@@ -58,6 +149,20 @@ extern int semConnect (int key);
 
 extern int semDestroy (int semgid);
 
+/**
+ *  \brief Destruction of a set of semaphores given its creation key.
+ *
+ *  Meant to remove a set left behind by a program that was killed: no process may be using it.
+ *  The function fails if there is no semaphore set with a creation key equal to <tt>key</tt>.
+ *
+ *  \param key creation key
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semRemove (int key);
+
 /**
  *  \brief Signalling start of operations upon initialization of shared data structures.
  *
@@ -71,10 +176,27 @@ extern int semDestroy (int semgid);
 
 extern int semSignal (int semgid);
 
+/**
+ *  \brief Setting the value of every semaphore within the set at once.
+ *
+ *  Meant to reset a set in place between runs, whoever is blocked on a semaphore set to 0 stays blocked.
+ *  The operation is atomic on a SVIPC set only, no other operation may be carried out on a POSIX set meanwhile.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param val values of the semaphores (<tt>snum + 1</tt> entries, location 0 included)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semSetAll (int semgid, unsigned short val[]);
+
 /**
  *  \brief <em>Down</em> of a semaphore within the set.
  *
  *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *  It also fails, with <tt>errno</tt> set to <tt>EAGAIN</tt>, when the time limit set by <tt>semTimeout</tt> expires.
  *
  *  \param semgid set identifier
  *  \param sindex semaphore location in the set (1 .. snum)
@@ -85,6 +207,24 @@ extern int semSignal (int semgid);
 
 extern int semDown (int semgid, unsigned int sindex);
 
+/**
+ *  \brief <em>Down</em> of a semaphore within the set, that gives up after some time.
+ *
+ *  Meant for an entity that waits for an event only for a while. The time limit set by <tt>semTimeout</tt> does
+ *  not apply.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *  It also fails, with <tt>errno</tt> set to <tt>EAGAIN</tt>, when the time is over.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param us time the operation may be blocked for (us)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semDownTimed (int semgid, unsigned int sindex, unsigned int us);
+
 /**
  *  \brief <em>Up</em> of a semaphore within the set.
  *
@@ -99,4 +239,122 @@ extern int semDown (int semgid, unsigned int sindex);
 
 extern int semUp (int semgid, unsigned int sindex);
 
+/**
+ *  \brief <em>Up</em> of a semaphore within the set by <tt>n</tt> units.
+ *
+ *  Equivalent to <tt>n</tt> consecutive <em>ups</em>, but carried out as a single operation with SVIPC semaphores.
+ *  Nothing is done if <tt>n</tt> is \c 0.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param n number of units
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semUpN (int semgid, unsigned int sindex, unsigned int n);
+
+/**
+ *  \brief Batch of operations on semaphores within the set.
+ *
+ *  With SVIPC semaphores the batch is a single atomic operation: either every operation is carried out or the
+ *  process blocks.
+ *  With POSIX semaphores the operations are carried out in order, so <em>downs</em> should only come last.
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *  It also fails, with <tt>errno</tt> set to <tt>EAGAIN</tt>, when the time limit set by <tt>semTimeout</tt> expires.
+ *
+ *  \param semgid set identifier
+ *  \param ops operations (operations with <tt>delta</tt> equal to \c 0 are not allowed)
+ *  \param nops number of operations
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semOpBatch (int semgid, SEM_OP ops[], unsigned int nops);
+
+/**
+ *  \brief Size of a latency statistics area.
+ *
+ *  \param nEntities number of entity classes
+ *  \param nIndexes number of semaphore locations accounted separately
+ *
+ *  \return size in bytes
+ */
+
+extern size_t semStatsSize (unsigned int nEntities, unsigned int nIndexes);
+
+/**
+ *  \brief Initialization of a latency statistics area.
+ *
+ *  \param stats statistics area (<tt>semStatsSize</tt> bytes)
+ *  \param nEntities number of entity classes
+ *  \param nIndexes number of semaphore locations accounted separately
+ *  \param holdIndex location of the semaphore whose hold time is measured
+ */
+
+extern void semStatsInit (SEM_STATS *stats, unsigned int nEntities, unsigned int nIndexes, unsigned int holdIndex);
+
+/**
+ *  \brief Instrumentation of the operations carried out by the calling thread.
+ *
+ *  From now on, <em>downs</em> and <em>ups</em> are timestamped with <tt>CLOCK_MONOTONIC</tt> and accounted in the
+ *  histograms of entity class <tt>entity</tt>.
+ *
+ *  \param stats statistics area, or \c NULL to stop the instrumentation
+ *  \param entity entity class (0 .. nEntities - 1)
+ */
+
+extern void semInstrument (SEM_STATS *stats, unsigned int entity);
+
+/**
+ *  \brief Latency histogram.
+ *
+ *  \param stats statistics area
+ *  \param entity entity class (0 .. nEntities - 1)
+ *  \param sindex semaphore location in the set (1 .. nIndexes)
+ *  \param kind latency kind (<tt>SEM_WAIT</tt> or <tt>SEM_HOLD</tt>)
+ *
+ *  \return pointer to the histogram
+ */
+
+extern SEM_HIST *semHist (SEM_STATS *stats, unsigned int entity, unsigned int sindex, unsigned int kind);
+
+/**
+ *  \brief Percentile of a latency histogram.
+ *
+ *  The value is the upper bound of the bucket holding the percentile, but never above the largest sample.
+ *
+ *  \param hist histogram
+ *  \param q fraction of the samples (0 .. 1)
+ *
+ *  \return latency in nanoseconds
+ */
+
+extern unsigned long long semHistPercentile (const SEM_HIST *hist, double q);
+
+/**
+ *  \brief Setting of the hook called before the operations of the calling process.
+ *
+ *  Signalling start of operations and connecting to a set are not hooked.
+ *
+ *  \param hook the hook, or \c NULL to remove it
+ */
+
+extern void semHook (SEM_HOOK hook);
+
+/**
+ *  \brief Setting of the time limit of the <em>downs</em> of the calling process.
+ *
+ *  From now on, a <em>down</em>, or a batch of operations, that is blocked for longer than the limit fails with
+ *  <tt>errno</tt> set to <tt>EAGAIN</tt>, so that an entity whose peer died does not wait forever.
+ *  The limit is counted afresh on every operation, on each semaphore of a batch of a POSIX set.
+ *
+ *  \param seconds time limit, or \c 0 to remove it
+ */
+
+extern void semTimeout (unsigned int seconds);
+
 #endif /* SEMAPHORE_H_ */
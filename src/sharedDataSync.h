@@ -11,52 +11,386 @@
  *  Both the format of the shared data, which represents the full state of the problem, and the identification of
  *  the different semaphores, which carry out the synchronization among the intervening entities, are provided.
  *
+ *  The shared state is split in domains, each one with a critical region of its own, entered in this order:
+ *     \li flight: planes, boarding gates and flight counters
+ *     \li queue: queue of passengers and its counter, the state of the passengers joining it
+ *     \li log: the other states of the entities, each one changed by the entity itself, the counters of the
+ *         passengers leaving a plane, which are updated atomically, and the logging of every event.
+ *
+ *  The queue and flight domains are updated between <tt>stateWriteBegin</tt> and <tt>stateWriteEnd</tt>, so that
+ *  the logger takes a consistent snapshot of the whole state without entering their critical regions (seqlock).
+ *
  *  \author Nuno Lau - January 2022
  */
 
 #ifndef SHAREDDATASYNC_H_
 #define SHAREDDATASYNC_H_
 
+#include <sched.h>
+#include <string.h>
+
 #include "probConst.h"
 #include "probDataStruct.h"
+#include "logging.h"
+#include "semaphore.h"
+#include "simClock.h"
+#include "boardingPolicy.h"
+#include "timeline.h"
+
+#ifdef CACHE_ALIGNED
+/** \brief the field starts a cache line (the shared region starts at a page boundary) */
+#define SHARED_LINE  __attribute__ ((aligned (CACHELINE)))
+#else
+#define SHARED_LINE
+#endif
+
+/** \brief rounding of an offset in the shared region up to the start of the next array */
+#define SHARED_ROUND(off)  CACHE_ROUND (((off) + 7) & ~(size_t) 7)
 
 /**
  *  \brief Definition of <em>shared information</em> data type.
+ *
+ *  The read-mostly fields come first, followed by the fields of the queue domain, of the flight domain, of the
+ *  logging and the full state of the problem, each group starting a cache line in the cache line aware layout.
  */
 typedef struct
-        { /** \brief full state of the problem */
-          FULL_STAT fSt;
-
-          /* semaphores ids */
-          /** \brief identification of critical region protection semaphore – val = 1 */
+        { /* semaphores ids */
+          /** \brief identification of the flight domain critical region protection semaphore – val = 1 */
           unsigned int mutex;
+          /** \brief identification of the queue domain critical region protection semaphore – val = 1 */
+          unsigned int queueMutex;
+          /** \brief identification of the log critical region protection semaphore – val = 1 */
+          unsigned int logMutex;
           /** \brief identification of semaphore used by hostess to wait for passengers - val = 0 */
           unsigned int passengersInQueue;
-          /** \brief identification of semaphore used by passengers to wait for hostess – val = 0 */
-          unsigned int passengersWaitInQueue;
-          /** \brief identification of semaphore used by passengers to wait for flight to end – val = 0 */
-          unsigned int passengersWaitInFlight;
-          /** \brief identification of semaphore used by hostess to wait for starting boarding – val = 0  */
-          unsigned int readyForBoarding;
-          /** \brief identification of semaphore used by pilot to wait for boarding to complete - val = 0 */
-          unsigned int readyToFlight;
-          /** \brief identification of semaphore used by hostess to wait for passenger identification - val = 0 */
-          unsigned int idShown;
-          /** \brief identification of semaphore used by pilot to wait for last passenger to leave plane - val = 0 */
-          unsigned int planeEmpty;
+          /** \brief identification of semaphores used by passengers to wait for flight to end, one per plane
+           *  – val = 0 */
+          unsigned int passengersWaitInFlight[MAXPT];
+          /** \brief identification of semaphores used by pilots to wait for boarding to complete, one per plane
+           *  - val = 0 */
+          unsigned int readyToFlight[MAXPT];
+          /** \brief identification of semaphores used by pilots to wait for last passenger to leave plane, one per
+           *  plane - val = 0 */
+          unsigned int planeEmpty[MAXPT];
+          /** \brief identification of semaphores used by pilots to wait for their turn to board, one per plane
+           *  - val = 0 */
+          unsigned int boardingTurn[MAXPT];
+          /** \brief identification of semaphores used by hostesses to wait for starting boarding, one per gate
+           *  – val = 0 */
+          unsigned int readyForBoarding[MAXHT];
+          /** \brief identification of the first of the semaphores used by passengers to wait for hostess, one per
+           *  passenger, passenger <tt>p</tt> uses <tt>passengerCalled + p</tt> – val = 0 */
+          unsigned int passengerCalled;
+          /** \brief time limit, in seconds, of the <em>downs</em> of every intervening entity (\c 0, if there is
+           *  none) */
+          unsigned int downTimeout;
+          /** \brief boarding policy of the hostesses */
+          BOARD_POLICY policy;
+          /** \brief start of the run, when the passengers start going to the airport (<tt>policyClock</tt>, us) */
+          unsigned long long runStart;
+
+          /* worker pool */
+          /** \brief run the attached worker processes are started for, its seed and logging file follow from it */
+          unsigned int poolRun;
+          /** \brief the worker processes are to terminate instead of starting another run */
+          bool poolStop;
+
+          /* logging */
+          /** \brief logging backend used by all the intervening entities */
+          unsigned int logBackend;
+          /** \brief offset of the delta layout of the state lines in the shared region (\c 0, if they are full) */
+          size_t deltaOff;
+
+          /* instrumentation */
+          /** \brief offset of the latency statistics in the shared region (\c 0, if they are not collected) */
+          size_t latencyOff;
+          /** \brief offset of the virtual time clock in the shared region (\c 0, if time is real) */
+          size_t clockOff;
+          /** \brief offset of the timeline of the flights in the shared region (\c 0, if it is not kept) */
+          size_t timelineOff;
+
+          /* queue domain */
+          /** \brief position of the oldest and of the next passenger in <tt>passengerQueue</tt> (each passenger
+           *  joins the queue only once, so the positions never wrap around) */
+          unsigned int queueHead SHARED_LINE, queueTail;
+          /** \brief sequence number of the queue domain, odd while the domain is being updated (snapshot of the
+           *  state) */
+          unsigned int queueSeq;
+
+          /* flight domain: planes */
+          /** \brief sequence number of the flight domain, odd while the domain is being updated (snapshot of the
+           *  state) */
+          unsigned int flightSeq SHARED_LINE;
+          /** \brief a plane is being boarded */
+          bool boarding;
+          /** \brief planes waiting for their turn to board, in arrival order (circular FIFO) */
+          unsigned int planeReady[MAXPT];
+          /** \brief position of the oldest and of the next plane in <tt>planeReady</tt> */
+          unsigned int readyHead, readyTail;
+
+          /* flight domain: boarding gates */
+          /** \brief number of gates still boarding the current flight */
+          unsigned int nGatesOpen;
+          /** \brief gates still boarding the current flight (gates may be late to take part in it) */
+          bool gateOpen[MAXHT];
+          /** \brief boarding of the current flight is complete, no more passports are to be checked */
+          bool boardingClosed;
+          /** \brief number of passports being checked (passengers claimed by a gate but not yet boarded) */
+          unsigned int nPassChecking;
+          /** \brief number of those seats that may still be released, their passengers are only waited for a while
+           *  by the boarding policy */
+          unsigned int nPassHolding;
+
+          /* logging */
+          /** \brief sequence numbers and ring of log records */
+          LOG_SHARED logSh SHARED_LINE;
+
+          /** \brief full state of the problem, its parameters are the dimensions of the shared region
+           *  (variable size: must be the last field, the queue and the ring slots follow it) */
+          FULL_STAT fSt SHARED_LINE;
 
         } SHARED_DATA;
 
-/** \brief number of semaphores in the set */
-#define SEM_NU                    (8)
+/* Layout of the shared region */
+
+_Static_assert (offsetof (SHARED_DATA, fSt) + offsetof (FULL_STAT, var) <= sizeof (SHARED_DATA) &&
+                sizeof (SHARED_DATA) - offsetof (SHARED_DATA, fSt) - sizeof (FULL_STAT) < CACHELINE,
+                "the full state of the problem must be the last field of the shared region");
+_Static_assert (offsetof (FULL_STAT, var) % sizeof (unsigned int) == 0,
+                "the arrays of the full state of the problem must be aligned");
+#ifdef CACHE_ALIGNED
+_Static_assert (offsetof (SHARED_DATA, queueHead) % CACHELINE == 0, "the queue domain must start a cache line");
+_Static_assert (offsetof (SHARED_DATA, flightSeq) % CACHELINE == 0, "the flight domain must start a cache line");
+_Static_assert ((offsetof (SHARED_DATA, logSh) % CACHELINE == 0) &&
+                (offsetof (SHARED_DATA, logSh.tail) % CACHELINE == 0) &&
+                (offsetof (SHARED_DATA, logSh.closed) % CACHELINE == 0),
+                "the sequence numbers of the log records must be in cache lines of their own");
+_Static_assert (offsetof (SHARED_DATA, fSt) % CACHELINE == 0, "the full state must start a cache line");
+_Static_assert ((offsetof (FULL_STAT, st.pilotStat) % CACHELINE == 0) &&
+                (offsetof (FULL_STAT, st.hostessStat) % CACHELINE == 0) &&
+                (offsetof (FULL_STAT, nFlight) % CACHELINE == 0) &&
+                (offsetof (FULL_STAT, nPassInQueue) % CACHELINE == 0) &&
+                (offsetof (FULL_STAT, nPassInFlight) % CACHELINE == 0) &&
+                ((offsetof (FULL_STAT, var) + VAR_SKIP * sizeof (unsigned int)) % CACHELINE == 0),
+                "the states of the pilots and of the hostesses, the counters and the arrays must start cache lines");
+#else
+_Static_assert ((offsetof (FULL_STAT, st) == sizeof (PARAM)) &&
+                (sizeof (STAT) == (MAXPT + MAXHT) * sizeof (unsigned int)) && (VAR_SKIP == 0),
+                "the default layout of the full state must be packed (binary log records)");
+#endif
+
+/**
+ *  \brief Offset of the queue of passengers in the shared region.
+ *
+ *  \param par problem parameters
+ *
+ *  \return offset in bytes from the start of the shared region
+ */
+static inline size_t queueOffset (const PARAM *par)
+{
+    return SHARED_ROUND (offsetof (SHARED_DATA, fSt) + fullStatSize (par));
+}
+
+/**
+ *  \brief Offset of the snapshot of the full state in the shared region.
+ *
+ *  \param par problem parameters
+ *
+ *  \return offset in bytes from the start of the shared region
+ */
+static inline size_t snapshotOffset (const PARAM *par)
+{
+    return SHARED_ROUND (queueOffset (par) + 2 * par->nPassengers * sizeof (unsigned int));
+}
+
+/**
+ *  \brief Offset of the ring slots in the shared region.
+ *
+ *  \param par problem parameters
+ *
+ *  \return offset in bytes from the start of the shared region
+ */
+static inline size_t ringSlotsOffset (const PARAM *par)
+{
+    return SHARED_ROUND (snapshotOffset (par) + fullStatSize (par));
+}
+
+/**
+ *  \brief Queue of passengers waiting to be called by a hostess, in arrival order.
+ *
+ *  \param sh pointer to shared memory region
+ *
+ *  \return pointer to the queue (<tt>par.nPassengers</tt> entries)
+ */
+static inline unsigned int *passengerQueue (SHARED_DATA *sh)
+{
+    return (unsigned int *) ((char *) sh + queueOffset (&sh->fSt.par));
+}
+
+/**
+ *  \brief Plane boarded by each passenger, set by the hostess that called the passenger.
+ *
+ *  \param sh pointer to shared memory region
+ *
+ *  \return pointer to the plane of passenger 0
+ */
+static inline unsigned int *passengerPlane (SHARED_DATA *sh)
+{
+    return passengerQueue (sh) + sh->fSt.par.nPassengers;
+}
+
+/**
+ *  \brief Start of an update of the queue or the flight domain (seqlock writer side).
+ *
+ *  Must be called inside the critical region of the domain, which keeps its updates apart, and must not be followed
+ *  by any blocking operation before <tt>stateWriteEnd</tt>.
+ *
+ *  \param seq sequence number of the domain
+ */
+static inline void stateWriteBegin (unsigned int *seq)
+{
+    __atomic_store_n (seq, *seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+}
+
+/**
+ *  \brief End of an update of the queue or the flight domain.
+ *
+ *  \param seq sequence number of the domain
+ */
+static inline void stateWriteEnd (unsigned int *seq)
+{
+    __atomic_store_n (seq, *seq + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ *  \brief Consistent snapshot of the full state of the problem, to be logged.
+ *
+ *  Must be called inside the log critical region, which keeps the states of the entities still. The copy is taken
+ *  again while the queue or the flight domain is being updated (seqlock reader side).
+ *
+ *  \param sh pointer to shared memory region
+ *
+ *  \return pointer to the snapshot, in the shared region
+ */
+static inline FULL_STAT *stateSnapshot (SHARED_DATA *sh)
+{
+    FULL_STAT *snap = (FULL_STAT *) ((char *) sh + snapshotOffset (&sh->fSt.par));
+    unsigned int q, f;
+
+    while (true) {
+        q = __atomic_load_n (&sh->queueSeq, __ATOMIC_ACQUIRE);
+        f = __atomic_load_n (&sh->flightSeq, __ATOMIC_ACQUIRE);
+        if (((q | f) & 1) == 0) {
+            memcpy (snap, &sh->fSt, fullStatSize (&sh->fSt.par));
+            __atomic_thread_fence (__ATOMIC_ACQUIRE);
+            if ((__atomic_load_n (&sh->queueSeq, __ATOMIC_RELAXED) == q) &&
+                (__atomic_load_n (&sh->flightSeq, __ATOMIC_RELAXED) == f)) {
+                return snap;
+            }
+        }
+        sched_yield ();                                                                /* let the update be completed */
+    }
+}
+
+/**
+ *  \brief Size of the shared region.
+ *
+ *  \param par problem parameters
+ *  \param nSlots number of slots of the ring of log records
+ *
+ *  \return size in bytes
+ */
+static inline size_t sharedDataSize (const PARAM *par, unsigned int nSlots)
+{
+    return ringSlotsOffset (par) + nSlots * logRecordSize (par);
+}
+
+/**
+ *  \brief Latency statistics of the synchronization points.
+ *
+ *  \param sh pointer to shared memory region
+ *
+ *  \return pointer to the statistics, or \c NULL if they are not collected
+ */
+static inline SEM_STATS *latencyStats (SHARED_DATA *sh)
+{
+    return (sh->latencyOff == 0) ? NULL : (SEM_STATS *) ((char *) sh + sh->latencyOff);
+}
+
+/**
+ *  \brief Delta layout of the state lines.
+ *
+ *  \param sh pointer to shared memory region
+ *
+ *  \return pointer to the delta layout data, or \c NULL if the state lines are full
+ */
+static inline LOG_DELTA *logDelta (SHARED_DATA *sh)
+{
+    return (sh->deltaOff == 0) ? NULL : (LOG_DELTA *) ((char *) sh + sh->deltaOff);
+}
+
+/**
+ *  \brief Virtual time clock.
+ *
+ *  \param sh pointer to shared memory region
+ *
+ *  \return pointer to the clock, or \c NULL if time is real
+ */
+static inline SIM_CLOCK *simClock (SHARED_DATA *sh)
+{
+    return (sh->clockOff == 0) ? NULL : (SIM_CLOCK *) ((char *) sh + sh->clockOff);
+}
+
+/**
+ *  \brief Timeline of the flights.
+ *
+ *  \param sh pointer to shared memory region
+ *
+ *  \return pointer to the timeline, or \c NULL if it is not kept
+ */
+static inline TIMELINE *timeline (SHARED_DATA *sh)
+{
+    return (sh->timelineOff == 0) ? NULL : (TIMELINE *) ((char *) sh + sh->timelineOff);
+}
+
+/** \brief entity classes of the latency statistics */
+#define LAT_PILOT                  0
+#define LAT_HOSTESS                1
+#define LAT_PASSENGER              2
+#define LAT_ENTITIES               3
+
+/** \brief number of semaphore locations accounted separately, the per passenger ones are accounted together */
+#define LAT_INDEXES               PASSENGERCALLED
+
+/** \brief number of semaphores in the set, it grows with the number of passengers */
+#define SEM_NU(nPassengers)       (PASSENGERCALLED - 1 + (nPassengers))
 
 #define MUTEX                      1
-#define PASSENGERSINQUEUE          2
-#define PASSENGERSWAITINQUEUE      3
-#define PASSENGERSWAITINFLIGHT     4
-#define READYFORBOARDING           5
-#define READYTOFLIGHT              6
-#define IDSHOWN                    7
-#define PLANEEMPTY                 8
+#define QUEUEMUTEX                 2
+#define LOGMUTEX                   3
+#define PASSENGERSINQUEUE          4
+/** \brief first of the per plane semaphores, plane <tt>p</tt> uses <tt>PASSENGERSWAITINFLIGHT + p</tt> */
+#define PASSENGERSWAITINFLIGHT     5
+/** \brief first of the per plane semaphores, plane <tt>p</tt> uses <tt>READYTOFLIGHT + p</tt> */
+#define READYTOFLIGHT             (PASSENGERSWAITINFLIGHT + MAXPT)
+/** \brief first of the per plane semaphores, plane <tt>p</tt> uses <tt>PLANEEMPTY + p</tt> */
+#define PLANEEMPTY                (READYTOFLIGHT + MAXPT)
+/** \brief first of the per plane semaphores, plane <tt>p</tt> uses <tt>BOARDINGTURN + p</tt> */
+#define BOARDINGTURN              (PLANEEMPTY + MAXPT)
+/** \brief first of the per gate semaphores, gate <tt>g</tt> uses <tt>READYFORBOARDING + g</tt> */
+#define READYFORBOARDING          (BOARDINGTURN + MAXPT)
+/** \brief first of the per passenger semaphores, passenger <tt>p</tt> uses <tt>PASSENGERCALLED + p</tt> */
+#define PASSENGERCALLED           (READYFORBOARDING + MAXHT)
+
+/** \brief semaphore protecting the virtual time clock, after the per passenger ones */
+#define CLOCKLOCK(nPassengers)    (SEM_NU (nPassengers) + 1)
+/** \brief first of the wakeup semaphores of the virtual time clock, passenger <tt>p</tt> uses
+ *  <tt>CLOCKWAKE + p</tt> and plane <tt>p</tt> uses <tt>CLOCKWAKE + nPassengers + p</tt> */
+#define CLOCKWAKE(nPassengers)    (CLOCKLOCK (nPassengers) + 1)
+/** \brief number of sleepers of the virtual time clock */
+#define CLOCKSLEEPERS(nPassengers) ((nPassengers) + MAXPT)
+/** \brief number of semaphores in the set when time is virtual */
+#define SEM_NU_CLOCK(nPassengers) (CLOCKWAKE (nPassengers) - 1 + CLOCKSLEEPERS (nPassengers))
 
 #endif /* SHAREDDATASYNC_H_ */
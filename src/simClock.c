@@ -0,0 +1,294 @@
+/**
+ *  \file simClock.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Virtual time clock and discrete event scheduler.
+ *
+ *  The intervening entities, instead of sleeping, register their wakeup time and, when none of them can make
+ *  progress (every one is either sleeping or blocked on a semaphore), the clock is advanced to the earliest
+ *  wakeup and that entity is resumed. Blocking is tracked by a hook on the semaphore operations, which keeps the
+ *  value each semaphore would have: a <em>down</em> that takes it below zero blocks the entity, an <em>up</em>
+ *  done while it is below zero resumes one.
+ *
+ *  Operations defined on the clock:
+ *     \li size and initialization of the clock in shared memory
+ *     \li binding of the calling thread to the clock
+ *     \li sleeping for some time, in virtual time if the calling thread is bound to a clock
+ *     \li signalling the termination of the calling thread.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include "semaphore.h"
+#include "simClock.h"
+
+/** \brief clock the calling process is bound to */
+static SIM_CLOCK *clk = NULL;
+
+/** \brief identifier of the semaphore set holding the semaphores of the clock */
+static int clkSemgid;
+
+/** \brief the calling thread is bound to the clock */
+static __thread bool bound = false;
+
+/** \brief sleeper identification of the calling thread */
+static __thread unsigned int sleeper;
+
+/**
+ *  \brief Value each accounted semaphore would have, negative when there are entities blocked on it.
+ *
+ *  \return pointer to the value of semaphore 0
+ */
+
+static int *value (void)
+{
+    return (int *) (clk->pending + clk->nSleepers);
+}
+
+/**
+ *  \brief Ordering of wakeups.
+ *
+ *  \return \c true if wakeup <tt>a</tt> comes before wakeup <tt>b</tt>
+ */
+
+static bool before (SIM_WAKEUP *a, SIM_WAKEUP *b)
+{
+    return (a->at < b->at) || ((a->at == b->at) && (a->seq < b->seq));
+}
+
+/**
+ *  \brief Insertion of a wakeup in the heap of pending wakeups.
+ *
+ *  \param w wakeup
+ */
+
+static void push (SIM_WAKEUP w)
+{
+    unsigned int i = clk->nPending++;
+
+    while ((i > 0) && before (&w, &clk->pending[(i - 1) / 2])) {
+        clk->pending[i] = clk->pending[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    clk->pending[i] = w;
+}
+
+/**
+ *  \brief Removal of the earliest wakeup from the heap of pending wakeups.
+ *
+ *  \return earliest wakeup
+ */
+
+static SIM_WAKEUP pop (void)
+{
+    SIM_WAKEUP first = clk->pending[0],
+               last = clk->pending[--clk->nPending];
+    unsigned int i = 0, c;
+
+    while ((c = 2 * i + 1) < clk->nPending) {
+        if ((c + 1 < clk->nPending) && before (&clk->pending[c + 1], &clk->pending[c])) {
+            c++;
+        }
+        if (!before (&clk->pending[c], &last)) {
+            break;
+        }
+        clk->pending[i] = clk->pending[c];
+        i = c;
+    }
+    clk->pending[i] = last;
+    return first;
+}
+
+/**
+ *  \brief Entering the critical region of the clock.
+ */
+
+static void lock (void)
+{
+    if (semDown (clkSemgid, clk->lock) == -1) {
+        perror ("error on the down operation for clock access");
+        exit (EXIT_FAILURE);
+    }
+}
+
+/**
+ *  \brief Exiting the critical region of the clock.
+ */
+
+static void unlock (void)
+{
+    if (semUp (clkSemgid, clk->lock) == -1) {
+        perror ("error on the up operation for clock access");
+        exit (EXIT_FAILURE);
+    }
+}
+
+/**
+ *  \brief Advancing the clock while no entity is running.
+ *
+ *  The entity with the earliest wakeup is resumed, when the time scale is not zero only after waiting the real
+ *  time that corresponds to the advance of the clock. Must be called inside the critical region of the clock.
+ */
+
+static void schedule (void)
+{
+    SIM_WAKEUP w;
+
+    while ((clk->running == 0) && (clk->nPending > 0)) {
+        w = pop ();
+        if ((clk->scale > 0.0) && (w.at > clk->now)) {
+            usleep ((unsigned int) ((w.at - clk->now) * clk->scale));
+        }
+        if (w.at > clk->now) {
+            clk->now = w.at;
+        }
+        clk->running++;
+        if (semUp (clkSemgid, clk->wake + w.sleeper) == -1) {
+            perror ("error on the up operation for wakeup");
+            exit (EXIT_FAILURE);
+        }
+    }
+}
+
+/**
+ *  \brief Accounting of a semaphore operation, before it is carried out.
+ *
+ *  \param sindex semaphore location in the set
+ *  \param delta units added to the semaphore
+ */
+
+static void account (unsigned int sindex, int delta)
+{
+    int *v;
+
+    if ((sindex == 0) || (sindex > clk->nSems)) {                                   /* the clock's own semaphores */
+        return;
+    }
+    lock ();
+    v = &value ()[sindex];
+    for (; delta > 0; delta--) {
+        if ((*v)++ < 0) {                                                          /* a blocked entity is resumed */
+            clk->running++;
+        }
+    }
+    for (; delta < 0; delta++) {
+        if (--(*v) < 0) {                                                                 /* the caller will block */
+            clk->running--;
+        }
+    }
+    schedule ();
+    unlock ();
+}
+
+/**
+ *  \brief Size of a clock.
+ *
+ *  \param nSleepers number of sleepers
+ *  \param nSems number of semaphores accounted
+ *
+ *  \return size in bytes
+ */
+
+size_t simClockSize (unsigned int nSleepers, unsigned int nSems)
+{
+    return sizeof (SIM_CLOCK) + nSleepers * sizeof (SIM_WAKEUP) + (nSems + 1) * sizeof (int);
+}
+
+/**
+ *  \brief Initialization of a clock.
+ *
+ *  \param c clock (<tt>simClockSize</tt> bytes)
+ *  \param lock location of the semaphore protecting the clock
+ *  \param wake location of the first wakeup semaphore
+ *  \param nSleepers number of sleepers
+ *  \param nSems number of semaphores accounted
+ *  \param nEntities number of intervening entities, all of them are running when they start
+ *  \param scale real time taken by each unit of virtual time (0: as fast as possible)
+ */
+
+void simClockInit (SIM_CLOCK *c, unsigned int lock, unsigned int wake, unsigned int nSleepers,
+                   unsigned int nSems, unsigned int nEntities, double scale)
+{
+    unsigned int s;
+
+    c->now = 0;
+    c->seq = 0;
+    c->scale = scale;
+    c->lock = lock;
+    c->wake = wake;
+    c->nSleepers = nSleepers;
+    c->nSems = nSems;
+    c->running = (int) nEntities;
+    c->nPending = 0;
+    for (s = 0; s <= nSems; s++) {
+        ((int *) (c->pending + nSleepers))[s] = 0;
+    }
+}
+
+/**
+ *  \brief Binding of the calling thread to a clock.
+ *
+ *  \param c clock, or \c NULL to sleep in real time
+ *  \param semgid identifier of the semaphore set holding the semaphores of the clock
+ *  \param s sleeper identification of the calling thread (0 .. nSleepers - 1), if it ever sleeps
+ */
+
+void simClockBind (SIM_CLOCK *c, int semgid, unsigned int s)
+{
+    if (c == NULL) {
+        return;
+    }
+    clk = c;
+    clkSemgid = semgid;
+    bound = true;
+    sleeper = s;
+    semHook (account);
+}
+
+/**
+ *  \brief Sleeping for some time.
+ *
+ *  \param us time (us)
+ */
+
+void simSleep (unsigned int us)
+{
+    SIM_WAKEUP w;
+
+    if (!bound) {
+        usleep (us);
+        return;
+    }
+    lock ();
+    w.at = clk->now + us;
+    w.seq = clk->seq++;
+    w.sleeper = sleeper;
+    push (w);
+    clk->running--;
+    schedule ();
+    unlock ();
+    if (semDown (clkSemgid, clk->wake + sleeper) == -1) {
+        perror ("error on the down operation for wakeup");
+        exit (EXIT_FAILURE);
+    }
+}
+
+/**
+ *  \brief Signalling the termination of the calling thread.
+ */
+
+void simExit (void)
+{
+    if (!bound) {
+        return;
+    }
+    lock ();
+    clk->running--;
+    schedule ();
+    unlock ();
+    bound = false;
+}
@@ -0,0 +1,124 @@
+/**
+ *  \file simClock.h (interface file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Virtual time clock and discrete event scheduler.
+ *
+ *  The intervening entities, instead of sleeping, register their wakeup time and, when none of them can make
+ *  progress (every one is either sleeping or blocked on a semaphore), the clock is advanced to the earliest
+ *  wakeup and that entity is resumed. Blocking is tracked by a hook on the semaphore operations, which keeps the
+ *  value each semaphore would have: a <em>down</em> that takes it below zero blocks the entity, an <em>up</em>
+ *  done while it is below zero resumes one.
+ *
+ *  Operations defined on the clock:
+ *     \li size and initialization of the clock in shared memory
+ *     \li binding of the calling thread to the clock
+ *     \li sleeping for some time, in virtual time if the calling thread is bound to a clock
+ *     \li signalling the termination of the calling thread.
+ */
+
+#ifndef SIMCLOCK_H_
+#define SIMCLOCK_H_
+
+#include <stddef.h>
+
+/**
+ *  \brief Definition of <em>wakeup</em> data type.
+ */
+typedef struct
+{ /** \brief virtual time of the wakeup (us) */
+    unsigned long long at;
+    /** \brief order of registration, wakeups at the same time are served in it */
+    unsigned long long seq;
+    /** \brief sleeper to be resumed */
+    unsigned int sleeper;
+
+} SIM_WAKEUP;
+
+/**
+ *  \brief Definition of <em>virtual time clock</em> data type.
+ *
+ *  It is placed in shared memory and protected by a semaphore of its own. The pending wakeups (a binary heap)
+ *  and the value each accounted semaphore would have are stored after it.
+ */
+typedef struct
+{ /** \brief virtual time (us) */
+    unsigned long long now;
+    /** \brief number of wakeups registered so far */
+    unsigned long long seq;
+    /** \brief real time taken by each unit of virtual time when the clock is advanced (0: no wait at all) */
+    double scale;
+    /** \brief location of the semaphore protecting the clock – val = 1 */
+    unsigned int lock;
+    /** \brief location of the first of the wakeup semaphores, sleeper <tt>s</tt> uses <tt>wake + s</tt> – val = 0 */
+    unsigned int wake;
+    /** \brief number of sleepers */
+    unsigned int nSleepers;
+    /** \brief number of semaphores accounted (1 .. nSems), the ones of the clock must come after them */
+    unsigned int nSems;
+    /** \brief number of intervening entities neither sleeping nor blocked */
+    int running;
+    /** \brief number of pending wakeups */
+    unsigned int nPending;
+    /** \brief pending wakeups (<tt>nSleepers</tt> entries) followed by the value of the accounted semaphores
+     *  (<tt>nSems + 1</tt> entries) */
+    SIM_WAKEUP pending[];
+
+} SIM_CLOCK;
+
+/**
+ *  \brief Size of a clock.
+ *
+ *  \param nSleepers number of sleepers
+ *  \param nSems number of semaphores accounted
+ *
+ *  \return size in bytes
+ */
+extern size_t simClockSize (unsigned int nSleepers, unsigned int nSems);
+
+/**
+ *  \brief Initialization of a clock.
+ *
+ *  It must be done before any operation on the accounted semaphores, all of them in <em>red state</em>.
+ *  The semaphore protecting the clock must be set to <em>green state</em> afterwards.
+ *
+ *  \param clk clock (<tt>simClockSize</tt> bytes)
+ *  \param lock location of the semaphore protecting the clock
+ *  \param wake location of the first wakeup semaphore
+ *  \param nSleepers number of sleepers
+ *  \param nSems number of semaphores accounted
+ *  \param nEntities number of intervening entities, all of them are running when they start
+ *  \param scale real time taken by each unit of virtual time (0: as fast as possible)
+ */
+extern void simClockInit (SIM_CLOCK *clk, unsigned int lock, unsigned int wake, unsigned int nSleepers,
+                          unsigned int nSems, unsigned int nEntities, double scale);
+
+/**
+ *  \brief Binding of the calling thread to a clock.
+ *
+ *  The semaphore operations of the calling process are accounted from now on.
+ *
+ *  \param clk clock, or \c NULL to sleep in real time
+ *  \param semgid identifier of the semaphore set holding the semaphores of the clock
+ *  \param sleeper sleeper identification of the calling thread (0 .. nSleepers - 1), if it ever sleeps
+ */
+extern void simClockBind (SIM_CLOCK *clk, int semgid, unsigned int sleeper);
+
+/**
+ *  \brief Sleeping for some time.
+ *
+ *  In virtual time if the calling thread is bound to a clock, in real time otherwise.
+ *
+ *  \param us time (us)
+ */
+extern void simSleep (unsigned int us);
+
+/**
+ *  \brief Signalling the termination of the calling thread.
+ *
+ *  Nothing is done if the calling thread is not bound to a clock.
+ */
+extern void simExit (void);
+
+#endif /* SIMCLOCK_H_ */
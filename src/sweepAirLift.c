@@ -0,0 +1,463 @@
+/**
+ *  \file sweepAirLift.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  Monte Carlo sweep over the parameters of the problem.
+ *
+ *  Every combination of the values given for the number of passengers, the min and max flight capacities, the
+ *  number of hostesses and the number of planes is a parameter point, and it is simulated a number of times
+ *  by the discrete event simulation engine, run <tt>r</tt> with seed <tt>seed + r</tt> at every point. The
+ *  simulations are independent and spread over a pool of threads: each one starts with an even share of them
+ *  and, when it runs out, steals half of the share left to another one.
+ *
+ *  For every parameter point a row of the results table is written with the flights used (mean, min and max),
+ *  the mean occupancy of the flights (passengers over max flight capacity) and the distribution of the time the
+ *  air lift took (mean, median, 95th percentile and max, in virtual time).
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-n</tt> numbers of passengers, <tt>-m</tt> min flight capacities, <tt>-M</tt> max flight capacities,
+ *        <tt>-H</tt> numbers of hostesses and <tt>-P</tt> numbers of planes, each one a comma separated list of
+ *        values or of ranges <tt>first:last[:step]</tt> (the defaults are the values in probConst.h)
+ *    \li <tt>-R</tt> number of runs per parameter point
+ *    \li <tt>-s</tt> seed of the first run
+ *    \li <tt>-p</tt> boarding policy of the hostesses, <tt>greedy</tt>, <tt>hold[:us]</tt> or <tt>predict[:us]</tt>
+ *        (see boardingPolicy.h; greedy, if missing), the same at every parameter point
+ *    \li <tt>-T</tt> number of threads (as many as processors, if missing)
+ *    \li <tt>-c</tt> to write the results table in CSV format
+ *    \li <tt>-o</tt> name of the output file (stdout if missing).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "boardingPolicy.h"
+#include "desEngine.h"
+
+/** \brief max number of values of a swept parameter */
+#define  MAXVALUES      256
+
+/**
+ *  \brief Definition of <em>swept parameter</em> data type.
+ */
+typedef struct
+{ /** \brief values */
+    unsigned int val[MAXVALUES];
+    /** \brief number of values */
+    unsigned int n;
+
+} SWEPT;
+
+/**
+ *  \brief Definition of <em>outcome of a run</em> data type.
+ */
+typedef struct
+{ /** \brief time the air lift took (us) */
+    unsigned long long time;
+    /** \brief flights used */
+    unsigned int flights;
+
+} OUTCOME;
+
+/**
+ *  \brief Definition of <em>share of runs</em> data type, the runs <tt>lo</tt> .. <tt>hi - 1</tt> are left.
+ *
+ *  The owner takes runs from the bottom and the thieves take the top half.
+ */
+typedef struct
+{ /** \brief access to the share */
+    pthread_mutex_t lock;
+    /** \brief first run left */
+    unsigned int lo;
+    /** \brief run after the last one left */
+    unsigned int hi;
+    /** \brief runs stolen from other shares */
+    unsigned int stolen;
+
+} SHARE;
+
+/** \brief parameter points */
+static PARAM *point;
+
+/** \brief number of parameter points */
+static unsigned int nPoints;
+
+/** \brief runs per parameter point */
+static unsigned int nRuns = 100;
+
+/** \brief seed of the first run */
+static unsigned int seed = 1;
+
+/** \brief boarding policy of the hostesses */
+static BOARD_POLICY policy;
+
+/** \brief outcome of every run, those of a parameter point are contiguous */
+static OUTCOME *outcome;
+
+/** \brief shares of runs, one per thread */
+static SHARE *share;
+
+/** \brief number of threads */
+static unsigned int nThreads;
+
+/**
+ *  \brief Conversion of a numerical value of a swept parameter.
+ *
+ *  The program is terminated if it is not a positive integer.
+ *
+ *  \param arg value
+ *  \param name name of the parameter, for error reporting
+ *
+ *  \return value
+ */
+
+static unsigned int getValue (char *arg, char *name)
+{
+    char *tinp;                                                                     /* numerical parameters test flag */
+    long val;
+
+    val = strtol (arg, &tinp, 0);
+    if ((*tinp != '\0') || (val <= 0) || (val > 1000000)) {
+        fprintf (stderr, "Wrong value for the %s (\"%s\")!\n", name, arg);
+        exit (EXIT_FAILURE);
+    }
+    return (unsigned int) val;
+}
+
+/**
+ *  \brief Conversion of the values of a swept parameter.
+ *
+ *  \param arg comma separated list of values or ranges <tt>first:last[:step]</tt> (it is changed)
+ *  \param name name of the parameter, for error reporting
+ *  \param sw storage for the values
+ */
+
+static void getValues (char *arg, char *name, SWEPT *sw)
+{
+    char *item, *last, *step;
+    unsigned int v, to, by;
+
+    sw->n = 0;
+    for (item = strtok (arg, ","); item != NULL; item = strtok (NULL, ",")) {
+        by = 1;
+        if ((last = strchr (item, ':')) != NULL) {
+            *last++ = '\0';
+            if ((step = strchr (last, ':')) != NULL) {
+                *step++ = '\0';
+                by = getValue (step, name);
+            }
+        }
+        v = getValue (item, name);
+        to = (last != NULL) ? getValue (last, name) : v;
+        for (; v <= to; v += by) {
+            if (sw->n == MAXVALUES) {
+                fprintf (stderr, "There are more than %d values of the %s!\n", MAXVALUES, name);
+                exit (EXIT_FAILURE);
+            }
+            sw->val[sw->n++] = v;
+        }
+    }
+    if (sw->n == 0) {
+        fprintf (stderr, "There are no values of the %s!\n", name);
+        exit (EXIT_FAILURE);
+    }
+}
+
+/**
+ *  \brief Taking the next run of the share of a thread, stealing half of another share when it is empty.
+ *
+ *  \param t thread
+ *  \param run storage for the run
+ *
+ *  \return \c false if there are no more runs in any share
+ */
+
+static bool takeRun (unsigned int t, unsigned int *run)
+{
+    SHARE *own = &share[t], *victim;
+    unsigned int v, lo, hi;
+
+    pthread_mutex_lock (&own->lock);
+    if (own->lo < own->hi) {
+        *run = own->lo++;
+        pthread_mutex_unlock (&own->lock);
+        return true;
+    }
+    pthread_mutex_unlock (&own->lock);
+
+    for (v = 1; v < nThreads; v++) {                                          /* the runs are never added, only moved */
+        victim = &share[(t + v) % nThreads];
+        pthread_mutex_lock (&victim->lock);
+        lo = victim->lo;
+        hi = victim->hi;
+        if (lo < hi) {
+            victim->hi = lo + (hi - lo) / 2;                                           /* the victim keeps the bottom */
+            lo = victim->hi;
+        }
+        pthread_mutex_unlock (&victim->lock);
+        if (lo < hi) {
+            pthread_mutex_lock (&own->lock);
+            *run = lo;
+            own->lo = lo + 1;
+            own->hi = hi;
+            own->stolen += hi - lo;
+            pthread_mutex_unlock (&own->lock);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ *  \brief Worker of the pool, running simulations until there are none left.
+ *
+ *  \param arg thread, cast to a pointer
+ *
+ *  \return \c NULL
+ */
+
+static void *worker (void *arg)
+{
+    unsigned int t = (unsigned int) (unsigned long) arg;
+    unsigned int run;
+    DES_SIM *sim;
+
+    while (takeRun (t, &run)) {
+        sim = desCreate (&point[run / nRuns], seed + run % nRuns, NULL);
+        sim->policy = policy;
+        desRun (sim);
+        outcome[run].time = sim->now;
+        outcome[run].flights = sim->fSt->nFlight;
+        desDestroy (sim);
+    }
+    return NULL;
+}
+
+/**
+ *  \brief Ordering of times.
+ */
+
+static int byTime (const void *a, const void *b)
+{
+    unsigned long long ta = *(const unsigned long long *) a,
+                       tb = *(const unsigned long long *) b;
+
+    return (ta > tb) - (ta < tb);
+}
+
+/**
+ *  \brief Writing of the row of the results table of a parameter point.
+ *
+ *  \param out output file
+ *  \param csv CSV format
+ *  \param p parameter point
+ */
+
+static void writeRow (FILE *out, bool csv, unsigned int p)
+{
+    OUTCOME *o = &outcome[p * nRuns];
+    unsigned long long time[nRuns];                                                /* times of the runs, to be sorted */
+    double flights = 0.0, occupancy = 0.0, mean = 0.0;
+    unsigned int minF = o[0].flights, maxF = o[0].flights;
+    unsigned int r;
+
+    for (r = 0; r < nRuns; r++) {
+        flights += o[r].flights;
+        occupancy += (double) point[p].nPassengers / (o[r].flights * point[p].maxFC);
+        mean += o[r].time;
+        time[r] = o[r].time;
+        if (o[r].flights < minF) {
+            minF = o[r].flights;
+        }
+        if (o[r].flights > maxF) {
+            maxF = o[r].flights;
+        }
+    }
+    qsort (time, nRuns, sizeof (unsigned long long), byTime);
+    fprintf (out, csv ? "%u,%u,%u,%u,%u,%u,%.2f,%u,%u,%.4f,%.0f,%llu,%llu,%llu\n"
+                      : "%7u %5u %5u %2u %2u %6u %8.2f %5u %5u %6.4f %10.0f %10llu %10llu %10llu\n",
+             point[p].nPassengers, point[p].minFC, point[p].maxFC, point[p].nHostesses, point[p].nPilots, nRuns,
+             flights / nRuns, minF, maxF, occupancy / nRuns, mean / nRuns, time[nRuns/2], time[(95 * nRuns) / 100],
+             time[nRuns-1]);
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is building the parameter points, running all their simulations on the pool of threads and writing
+ *  the results table.
+ */
+
+int main (int argc, char *argv[])
+{
+    SWEPT nPass, minFC, maxFC, nHost, nPlane;                                                     /* swept parameters */
+    char def[5][16];                                                                      /* default swept parameters */
+    bool csv = false;                                                                            /* CSV output format */
+    FILE *out = stdout;                                                                                /* output file */
+    pthread_t *thr;                                                                            /* threads of the pool */
+    struct timespec t0, t1;                                                             /* start and end of the sweep */
+    unsigned int a, b, c, d, e, p, t, stolen = 0;
+    int opt;                                                                                   /* command line option */
+
+    sprintf (def[0], "%d", N);
+    sprintf (def[1], "%d", MINFC);
+    sprintf (def[2], "%d", MAXFC);
+    sprintf (def[3], "%d", NHT);
+    sprintf (def[4], "%d", NPT);
+    getValues (def[0], "number of passengers", &nPass);
+    getValues (def[1], "min flight capacity", &minFC);
+    getValues (def[2], "max flight capacity", &maxFC);
+    getValues (def[3], "number of hostesses", &nHost);
+    getValues (def[4], "number of planes", &nPlane);
+    nThreads = (unsigned int) sysconf (_SC_NPROCESSORS_ONLN);
+
+    while ((opt = getopt (argc, argv, "n:m:M:H:P:R:s:p:T:co:")) != -1) {
+        switch (opt) {
+            case 'n':
+                getValues (optarg, "number of passengers", &nPass);
+                break;
+            case 'm':
+                getValues (optarg, "min flight capacity", &minFC);
+                break;
+            case 'M':
+                getValues (optarg, "max flight capacity", &maxFC);
+                break;
+            case 'H':
+                getValues (optarg, "number of hostesses", &nHost);
+                break;
+            case 'P':
+                getValues (optarg, "number of planes", &nPlane);
+                break;
+            case 'R':
+                nRuns = getValue (optarg, "number of runs");
+                break;
+            case 's':
+                seed = getValue (optarg, "seed");
+                break;
+            case 'p':
+                if (!policyParse (optarg, &policy)) {
+                    fprintf (stderr, "The boarding policy is wrong (greedy, hold[:us] or predict[:us])!\n");
+                    exit (EXIT_FAILURE);
+                }
+                break;
+            case 'T':
+                nThreads = getValue (optarg, "number of threads");
+                break;
+            case 'c':
+                csv = true;
+                break;
+            case 'o':
+                if ((out = fopen (optarg, "w")) == NULL) {
+                    perror ("error on opening the output file");
+                    exit (EXIT_FAILURE);
+                }
+                break;
+            default:
+                fprintf (stderr, "Usage: %s [-n passengers] [-m min-capacity] [-M max-capacity] [-H hostesses] "
+                                 "[-P planes] [-R runs] [-s seed] [-p policy] [-T threads] [-c] [-o output]\n",
+                         argv[0]);
+                exit (EXIT_FAILURE);
+        }
+    }
+    for (d = 0; d < nHost.n; d++) {
+        if (nHost.val[d] > MAXHT) {
+            fprintf (stderr, "The number of hostesses is larger than %d!\n", MAXHT);
+            exit (EXIT_FAILURE);
+        }
+    }
+    for (e = 0; e < nPlane.n; e++) {
+        if (nPlane.val[e] > MAXPT) {
+            fprintf (stderr, "The number of planes is larger than %d!\n", MAXPT);
+            exit (EXIT_FAILURE);
+        }
+    }
+
+    /* building the parameter points, those with the min flight capacity larger than the max one are left out */
+
+    if ((point = malloc (nPass.n * minFC.n * maxFC.n * nHost.n * nPlane.n * sizeof (PARAM))) == NULL) {
+        perror ("error on allocating the parameter points");
+        exit (EXIT_FAILURE);
+    }
+    nPoints = 0;
+    for (a = 0; a < nPass.n; a++)
+        for (b = 0; b < minFC.n; b++)
+            for (c = 0; c < maxFC.n; c++)
+                for (d = 0; d < nHost.n; d++)
+                    for (e = 0; e < nPlane.n; e++) {
+                        if (minFC.val[b] > maxFC.val[c]) {
+                            continue;
+                        }
+                        point[nPoints] = (PARAM) { nPass.val[a], minFC.val[b], maxFC.val[c], 0, nHost.val[d],
+                                                   nPlane.val[e] };
+                        point[nPoints].maxNF = (nPass.val[a] + minFC.val[b] - 1) / minFC.val[b];
+                        if (point[nPoints].maxNF < MAXNF) {                      /* enough flights for the worst case */
+                            point[nPoints].maxNF = MAXNF;
+                        }
+                        nPoints++;
+                    }
+    if (nPoints == 0) {
+        fprintf (stderr, "The min flight capacity is larger than the max flight capacity at every point!\n");
+        exit (EXIT_FAILURE);
+    }
+
+    /* running the simulations, each thread starts with an even share of them */
+
+    if (((outcome = malloc (nPoints * nRuns * sizeof (OUTCOME))) == NULL) ||
+        ((share = malloc (nThreads * sizeof (SHARE))) == NULL) ||
+        ((thr = malloc (nThreads * sizeof (pthread_t))) == NULL)) {
+        perror ("error on allocating the pool of threads");
+        exit (EXIT_FAILURE);
+    }
+    for (t = 0; t < nThreads; t++) {
+        pthread_mutex_init (&share[t].lock, NULL);
+        share[t].lo = (unsigned int) ((unsigned long long) nPoints * nRuns * t / nThreads);
+        share[t].hi = (unsigned int) ((unsigned long long) nPoints * nRuns * (t + 1) / nThreads);
+        share[t].stolen = 0;
+    }
+    clock_gettime (CLOCK_MONOTONIC, &t0);
+    for (t = 0; t < nThreads; t++) {
+        if (pthread_create (&thr[t], NULL, worker, (void *) (unsigned long) t) != 0) {
+            perror ("error on the creation of a thread of the pool");
+            exit (EXIT_FAILURE);
+        }
+    }
+    for (t = 0; t < nThreads; t++) {
+        if (pthread_join (thr[t], NULL) != 0) {
+            perror ("error on waiting for a thread of the pool");
+            exit (EXIT_FAILURE);
+        }
+        stolen += share[t].stolen;
+    }
+    clock_gettime (CLOCK_MONOTONIC, &t1);
+
+    /* writing the results table */
+
+    if (csv) {
+        fprintf (out, "passengers,minFC,maxFC,hostesses,planes,runs,flights_mean,flights_min,flights_max,"
+                      "occupancy,time_mean_us,time_p50_us,time_p95_us,time_max_us\n");
+    }
+    else fprintf (out, "%7s %5s %5s %2s %2s %6s %8s %5s %5s %6s %10s %10s %10s %10s\n", "N", "minFC", "maxFC", "H",
+                  "P", "runs", "flights", "min", "max", "occup", "time_mean", "time_p50", "time_p95", "time_max");
+    for (p = 0; p < nPoints; p++) {
+        writeRow (out, csv, p);
+    }
+    fprintf (stderr, "%u simulations of %u parameter points in %.3f s on %u threads, %u runs stolen\n",
+             nPoints * nRuns, nPoints, (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9, nThreads, stolen);
+
+    free (thr);
+    free (share);
+    free (outcome);
+    free (point);
+    if (out != stdout) {
+        fclose (out);
+    }
+
+    return EXIT_SUCCESS;
+}
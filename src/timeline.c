@@ -0,0 +1,239 @@
+/**
+ *  \file timeline.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Timeline of the flights of a run.
+ *
+ *  Defined operations:
+ *     \li size and initialization of a timeline
+ *     \li binding of the calling process to a timeline
+ *     \li appending an event
+ *     \li writing of the rows to a file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "timeline.h"
+
+/** \brief names of the events, by kind, in the CSV files */
+static const char *names[] = { "queue", "boarding", "checked", "departed", "arrived", "empty", "returning" };
+
+/** \brief timeline the events of the calling process are appended to */
+static TIMELINE *bound = NULL;
+
+/**
+ *  \brief Rows of a timeline.
+ *
+ *  \param tl timeline
+ *
+ *  \return pointer to the first row
+ */
+
+static TL_ROW *rows (TIMELINE *tl)
+{
+    return (TL_ROW *) (tl->var + tl->nPassengers);
+}
+
+/**
+ *  \brief Reading of the clock of a timeline.
+ *
+ *  \param tl timeline
+ *
+ *  \return time since the start of the run (ns)
+ */
+
+static unsigned long long now (TIMELINE *tl)
+{
+    struct timespec t;
+
+    if (tl->clockOff != 0) {
+        return 1000 * *(volatile unsigned long long *) ((char *) tl + tl->clockOff);
+    }
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    return (unsigned long long) t.tv_sec * 1000000000ULL + (unsigned long long) t.tv_nsec - tl->start;
+}
+
+/**
+ *  \brief Ordering of the rows by time, and by order of appending at the same time.
+ *
+ *  The rows are appended almost in time order, a row is only out of order by the time taken between the reading of
+ *  the clock and the increment of the number of rows, so they are sorted by insertion.
+ *
+ *  \param row rows
+ *  \param n number of rows
+ */
+
+static void byTime (TL_ROW row[], unsigned int n)
+{
+    TL_ROW r;
+    unsigned int i, j;
+
+    for (i = 1; i < n; i++) {
+        r = row[i];
+        for (j = i; (j > 0) && (row[j - 1].time > r.time); j--) {
+            row[j] = row[j - 1];
+        }
+        row[j] = r;
+    }
+}
+
+/**
+ *  \brief Size of a timeline.
+ *
+ *  \param nPassengers number of passengers
+ *  \param nSlots number of rows that may be stored
+ *
+ *  \return size in bytes
+ */
+
+size_t timelineSize (unsigned int nPassengers, unsigned int nSlots)
+{
+    return sizeof (TIMELINE) + nPassengers * sizeof (unsigned long long) + nSlots * sizeof (TL_ROW);
+}
+
+/**
+ *  \brief Initialization of a timeline, before every run.
+ *
+ *  \param tl timeline (<tt>timelineSize</tt> bytes)
+ *  \param nPassengers number of passengers
+ *  \param nSlots number of rows that may be stored
+ *  \param clock pointer to the virtual time (us), in the same shared region, or \c NULL if time is real
+ */
+
+void timelineInit (TIMELINE *tl, unsigned int nPassengers, unsigned int nSlots, const unsigned long long *clock)
+{
+    struct timespec t;
+
+    tl->nRows = 0;
+    tl->nSlots = nSlots;
+    tl->nPassengers = nPassengers;
+    tl->clockOff = (clock == NULL) ? 0 : (char *) clock - (char *) tl;
+    memset (tl->var, 0, nPassengers * sizeof (unsigned long long));
+    clock_gettime (CLOCK_MONOTONIC, &t);
+    tl->start = (unsigned long long) t.tv_sec * 1000000000ULL + (unsigned long long) t.tv_nsec;
+}
+
+/**
+ *  \brief Binding of the calling process to a timeline.
+ *
+ *  \param tl timeline, or \c NULL not to append the events
+ */
+
+void timelineBind (TIMELINE *tl)
+{
+    bound = tl;
+}
+
+/**
+ *  \brief Appending an event.
+ *
+ *  The time a passenger joins the queue is kept, so that the row of the passenger checked carries the time it
+ *  spent in queue.
+ *
+ *  \param event kind of event
+ *  \param flight flight (\c 0, if it does not apply)
+ *  \param plane plane (-\c 1, if it does not apply)
+ *  \param passenger passenger (-\c 1, if it does not apply)
+ */
+
+void timelineEvent (unsigned int event, unsigned int flight, int plane, int passenger)
+{
+    TIMELINE *tl = bound;
+    unsigned long long t;
+    unsigned int r;
+
+    if (tl == NULL) {
+        return;
+    }
+    t = now (tl);
+    if (event == TL_QUEUE) {
+        tl->var[passenger] = t;
+    }
+    if ((r = __atomic_fetch_add (&tl->nRows, 1, __ATOMIC_RELAXED)) >= tl->nSlots) {
+        return;                                                                                 /* the row is dropped */
+    }
+    rows (tl)[r] = (TL_ROW) { t, 0, event, flight, plane, passenger };
+    if (event == TL_CHECKED) {
+        rows (tl)[r].wait = t - tl->var[passenger];
+    }
+}
+
+/**
+ *  \brief Writing of the rows to a file, in time order.
+ *
+ *  \param tl timeline
+ *  \param name name of the file
+ *
+ *  \return number of rows dropped because the timeline was full
+ */
+
+unsigned int timelineExport (TIMELINE *tl, const char *name)
+{
+    unsigned int n = (tl->nRows < tl->nSlots) ? tl->nRows : tl->nSlots,                             /* number of rows */
+                 r;
+    size_t len = strlen (name);
+    TL_HEADER head = { TL_MAGIC, 1, n, tl->nPassengers };
+    TL_ROW *row;                                                                                     /* rows in order */
+    FILE *fic;                                                                                     /* file descriptor */
+    bool ok;
+
+    if (((row = malloc ((n + 1) * sizeof (TL_ROW))) == NULL) || ((fic = fopen (name, "w")) == NULL)) {
+        perror ("error on writing the timeline");
+        exit (EXIT_FAILURE);
+    }
+    memcpy (row, rows (tl), n * sizeof (TL_ROW));
+    byTime (row, n);
+
+    if ((len > 4) && (strcmp (name + len - 4, ".csv") == 0)) {
+        ok = fprintf (fic, "time_ns,event,flight,plane,passenger,wait_ns\n") > 0;
+        for (r = 0; (r < n) && ok; r++) {
+            ok = fprintf (fic, "%llu,%s,", row[r].time, names[row[r].event]) > 0;
+            if (ok && (row[r].flight != 0)) {
+                ok = fprintf (fic, "%u", row[r].flight) > 0;
+            }
+            if (ok && (fputc (',', fic) != EOF) && (row[r].plane != -1)) {
+                ok = fprintf (fic, "%d", row[r].plane) > 0;
+            }
+            if (ok && (fputc (',', fic) != EOF) && (row[r].passenger != -1)) {
+                ok = fprintf (fic, "%d", row[r].passenger) > 0;
+            }
+            if (ok && (fputc (',', fic) != EOF) && (row[r].event == TL_CHECKED)) {
+                ok = fprintf (fic, "%llu", row[r].wait) > 0;
+            }
+            ok = ok && (fputc ('\n', fic) != EOF);
+        }
+    }
+    else {
+        ok = fwrite (&head, sizeof (head), 1, fic) == 1;
+        for (r = 0; (r < n) && ok; r++) {
+            ok = fwrite (&row[r].time, sizeof (row[r].time), 1, fic) == 1;
+        }
+        for (r = 0; (r < n) && ok; r++) {
+            ok = fwrite (&row[r].wait, sizeof (row[r].wait), 1, fic) == 1;
+        }
+        for (r = 0; (r < n) && ok; r++) {
+            ok = fwrite (&row[r].event, sizeof (row[r].event), 1, fic) == 1;
+        }
+        for (r = 0; (r < n) && ok; r++) {
+            ok = fwrite (&row[r].flight, sizeof (row[r].flight), 1, fic) == 1;
+        }
+        for (r = 0; (r < n) && ok; r++) {
+            ok = fwrite (&row[r].plane, sizeof (row[r].plane), 1, fic) == 1;
+        }
+        for (r = 0; (r < n) && ok; r++) {
+            ok = fwrite (&row[r].passenger, sizeof (row[r].passenger), 1, fic) == 1;
+        }
+    }
+    if (!ok || (fclose (fic) == EOF)) {
+        perror ("error on writing the timeline");
+        exit (EXIT_FAILURE);
+    }
+    free (row);
+
+    return tl->nRows - n;
+}
@@ -0,0 +1,170 @@
+/**
+ *  \file timeline.h (interface file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Timeline of the flights of a run.
+ *
+ *  The intervening entities append a row to the timeline, in shared memory, at every step of a flight: boarding
+ *  started, passenger checked, departed, arrived, plane empty and returning; and whenever a passenger joins the
+ *  queue, so that the row of the passenger checked carries the time spent in queue. A row takes one atomic
+ *  increment and a reading of the monotonic clock, or of the virtual time clock, and the rows are only written
+ *  to a file at the end of the run.
+ *
+ *  The file has a row per event, in time order, either as CSV, if its name ends in <tt>.csv</tt>, with the columns
+ *  <tt>time_ns,event,flight,plane,passenger,wait_ns</tt> (empty if they do not apply), or as a columnar binary
+ *  file: a <tt>TL_HEADER</tt> followed by the columns, each one an array of <tt>nRows</tt> entries, in this order
+ *  and in the byte order of the host: time (ns since the start of the run, 64 bit), time in queue (ns, 64 bit),
+ *  event (<tt>TL_QUEUE</tt> ... <tt>TL_RETURNING</tt>, 32 bit), flight (\c 0, if it does not apply, 32 bit),
+ *  plane and passenger (-\c 1, if they do not apply, 32 bit signed).
+ *
+ *  Operations defined on the timeline:
+ *     \li size and initialization, in shared memory, before every run
+ *     \li binding of the calling process to a timeline
+ *     \li appending an event
+ *     \li writing of the rows to a file.
+ */
+
+#ifndef TIMELINE_H_
+#define TIMELINE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Kinds of event */
+
+/** \brief passenger joins the queue */
+#define  TL_QUEUE           0
+/** \brief boarding started */
+#define  TL_BOARDING        1
+/** \brief passenger checked, after waiting in queue */
+#define  TL_CHECKED         2
+/** \brief flight departed */
+#define  TL_DEPARTED        3
+/** \brief flight arrived at the destination */
+#define  TL_ARRIVED         4
+/** \brief last passenger left the plane */
+#define  TL_EMPTY           5
+/** \brief flight returning to the starting airport */
+#define  TL_RETURNING       6
+
+/** \brief identification of a columnar binary timeline file */
+#define  TL_MAGIC  0x4c544c41                                                                       /* "ALTL" on disk */
+
+/**
+ *  \brief Definition of <em>timeline row</em> data type.
+ */
+typedef struct
+{ /** \brief time of the event (ns since the start of the run) */
+    unsigned long long time;
+    /** \brief time the passenger checked waited in queue (ns) */
+    unsigned long long wait;
+    /** \brief kind of event */
+    unsigned int event;
+    /** \brief flight (\c 0, if it does not apply) */
+    unsigned int flight;
+    /** \brief plane (-\c 1, if it does not apply) */
+    int plane;
+    /** \brief passenger (-\c 1, if it does not apply) */
+    int passenger;
+
+} TL_ROW;
+
+/**
+ *  \brief Definition of <em>timeline</em> data type.
+ *
+ *  It is placed in shared memory. The time each passenger joined the queue and the rows are stored after it.
+ */
+typedef struct
+{ /** \brief number of rows taken, more than <tt>nSlots</tt> if some were dropped */
+    unsigned int nRows;
+    /** \brief number of rows that may be stored */
+    unsigned int nSlots;
+    /** \brief number of passengers */
+    unsigned int nPassengers;
+    /** \brief start of the run (<tt>CLOCK_MONOTONIC</tt>, ns) */
+    unsigned long long start;
+    /** \brief offset of the virtual time clock (us) from the timeline (\c 0, if time is real) */
+    ptrdiff_t clockOff;
+    /** \brief time each passenger joined the queue (<tt>nPassengers</tt> entries, ns) followed by the rows
+     *  (<tt>nSlots</tt> entries) */
+    unsigned long long var[];
+
+} TIMELINE;
+
+/**
+ *  \brief Definition of <em>header of a columnar binary timeline file</em> data type.
+ */
+typedef struct
+{ /** \brief <tt>TL_MAGIC</tt> */
+    uint32_t magic;
+    /** \brief version of the layout of the file (\c 1) */
+    uint32_t version;
+    /** \brief number of rows */
+    uint32_t nRows;
+    /** \brief number of passengers */
+    uint32_t nPassengers;
+
+} TL_HEADER;
+
+/**
+ *  \brief Size of a timeline.
+ *
+ *  \param nPassengers number of passengers
+ *  \param nSlots number of rows that may be stored
+ *
+ *  \return size in bytes
+ */
+extern size_t timelineSize (unsigned int nPassengers, unsigned int nSlots);
+
+/**
+ *  \brief Initialization of a timeline, before every run.
+ *
+ *  The rows are discarded and the run starts now.
+ *
+ *  \param tl timeline (<tt>timelineSize</tt> bytes)
+ *  \param nPassengers number of passengers
+ *  \param nSlots number of rows that may be stored
+ *  \param clock pointer to the virtual time (us), in the same shared region, or \c NULL if time is real
+ */
+extern void timelineInit (TIMELINE *tl, unsigned int nPassengers, unsigned int nSlots,
+                          const unsigned long long *clock);
+
+/**
+ *  \brief Binding of the calling process to a timeline.
+ *
+ *  The events of every thread of the calling process are appended to it from now on.
+ *
+ *  \param tl timeline, or \c NULL not to append the events
+ */
+extern void timelineBind (TIMELINE *tl);
+
+/**
+ *  \brief Appending an event.
+ *
+ *  Nothing is done if the calling process is not bound to a timeline and the event is dropped if the timeline is
+ *  full. Must be called in the critical region that orders the event with the others of its flight, or
+ *  passenger.
+ *
+ *  \param event kind of event (<tt>TL_QUEUE</tt> ... <tt>TL_RETURNING</tt>)
+ *  \param flight flight (\c 0, if it does not apply)
+ *  \param plane plane (-\c 1, if it does not apply)
+ *  \param passenger passenger (-\c 1, if it does not apply), the passenger must have joined the queue before it is
+ *         checked
+ */
+extern void timelineEvent (unsigned int event, unsigned int flight, int plane, int passenger);
+
+/**
+ *  \brief Writing of the rows to a file, in time order.
+ *
+ *  The file is written as CSV, if its name ends in <tt>.csv</tt>, or as a columnar binary file.
+ *  The program is terminated if the file cannot be written or there is not enough memory.
+ *
+ *  \param tl timeline
+ *  \param name name of the file
+ *
+ *  \return number of rows dropped because the timeline was full
+ */
+extern unsigned int timelineExport (TIMELINE *tl, const char *name);
+
+#endif /* TIMELINE_H_ */
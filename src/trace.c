@@ -0,0 +1,78 @@
+/**
+ *  \file trace.c (implementation file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Static tracepoints on the state transitions of the intervening entities and on the blocking operations
+ *  on semaphores.
+ *
+ *  Defined operations:
+ *     \li writing of a tracepoint to the ftrace marker.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+/** \brief locations of the ftrace marker, tracefs first */
+static const char *markers[] = { "/sys/kernel/tracing/trace_marker", "/sys/kernel/debug/tracing/trace_marker" };
+
+/** \brief file descriptor of the ftrace marker, -\c 1 if not open yet, -\c 2 if it cannot be opened */
+static int marker = -1;
+
+/**
+ *  \brief Opening of the ftrace marker, once for all the threads of the calling process.
+ *
+ *  \return file descriptor, negative if the marker cannot be opened
+ */
+
+static int openMarker (void)
+{
+    int fd = -1, none = -1;
+    unsigned int m;
+
+    for (m = 0; (m < sizeof (markers) / sizeof (markers[0])) && (fd < 0); m++) {
+        fd = open (markers[m], O_WRONLY | O_CLOEXEC);
+    }
+    if (fd < 0) {
+        fd = -2;
+    }
+    if (!__atomic_compare_exchange_n (&marker, &none, fd, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        if (fd >= 0) {                                                              /* another thread opened it first */
+            close (fd);
+        }
+        fd = none;
+    }
+    return fd;
+}
+
+/**
+ *  \brief Writing of a tracepoint to the ftrace marker.
+ *
+ *  \param probe name of the probe
+ *  \param a first argument
+ *  \param b second argument
+ *  \param c third argument
+ *  \param nArgs number of arguments (\c 2 or \c 3)
+ */
+
+void traceMark (const char *probe, int a, int b, int c, int nArgs)
+{
+    char line[64];
+    int fd = __atomic_load_n (&marker, __ATOMIC_ACQUIRE), len;
+
+    if (fd == -1) {
+        fd = openMarker ();
+    }
+    if (fd < 0) {
+        return;
+    }
+    len = (nArgs == 3) ? snprintf (line, sizeof (line), "airlift:%s %d %d %d\n", probe, a, b, c)
+                       : snprintf (line, sizeof (line), "airlift:%s %d %d\n", probe, a, b);
+    if (write (fd, line, (size_t) len) < 0) {
+        ;                                                                          /* the event is lost, not an error */
+    }
+}
@@ -0,0 +1,79 @@
+/**
+ *  \file trace.h (interface file)
+ *
+ *  \brief Problem name: Air Lift.
+ *
+ *  \brief Static tracepoints on the state transitions of the intervening entities and on the blocking operations
+ *  on semaphores.
+ *
+ *  The tracepoints are only compiled in when the programs are built with <tt>TRACE</tt> (<tt>make trace</tt>);
+ *  otherwise they expand to nothing and their arguments are not evaluated. When compiled in they are:
+ *     \li USDT probes of provider <tt>airlift</tt>, if <tt>sys/sdt.h</tt> is available, a single \c nop at every
+ *         site until a tracer attaches to it, e.g.
+ *         <tt>perf probe -x ../run/pilot sdt_airlift:pilot</tt>, or <tt>bpftrace ../run/trace.bt</tt>;
+ *     \li otherwise, lines written to the ftrace marker (<tt>/sys/kernel/tracing/trace_marker</tt>), which are
+ *         recorded as <tt>ftrace:print</tt> events, e.g. by <tt>perf record -e ftrace:print -e sched:sched_switch</tt>,
+ *         and discarded by the kernel if tracing is off; nothing is written if the marker cannot be opened.
+ *
+ *  The probes and their arguments:
+ *     \li <tt>pilot</tt>, <tt>hostess</tt>, <tt>passenger</tt>: identification (plane, gate or passenger) and the
+ *         state just entered
+ *     \li <tt>sem_block</tt>: set identifier and semaphore the calling thread may block on, before a <em>down</em>
+ *     \li <tt>sem_wake</tt>: set identifier, semaphore and outcome (\c 0 or -\c 1) of that <em>down</em>.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/**
+ *  \brief Writing of a tracepoint to the ftrace marker.
+ *
+ *  The line is <tt>airlift:probe a b [c]</tt>. The marker is opened the first time it is called, by
+ *  the tracepoints built without <tt>sys/sdt.h</tt>.
+ *
+ *  \param probe name of the probe
+ *  \param a first argument
+ *  \param b second argument
+ *  \param c third argument
+ *  \param nArgs number of arguments (\c 2 or \c 3)
+ */
+
+extern void traceMark (const char *probe, int a, int b, int c, int nArgs);
+
+#if defined (TRACE) && defined (__has_include)
+#if __has_include (<sys/sdt.h>)
+#define  TRACE_SDT
+#endif
+#endif
+
+#if defined (TRACE_SDT)
+
+#include <sys/sdt.h>
+
+#define  TRACE_PILOT(plane, state)          DTRACE_PROBE2 (airlift, pilot, (int) (plane), (int) (state))
+#define  TRACE_HOSTESS(gate, state)         DTRACE_PROBE2 (airlift, hostess, (int) (gate), (int) (state))
+#define  TRACE_PASSENGER(id, state)         DTRACE_PROBE2 (airlift, passenger, (int) (id), (int) (state))
+#define  TRACE_SEM_BLOCK(semgid, sindex)    DTRACE_PROBE2 (airlift, sem_block, (int) (semgid), (int) (sindex))
+#define  TRACE_SEM_WAKE(semgid, sindex, stat)                                                                  \
+         DTRACE_PROBE3 (airlift, sem_wake, (int) (semgid), (int) (sindex), (int) (stat))
+
+#elif defined (TRACE)
+
+#define  TRACE_PILOT(plane, state)          traceMark ("pilot", (int) (plane), (int) (state), 0, 2)
+#define  TRACE_HOSTESS(gate, state)         traceMark ("hostess", (int) (gate), (int) (state), 0, 2)
+#define  TRACE_PASSENGER(id, state)         traceMark ("passenger", (int) (id), (int) (state), 0, 2)
+#define  TRACE_SEM_BLOCK(semgid, sindex)    traceMark ("sem_block", (int) (semgid), (int) (sindex), 0, 2)
+#define  TRACE_SEM_WAKE(semgid, sindex, stat)                                                                  \
+         traceMark ("sem_wake", (int) (semgid), (int) (sindex), (int) (stat), 3)
+
+#else
+
+#define  TRACE_PILOT(plane, state)          ((void) 0)
+#define  TRACE_HOSTESS(gate, state)         ((void) 0)
+#define  TRACE_PASSENGER(id, state)         ((void) 0)
+#define  TRACE_SEM_BLOCK(semgid, sindex)    ((void) 0)
+#define  TRACE_SEM_WAKE(semgid, sindex, stat)  ((void) 0)
+
+#endif
+
+#endif /* TRACE_H_ */